@@ -35,14 +35,39 @@
 #include <time.h>
 #include <errno.h>
 
+//  ... Library include files
+#include <sqlite3.h>
+
 //  ... Local include files
 #include <dbsqlite.h>
+#include <metrics.h>
+#include <latency.h>
 
 //  ... global memory declarations
 
 //  ... local memory:
 
 static SQLITE_DATABASE_ID   archiveDB = NULL;
+static sqlite3*             archiveWriteDB = NULL;
+static sqlite3_stmt*        archiveInsertStmt = NULL;
+
+// the average tiers - see DBSQLITE_TIER:
+#define TIER_QUERY_LENGTH_MAX       16384
+#define TIER_STATE_TABLE            "archive_tier_state"
+static const char*  TierTableName[DBSQLITE_TIER_MAX] =
+{
+	"archive_day"
+};
+static sqlite3_stmt*        tierSeedStmt[DBSQLITE_TIER_MAX];
+static sqlite3_stmt*        tierUpdateStmt[DBSQLITE_TIER_MAX];
+static sqlite3_stmt*        tierRebuildStmt;
+
+// archive records in [tierRebuildNext, tierRebuildBefore) are not in the
+// tiers yet - dbsqliteArchiveTierRebuildStep works through them
+static time_t               tierRebuildNext;
+static time_t               tierRebuildBefore;
+static int                  tierRebuildCount;
+
 static const char*  ArchiveValueName[DATA_INDEX_MAX] =
 {
 	"barometer",
@@ -283,359 +308,807 @@ static int getDBData(SQLITE_DIRECT_ROW row, ARCHIVE_PKT* data)
 	return OK;
 }
 
-static int insertDBData(ARCHIVE_PKT* data)
+//  ... the archive writer is a second connection holding one prepared INSERT
+//  ... (bound by column index) for the life of the process
+
+static int writerExec(const char* sql)
 {
-	SQLITE_ROW_ID           row;
-	SQLITE_FIELD_ID         field;
-	Data_Indices            index;
+	char*       errMsg = NULL;
 
-	if (archiveDB == NULL)
+	if (sqlite3_exec(archiveWriteDB, sql, NULL, NULL, &errMsg) != SQLITE_OK)
 	{
-		MsgLog(PRI_HIGH, "dbsqlite: failed to open %s!", getArchiveDBFilename());
+		MsgLog(PRI_HIGH, "dbsqlite: %s failed: %s", sql, ((errMsg) ? errMsg : "unknown"));
+		sqlite3_free(errMsg);
 		return ERROR;
 	}
 
-	row = radsqliteTableDescriptionGet(archiveDB, "archive");
-	if (row == NULL)
-	{
-		printf("dbsqlite: databaseTableDescriptionGet failed!");
-		return ERROR;
-	}
+	return OK;
+}
 
-	field = radsqliteFieldGet(row, "dateTime");
-	if (field == NULL)
-	{
-		MsgLog(PRI_MEDIUM, "dbsqlite: radsqliteFieldGet failed!");
-		radsqliteRowDescriptionDelete(row);
-		return ERROR;
-	}
-	else
-	{
-		radsqliteFieldSetBigIntValue(field, (uint64_t)data->dateTime);
-	}
+static void writerClose(void);
 
-	field = radsqliteFieldGet(row, "usUnits");
-	if (field == NULL)
-	{
-		MsgLog(PRI_MEDIUM, "dbsqlite: radsqliteFieldGet failed!");
-		radsqliteRowDescriptionDelete(row);
-		return ERROR;
-	}
-	else
-	{
-		radsqliteFieldSetBigIntValue(field, (uint64_t)data->usUnits);
-	}
+//  ... the average tiers live in the archive database and are only written
+//  ... through the writer connection
 
-	field = radsqliteFieldGet(row, "interval");
-	if (field == NULL)
-	{
-		MsgLog(PRI_MEDIUM, "dbsqlite: radsqliteFieldGet failed!");
-		radsqliteRowDescriptionDelete(row);
-		return ERROR;
-	}
-	else
-	{
-		radsqliteFieldSetBigIntValue(field, (uint64_t)data->interval);
+//  ... a record is stamped at the end of its interval, so it belongs to the
+//  ... tier row its last second falls in (the midnight record closes the day)
+static time_t tierStartTime(DBSQLITE_TIER tier, time_t dateTime)
+{
+	return wvutilsDayStart(dateTime - 1);
+}
+
+static int tierRebuildPending(void)
+{
+	return (tierRebuildNext < tierRebuildBefore);
+}
+
+//  ... the last good wind direction, used for a record whose direction is
+//  ... out of range just as the archive scans do with lastWDIR
+static int                  tierLastWDIR;
+
+static int tierAccumulate(ARCHIVE_PKT* data)
+{
+	DBSQLITE_TIER   tier;
+	Data_Indices    index;
+	WAVG            windBin;
+	time_t          startTime;
+	double          value;
+	int             i, column;
+
+	// the tiers are kept in US units like the bulk of the archive:
+	windAverageReset(&windBin);
+	if (data->value[DATA_INDEX_windDir] > ARCHIVE_VALUE_NULL)
+	{
+		if (data->value[DATA_INDEX_windDir] >= 0 && data->value[DATA_INDEX_windDir] < 360)
+		{
+			tierLastWDIR = (int)data->value[DATA_INDEX_windDir];
+		}
+		windAverageAddValue(&windBin, tierLastWDIR);
 	}
 
-	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
+	for (tier = DBSQLITE_TIER_DAY; tier < DBSQLITE_TIER_MAX; tier++)
 	{
-		field = radsqliteFieldGet(row, ArchiveValueName[index]);
-		if (field == NULL)
+		startTime = tierStartTime(tier, (time_t)data->dateTime);
+
+		sqlite3_reset(tierSeedStmt[tier]);
+		sqlite3_bind_int64(tierSeedStmt[tier], 1, (sqlite3_int64)startTime);
+		if (sqlite3_step(tierSeedStmt[tier]) != SQLITE_DONE)
 		{
-			MsgLog(PRI_MEDIUM, "dbsqlite: radsqliteFieldGet %s failed!", ArchiveValueName[index]);
-			radsqliteRowDescriptionDelete(row);
+			MsgLog(PRI_HIGH, "dbsqlite: %s seed failed for %d: %s",
+				TierTableName[tier], (int)startTime, sqlite3_errmsg(archiveWriteDB));
+			sqlite3_reset(tierSeedStmt[tier]);
 			return ERROR;
 		}
-		else
+
+		sqlite3_reset(tierUpdateStmt[tier]);
+		sqlite3_bind_int64(tierUpdateStmt[tier], 1, (sqlite3_int64)data->interval);
+		for (index = DATA_INDEX_barometer, column = 2; index < DATA_INDEX_MAX; index++, column += 2)
 		{
 			if (data->value[index] <= ARCHIVE_VALUE_NULL)
 			{
-				radsqliteFieldSetToNull(field);
+				sqlite3_bind_double(tierUpdateStmt[tier], column, 0.0);
+				sqlite3_bind_int(tierUpdateStmt[tier], column + 1, 0);
+				continue;
 			}
-			else
+
+			value = (double)data->value[index];
+			if (!data->usUnits)
 			{
-				radsqliteFieldSetDoubleValue(field, (double)data->value[index]);
+				// Handle WIND separately (the table entry converts to the
+				// configured wind units, the tiers want mph):
+				if (index == DATA_INDEX_windSpeed || index == DATA_INDEX_windGust)
+				{
+					value = (double)wvutilsConvertKPHToMPH(data->value[index]);
+				}
+				else
+				{
+					value = (double)(*metricToImperial_convertors[index])(data->value[index]);
+				}
 			}
+			sqlite3_bind_double(tierUpdateStmt[tier], column, value);
+			sqlite3_bind_int(tierUpdateStmt[tier], column + 1, 1);
+		}
+		for (i = 0; i < WAVG_NUM_BINS; i++, column++)
+		{
+			sqlite3_bind_int(tierUpdateStmt[tier], column, windBin.bins[i]);
+		}
+		sqlite3_bind_int64(tierUpdateStmt[tier], column, (sqlite3_int64)startTime);
+
+		if (sqlite3_step(tierUpdateStmt[tier]) != SQLITE_DONE)
+		{
+			MsgLog(PRI_HIGH, "dbsqlite: %s update failed for %d: %s",
+				TierTableName[tier], (int)startTime, sqlite3_errmsg(archiveWriteDB));
+			sqlite3_reset(tierUpdateStmt[tier]);
+			return ERROR;
 		}
 	}
 
-	// insert the row:
-	if (radsqliteTableInsertRow(archiveDB, "archive", row) == ERROR)
+	return OK;
+}
+
+//  ... a new record goes straight into the tiers unless it falls in the range
+//  ... the rebuild has yet to cover (it will be picked up from there)
+static int tierAddRecord(ARCHIVE_PKT* data)
+{
+	if (tierRebuildPending() &&
+		(time_t)data->dateTime >= tierRebuildNext &&
+		(time_t)data->dateTime < tierRebuildBefore)
 	{
-		MsgLog(PRI_HIGH, "dbsqlite: radsqliteTableInsertRow failed!");
-		radsqliteRowDescriptionDelete(row);
-		return ERROR;
+		return OK;
 	}
 
-	radsqliteRowDescriptionDelete(row);
-	return OK;
+	return tierAccumulate(data);
 }
 
-static int lastWDIR;
-#if defined(BUILD_HTMLGEND) || defined(BUILD_WVIEWD)
+static int tierTableExists(const char* name)
+{
+	sqlite3_stmt*   stmt;
+	int             exists = FALSE;
 
-//  return num minutes processed or error
-static int rollIntoAverages
-(
-	int                     isMetricUnits,
-	WAVG_ID                 windId,
-	time_t                  startTime,
-	HISTORY_DATA*           store,
-	int                     numMins
-)
+	if (sqlite3_prepare_v2(archiveWriteDB,
+		"SELECT name FROM sqlite_master WHERE type = 'table' AND name = ?",
+		-1, &stmt, NULL) != SQLITE_OK)
+	{
+		return FALSE;
+	}
+
+	sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+	{
+		exists = TRUE;
+	}
+
+	sqlite3_finalize(stmt);
+	return exists;
+}
+
+static void tiersClose(void)
 {
-	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
-	int                     recordIsUSUnits, mins = 0;
-	float                   value;
-	time_t                  endTime = startTime + (numMins * 60);
-	SQLITE_DIRECT_ROW       rowDescr;
-	SQLITE_FIELD_ID         field;
-	Data_Indices            index;
+	DBSQLITE_TIER   tier;
 
-	if (archiveDB == NULL)
+	if (tierRebuildStmt != NULL)
 	{
-		MsgLog(PRI_HIGH, "rollIntoAverages: failed to open %s!", getArchiveDBFilename());
+		sqlite3_finalize(tierRebuildStmt);
+		tierRebuildStmt = NULL;
+	}
+	for (tier = DBSQLITE_TIER_DAY; tier < DBSQLITE_TIER_MAX; tier++)
+	{
+		if (tierSeedStmt[tier] != NULL)
+		{
+			sqlite3_finalize(tierSeedStmt[tier]);
+			tierSeedStmt[tier] = NULL;
+		}
+		if (tierUpdateStmt[tier] != NULL)
+		{
+			sqlite3_finalize(tierUpdateStmt[tier]);
+			tierUpdateStmt[tier] = NULL;
+		}
+	}
+}
+
+//  ... load the rebuild range, if one is left (an empty range when not)
+static int tierLoadRebuildState(void)
+{
+	sqlite3_stmt*   stmt;
+
+	tierRebuildNext = tierRebuildBefore = 0;
+
+	if (sqlite3_prepare_v2(archiveWriteDB,
+		"SELECT rebuildNext, rebuildBefore FROM " TIER_STATE_TABLE,
+		-1, &stmt, NULL) != SQLITE_OK)
+	{
+		MsgLog(PRI_HIGH, "dbsqlite: read %s failed: %s",
+			TIER_STATE_TABLE, sqlite3_errmsg(archiveWriteDB));
 		return ERROR;
 	}
 
-	// Build the query:
-	sprintf(query, "SELECT * FROM archive WHERE dateTime >= '%d' AND dateTime < '%d' ORDER BY dateTime ASC",
-		(int)startTime, (int)endTime);
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+	{
+		tierRebuildNext = (time_t)sqlite3_column_int64(stmt, 0);
+		tierRebuildBefore = (time_t)sqlite3_column_int64(stmt, 1);
+	}
 
-	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	sqlite3_finalize(stmt);
+	return OK;
+}
+
+//  ... create the tier tables and prepare their statements (bound by column
+//  ... index, like the archive INSERT); new tables are filled from the
+//  ... existing archive a step at a time by dbsqliteArchiveTierRebuildStep,
+//  ... so a large archive doesn't hold up the writer
+static int tiersOpen(void)
+{
+	char            query[TIER_QUERY_LENGTH_MAX];
+	DBSQLITE_TIER   tier;
+	Data_Indices    index;
+	int             i, len, created = FALSE;
+
+	if (writerExec("BEGIN TRANSACTION") == ERROR)
 	{
 		return ERROR;
 	}
 
-	for (rowDescr = radsqlitedirectGetRow(archiveDB);
-		rowDescr != NULL;
-		rowDescr = radsqlitedirectGetRow(archiveDB))
+	if (!tierTableExists(TIER_STATE_TABLE))
 	{
-		field = radsqlitedirectFieldGet(rowDescr, "interval");
-		if (field == NULL)
+		// tiers from before the rebuild state (hourly, or bucketed by the
+		// record's own time) are not compatible - start over:
+		if (writerExec("DROP TABLE IF EXISTS archive_hour") == ERROR ||
+			writerExec("DROP TABLE IF EXISTS archive_day") == ERROR ||
+			writerExec("CREATE TABLE " TIER_STATE_TABLE " (rebuildNext INTEGER NOT NULL, "
+					   "rebuildBefore INTEGER NOT NULL)") == ERROR)
 		{
-			MsgLog(PRI_MEDIUM, "rollIntoAverages: radsqlitedirectFieldGet failed!");
-			radsqlitedirectReleaseResults(archiveDB);
+			writerExec("ROLLBACK TRANSACTION");
 			return ERROR;
 		}
-		else
+	}
+
+	for (tier = DBSQLITE_TIER_DAY; tier < DBSQLITE_TIER_MAX; tier++)
+	{
+		if (tierTableExists(TierTableName[tier]))
 		{
-			mins += (int)radsqliteFieldGetBigIntValue(field);
+			continue;
 		}
 
-		field = radsqlitedirectFieldGet(rowDescr, "usUnits");
-		if (field == NULL)
+		len = sprintf(query, "CREATE TABLE %s (startTime INTEGER PRIMARY KEY, "
+			"mins INTEGER NOT NULL DEFAULT 0", TierTableName[tier]);
+		for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
 		{
-			MsgLog(PRI_MEDIUM, "rollIntoAverages: radsqlitedirectFieldGet failed!");
-			radsqlitedirectReleaseResults(archiveDB);
-			return ERROR;
+			len += sprintf(&query[len], ", %s_sum REAL NOT NULL DEFAULT 0, %s_n INTEGER NOT NULL DEFAULT 0",
+				ArchiveValueName[index], ArchiveValueName[index]);
 		}
-		else
+		for (i = 0; i < WAVG_NUM_BINS; i++)
 		{
-			recordIsUSUnits = (int)radsqliteFieldGetBigIntValue(field);
+			len += sprintf(&query[len], ", wbin%d INTEGER NOT NULL DEFAULT 0", i);
 		}
+		sprintf(&query[len], ")");
 
-		for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
+		if (writerExec(query) == ERROR)
 		{
-			field = radsqlitedirectFieldGet(rowDescr, ArchiveValueName[index]);
-			if (field == NULL)
-			{
-				MsgLog(PRI_MEDIUM, "rollIntoAverages: radsqlitedirectFieldGet %s failed!", ArchiveValueName[index]);
-				radsqlitedirectReleaseResults(archiveDB);
-				return ERROR;
-			}
-			else
-			{
-				if (!FIELD_IS_NULL(field))
-				{
-					value = (float)radsqliteFieldGetDoubleValue(field);
-
-					// Check for wview NULL value:
-					if (value > ARCHIVE_VALUE_NULL)
-					{
-						store->samples[index] += 1;
-
-						// Handle WIND separately:
-						if (index == DATA_INDEX_windSpeed || index == DATA_INDEX_windGust)
-						{
-							if (recordIsUSUnits)
-							{
-								store->values[index] += wvutilsGetWindSpeed(value);
-							}
-							else
-							{
-								store->values[index] += wvutilsGetWindSpeedMetric(value);
-							}
-						}
-						else
-						{
-							if (isMetricUnits & recordIsUSUnits)
-							{
-								store->values[index] += (*imperialToMetric_convertors[index])(value);
-							}
-							else if (!isMetricUnits & !recordIsUSUnits)
-							{
-								store->values[index] += (*metricToImperial_convertors[index])(value);
-							}
-							else
-							{
-								store->values[index] += value;
-							}
-						}
-					}
-				}
-			}
+			writerExec("ROLLBACK TRANSACTION");
+			return ERROR;
 		}
+		created = TRUE;
+	}
 
-		field = radsqlitedirectFieldGet(rowDescr, ArchiveValueName[DATA_INDEX_windDir]);
-		if (field == NULL)
+	if (created)
+	{
+		// everything already in the archive is left to the rebuild:
+		if (writerExec("DELETE FROM " TIER_STATE_TABLE) == ERROR ||
+			writerExec("INSERT INTO " TIER_STATE_TABLE " (rebuildNext, rebuildBefore) "
+					   "SELECT COALESCE(MIN(dateTime), 0), COALESCE(MAX(dateTime), 0) + 1 "
+					   "FROM archive") == ERROR)
 		{
-			MsgLog(PRI_MEDIUM, "rollIntoAverages: radsqlitedirectFieldGet failed!");
-			radsqlitedirectReleaseResults(archiveDB);
+			writerExec("ROLLBACK TRANSACTION");
 			return ERROR;
 		}
-		else if (!FIELD_IS_NULL(field))
-		{
-			value = (float)radsqliteFieldGetDoubleValue(field);
-			if (value >= 0 && value < 360)
-			{
-				lastWDIR = (int)value;
-			}
-			windAverageAddValue(windId, lastWDIR);
-		}
 	}
 
-	radsqlitedirectReleaseResults(archiveDB);
-
-	// Finally, check to be sure values were found, if not, set to ARCHIVE_VALUE_NULL:
-	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
+	for (tier = DBSQLITE_TIER_DAY; tier < DBSQLITE_TIER_MAX; tier++)
 	{
-		if (store->samples[index] == 0)
+		sprintf(query, "INSERT OR IGNORE INTO %s (startTime) VALUES (?)", TierTableName[tier]);
+		if (sqlite3_prepare_v2(archiveWriteDB, query, -1, &tierSeedStmt[tier], NULL) != SQLITE_OK)
 		{
-			// set value to NULL:
-			store->values[index] = ARCHIVE_VALUE_NULL;
+			MsgLog(PRI_HIGH, "dbsqlite: prepare %s seed failed: %s",
+				TierTableName[tier], sqlite3_errmsg(archiveWriteDB));
+			tiersClose();
+			writerExec("ROLLBACK TRANSACTION");
+			return ERROR;
 		}
-	}
 
-	return mins;
-}
-#endif
+		len = sprintf(query, "UPDATE %s SET mins = mins + ?", TierTableName[tier]);
+		for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
+		{
+			len += sprintf(&query[len], ", %s_sum = %s_sum + ?, %s_n = %s_n + ?",
+				ArchiveValueName[index], ArchiveValueName[index],
+				ArchiveValueName[index], ArchiveValueName[index]);
+		}
+		for (i = 0; i < WAVG_NUM_BINS; i++)
+		{
+			len += sprintf(&query[len], ", wbin%d = wbin%d + ?", i, i);
+		}
+		sprintf(&query[len], " WHERE startTime = ?");
 
-static time_t getNewestDateTime(ARCHIVE_PKT* newRec)
-{
-	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
-	SQLITE_DIRECT_ROW       rowDescr;
-	SQLITE_FIELD_ID         field;
-	time_t                  retVal;
+		if (sqlite3_prepare_v2(archiveWriteDB, query, -1, &tierUpdateStmt[tier], NULL) != SQLITE_OK)
+		{
+			MsgLog(PRI_HIGH, "dbsqlite: prepare %s update failed: %s",
+				TierTableName[tier], sqlite3_errmsg(archiveWriteDB));
+			tiersClose();
+			writerExec("ROLLBACK TRANSACTION");
+			return ERROR;
+		}
+	}
 
-	if (archiveDB == NULL)
+	len = sprintf(query, "SELECT dateTime,usUnits,interval");
+	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
 	{
-		MsgLog(PRI_HIGH, "getNewestDateTime: failed to open %s!", getArchiveDBFilename());
-		return ERROR;
+		len += sprintf(&query[len], ",%s", ArchiveValueName[index]);
 	}
-
-	// Build the query:
-	sprintf(query, "SELECT MAX(dateTime) AS 'max' FROM archive");
-
-	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	sprintf(&query[len], " FROM archive WHERE dateTime >= ? AND dateTime < ? "
+		"ORDER BY dateTime ASC LIMIT ?");
+	if (sqlite3_prepare_v2(archiveWriteDB, query, -1, &tierRebuildStmt, NULL) != SQLITE_OK)
 	{
-		MsgLog(PRI_HIGH, "getNewestDateTime: radsqlitedirectQuery failed!");
+		MsgLog(PRI_HIGH, "dbsqlite: prepare tier rebuild failed: %s",
+			sqlite3_errmsg(archiveWriteDB));
+		tiersClose();
+		writerExec("ROLLBACK TRANSACTION");
 		return ERROR;
 	}
 
-	rowDescr = radsqlitedirectGetRow(archiveDB);
-	if (rowDescr == NULL)
+	if (tierLoadRebuildState() == ERROR)
 	{
-		MsgLog(PRI_MEDIUM,
-			"getNewestDateTime: radsqlitedirectGetRow failed!");
-		radsqlitedirectReleaseResults(archiveDB);
+		tiersClose();
+		writerExec("ROLLBACK TRANSACTION");
 		return ERROR;
 	}
 
-	field = radsqlitedirectFieldGet(rowDescr, "max");
-	if (field == NULL)
+	if (writerExec("COMMIT TRANSACTION") == ERROR)
 	{
-		MsgLog(PRI_MEDIUM,
-			"getNewestDateTime: radsqlitedirectFieldGet failed!");
-		radsqlitedirectReleaseResults(archiveDB);
+		tiersClose();
+		writerExec("ROLLBACK TRANSACTION");
 		return ERROR;
 	}
 
-	retVal = (time_t)radsqliteFieldGetBigIntValue(field);
-
-	// Clean up:
-	radsqlitedirectReleaseResults(archiveDB);
+	if (tierRebuildPending())
+	{
+		MsgLog(PRI_STATUS, "dbsqlite: building average tiers from the archive in the background");
+	}
+	return OK;
+}
 
-	// Now grab the entire row:
-	sprintf(query, "SELECT * FROM archive WHERE dateTime = '%d'", (int)retVal);
+static int writerOpen(void)
+{
+	char            query[DB_SQLITE_QUERY_LENGTH_MAX];
+	Data_Indices    index;
+	int             len;
 
-	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	if (archiveInsertStmt != NULL)
 	{
-		MsgLog(PRI_HIGH, "getNewestDateTime: radsqlitedirectQuery failed!");
-		return ERROR;
+		return OK;
 	}
 
-	rowDescr = radsqlitedirectGetRow(archiveDB);
-	if (rowDescr == NULL)
+	if (sqlite3_open_v2(getArchiveDBFilename(), &archiveWriteDB, SQLITE_OPEN_READWRITE, NULL)
+		!= SQLITE_OK)
 	{
-		MsgLog(PRI_MEDIUM,
-			"getNewestDateTime: radsqlitedirectGetRow failed!");
-		radsqlitedirectReleaseResults(archiveDB);
+		MsgLog(PRI_HIGH, "dbsqlite: failed to open %s for writing: %s",
+			getArchiveDBFilename(), sqlite3_errmsg(archiveWriteDB));
+		sqlite3_close(archiveWriteDB);
+		archiveWriteDB = NULL;
 		return ERROR;
 	}
 
-	// finally copy it to the internal PKT:
-	getDBData(rowDescr, newRec);
-
-	radsqlitedirectReleaseResults(archiveDB);
-	return retVal;
-}
+	// readers (htmlgend and our own query connection) hold the file briefly:
+	sqlite3_busy_timeout(archiveWriteDB, 5000);
 
-static int getNextRecord(time_t dateTime, ARCHIVE_PKT* newRec)
-{
-	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
-	SQLITE_DIRECT_ROW       rowDescr;
-	SQLITE_FIELD_ID         field;
-	time_t                  retVal;
+	// synchronous is per connection - match the archive PRIMARY profile:
+	writerExec("PRAGMA synchronous = FULL");
 
-	if (archiveDB == NULL)
+	len = sprintf(query, "INSERT INTO archive (dateTime,usUnits,interval");
+	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
 	{
-		MsgLog(PRI_HIGH, "getNextRecord: failed to open %s!", getArchiveDBFilename());
-		return ERROR;
+		len += sprintf(&query[len], ",%s", ArchiveValueName[index]);
 	}
-
-	// Build the query:
-	sprintf(query, "SELECT MIN(dateTime) AS 'min' FROM archive WHERE dateTime > '%d'",
-		(int)dateTime);
-
-	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	len += sprintf(&query[len], ") VALUES (?,?,?");
+	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
 	{
-		return ERROR;
+		len += sprintf(&query[len], ",?");
 	}
+	sprintf(&query[len], ")");
 
-	rowDescr = radsqlitedirectGetRow(archiveDB);
-	if (rowDescr == NULL)
+	if (sqlite3_prepare_v2(archiveWriteDB, query, -1, &archiveInsertStmt, NULL) != SQLITE_OK)
 	{
-		radsqlitedirectReleaseResults(archiveDB);
+		MsgLog(PRI_HIGH, "dbsqlite: prepare archive INSERT failed: %s",
+			sqlite3_errmsg(archiveWriteDB));
+		sqlite3_close(archiveWriteDB);
+		archiveWriteDB = NULL;
+		archiveInsertStmt = NULL;
 		return ERROR;
 	}
 
-	field = radsqlitedirectFieldGet(rowDescr, "min");
-	if (field == NULL)
+	if (tiersOpen() == ERROR)
 	{
-		MsgLog(PRI_MEDIUM,
-			"getNextRecord: radsqlitedirectFieldGet failed!");
-		radsqlitedirectReleaseResults(archiveDB);
+		MsgLog(PRI_HIGH, "dbsqlite: archive average tiers unavailable");
+		writerClose();
 		return ERROR;
 	}
 
-	retVal = (time_t)radsqliteFieldGetBigIntValue(field);
-
+	return OK;
+}
+
+static void writerClose(void)
+{
+	tiersClose();
+	if (archiveInsertStmt != NULL)
+	{
+		sqlite3_finalize(archiveInsertStmt);
+		archiveInsertStmt = NULL;
+	}
+	if (archiveWriteDB != NULL)
+	{
+		sqlite3_close(archiveWriteDB);
+		archiveWriteDB = NULL;
+	}
+}
+
+static int insertDBData(ARCHIVE_PKT* data)
+{
+	Data_Indices    index;
+	int             column, retVal;
+	uint64_t        startTime;
+
+	sqlite3_reset(archiveInsertStmt);
+
+	sqlite3_bind_int64(archiveInsertStmt, 1, (sqlite3_int64)data->dateTime);
+	sqlite3_bind_int64(archiveInsertStmt, 2, (sqlite3_int64)data->usUnits);
+	sqlite3_bind_int64(archiveInsertStmt, 3, (sqlite3_int64)data->interval);
+
+	for (index = DATA_INDEX_barometer, column = 4; index < DATA_INDEX_MAX; index++, column++)
+	{
+		if (data->value[index] <= ARCHIVE_VALUE_NULL)
+		{
+			sqlite3_bind_null(archiveInsertStmt, column);
+		}
+		else
+		{
+			sqlite3_bind_double(archiveInsertStmt, column, (double)data->value[index]);
+		}
+	}
+
+	// the row and its tier updates go in or stay out together:
+	if (writerExec("SAVEPOINT archiveRecord") == ERROR)
+	{
+		return ERROR;
+	}
+
+	// insert the row:
+	startTime = latencyStart();
+	retVal = sqlite3_step(archiveInsertStmt);
+	metricsAdd(METRIC_SQL_STATEMENTS, 1);
+	if (startTime != 0)
+	{
+		metricsAdd(METRIC_SQL_SECONDS, (double)(latencyStart() - startTime) / 1000000000.0);
+	}
+	if (retVal != SQLITE_DONE)
+	{
+		MsgLog(PRI_HIGH, "dbsqlite: archive insert failed for %d: %s",
+			(int)data->dateTime, sqlite3_errmsg(archiveWriteDB));
+		sqlite3_reset(archiveInsertStmt);
+		writerExec("ROLLBACK TO archiveRecord");
+		writerExec("RELEASE archiveRecord");
+		return ERROR;
+	}
+
+	// keep the average tiers in step:
+	if (tierAddRecord(data) == ERROR)
+	{
+		writerExec("ROLLBACK TO archiveRecord");
+		writerExec("RELEASE archiveRecord");
+		return ERROR;
+	}
+
+	return writerExec("RELEASE archiveRecord");
+}
+
+static int lastWDIR;
+#if defined(BUILD_HTMLGEND) || defined(BUILD_WVIEWD)
+
+//  ... the averaging scans convert archive values in batches: every
+//  ... convertor in the jump tables is affine, so each one is reduced to a
+//  ... per-column scale and offset once and applied to whole rows in a
+//  ... plain loop the compiler can vectorize (NULLs pass through untouched)
+#define CONVERT_BATCH_RECORDS       128
+
+typedef struct
+{
+	float       scale[DATA_INDEX_MAX];
+	float       offset[DATA_INDEX_MAX];
+} UNIT_CONVERSION;
+
+static ARCHIVE_PKT  ConvertBatch[CONVERT_BATCH_RECORDS];
+
+static void buildConversion
+(
+	int                     isMetricUnits,
+	int                     recordIsUSUnits,
+	UNIT_CONVERSION*        conv
+)
+{
+	float                   (*convertor)(float value);
+	Data_Indices            index;
+
+	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
+	{
+		// Handle WIND separately (always the configured wind units):
+		if (index == DATA_INDEX_windSpeed || index == DATA_INDEX_windGust)
+		{
+			convertor = ((recordIsUSUnits) ? wvutilsGetWindSpeed : wvutilsGetWindSpeedMetric);
+		}
+		else if (isMetricUnits && recordIsUSUnits)
+		{
+			convertor = imperialToMetric_convertors[index];
+		}
+		else if (!isMetricUnits && !recordIsUSUnits)
+		{
+			convertor = metricToImperial_convertors[index];
+		}
+		else
+		{
+			convertor = noConversion;
+		}
+
+		conv->offset[index] = (*convertor)(0.0);
+		conv->scale[index] = (*convertor)(1.0) - conv->offset[index];
+	}
+}
+
+static void convertValues(const UNIT_CONVERSION* conv, float* values)
+{
+	int                     i;
+	float                   value, converted;
+
+	for (i = 0; i < DATA_INDEX_MAX; i++)
+	{
+		value = values[i];
+		converted = (value * conv->scale[i]) + conv->offset[i];
+		values[i] = ((value > ARCHIVE_VALUE_NULL) ? converted : value);
+	}
+}
+
+//  read up to 'maxRecords' rows of the open direct query into ConvertBatch,
+//  converted to the display units;
+//  return the number read (0 when the query is exhausted) or ERROR
+static int readConvertedBatch(int isMetricUnits, int maxRecords)
+{
+	static UNIT_CONVERSION  fromUS, fromMetric;
+	SQLITE_DIRECT_ROW       rowDescr;
+	int                     i, count = 0;
+
+	for (rowDescr = radsqlitedirectGetRow(archiveDB);
+		rowDescr != NULL;
+		rowDescr = radsqlitedirectGetRow(archiveDB))
+	{
+		if (getDBData(rowDescr, &ConvertBatch[count]) == ERROR)
+		{
+			MsgLog(PRI_MEDIUM, "rollIntoAverages: getDBData failed!");
+			return ERROR;
+		}
+		if (++count == maxRecords)
+		{
+			break;
+		}
+	}
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	// the wind units may change with a configuration reload, so rebuild:
+	buildConversion(isMetricUnits, TRUE, &fromUS);
+	buildConversion(isMetricUnits, FALSE, &fromMetric);
+
+	for (i = 0; i < count; i++)
+	{
+		convertValues(((ConvertBatch[i].usUnits) ? &fromUS : &fromMetric), ConvertBatch[i].value);
+	}
+
+	return count;
+}
+
+//  add one converted archive record into 'store' and 'windId';
+//  return the record's interval in minutes
+static int accumulateRecord
+(
+	ARCHIVE_PKT*            record,
+	WAVG_ID                 windId,
+	HISTORY_DATA*           store
+)
+{
+	Data_Indices            index;
+	float                   value;
+
+	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
+	{
+		// Check for wview NULL value:
+		if (record->value[index] > ARCHIVE_VALUE_NULL)
+		{
+			store->samples[index] += 1;
+			store->values[index] += record->value[index];
+		}
+	}
+
+	value = record->value[DATA_INDEX_windDir];
+	if (value > ARCHIVE_VALUE_NULL)
+	{
+		if (value >= 0 && value < 360)
+		{
+			lastWDIR = (int)value;
+		}
+		windAverageAddValue(windId, lastWDIR);
+	}
+
+	return record->interval;
+}
+
+//  set values with no samples to ARCHIVE_VALUE_NULL
+static void finishAverages(HISTORY_DATA* store)
+{
+	Data_Indices            index;
+
+	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
+	{
+		if (store->samples[index] == 0)
+		{
+			// set value to NULL:
+			store->values[index] = ARCHIVE_VALUE_NULL;
+		}
+	}
+}
+
+//  return num minutes processed or error
+static int rollIntoAverages
+(
+	int                     isMetricUnits,
+	WAVG_ID                 windId,
+	time_t                  startTime,
+	HISTORY_DATA*           store,
+	int                     numMins
+)
+{
+	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
+	int                     mins = 0;
+	time_t                  endTime = startTime + (numMins * 60);
+	int                     i, count;
+
+	if (archiveDB == NULL)
+	{
+		MsgLog(PRI_HIGH, "rollIntoAverages: failed to open %s!", getArchiveDBFilename());
+		return ERROR;
+	}
+
+	// Build the query:
+	sprintf(query, "SELECT * FROM archive WHERE dateTime >= '%d' AND dateTime < '%d' ORDER BY dateTime ASC",
+		(int)startTime, (int)endTime);
+
+	// Execute the query:
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
+	{
+		return ERROR;
+	}
+
+	while ((count = readConvertedBatch(isMetricUnits, CONVERT_BATCH_RECORDS)) > 0)
+	{
+		for (i = 0; i < count; i++)
+		{
+			mins += accumulateRecord(&ConvertBatch[i], windId, store);
+		}
+	}
+
+	radsqlitedirectReleaseResults(archiveDB);
+	if (count == ERROR)
+	{
+		return ERROR;
+	}
+
+	// Finally, check to be sure values were found, if not, set to ARCHIVE_VALUE_NULL:
+	finishAverages(store);
+
+	return mins;
+}
+#endif
+
+static time_t getNewestDateTime(ARCHIVE_PKT* newRec)
+{
+	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
+	SQLITE_DIRECT_ROW       rowDescr;
+	SQLITE_FIELD_ID         field;
+	time_t                  retVal;
+
+	if (archiveDB == NULL)
+	{
+		MsgLog(PRI_HIGH, "getNewestDateTime: failed to open %s!", getArchiveDBFilename());
+		return ERROR;
+	}
+
+	// Build the query:
+	sprintf(query, "SELECT MAX(dateTime) AS 'max' FROM archive");
+
+	// Execute the query:
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
+	{
+		MsgLog(PRI_HIGH, "getNewestDateTime: radsqlitedirectQuery failed!");
+		return ERROR;
+	}
+
+	rowDescr = radsqlitedirectGetRow(archiveDB);
+	if (rowDescr == NULL)
+	{
+		MsgLog(PRI_MEDIUM,
+			"getNewestDateTime: radsqlitedirectGetRow failed!");
+		radsqlitedirectReleaseResults(archiveDB);
+		return ERROR;
+	}
+
+	field = radsqlitedirectFieldGet(rowDescr, "max");
+	if (field == NULL)
+	{
+		MsgLog(PRI_MEDIUM,
+			"getNewestDateTime: radsqlitedirectFieldGet failed!");
+		radsqlitedirectReleaseResults(archiveDB);
+		return ERROR;
+	}
+
+	retVal = (time_t)radsqliteFieldGetBigIntValue(field);
+
+	// Clean up:
+	radsqlitedirectReleaseResults(archiveDB);
+
+	// Now grab the entire row:
+	sprintf(query, "SELECT * FROM archive WHERE dateTime = '%d'", (int)retVal);
+
+	// Execute the query:
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
+	{
+		MsgLog(PRI_HIGH, "getNewestDateTime: radsqlitedirectQuery failed!");
+		return ERROR;
+	}
+
+	rowDescr = radsqlitedirectGetRow(archiveDB);
+	if (rowDescr == NULL)
+	{
+		MsgLog(PRI_MEDIUM,
+			"getNewestDateTime: radsqlitedirectGetRow failed!");
+		radsqlitedirectReleaseResults(archiveDB);
+		return ERROR;
+	}
+
+	// finally copy it to the internal PKT:
+	getDBData(rowDescr, newRec);
+
+	radsqlitedirectReleaseResults(archiveDB);
+	return retVal;
+}
+
+static int getNextRecord(time_t dateTime, ARCHIVE_PKT* newRec)
+{
+	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
+	SQLITE_DIRECT_ROW       rowDescr;
+	SQLITE_FIELD_ID         field;
+	time_t                  retVal;
+
+	if (archiveDB == NULL)
+	{
+		MsgLog(PRI_HIGH, "getNextRecord: failed to open %s!", getArchiveDBFilename());
+		return ERROR;
+	}
+
+	// Build the query:
+	sprintf(query, "SELECT MIN(dateTime) AS 'min' FROM archive WHERE dateTime > '%d'",
+		(int)dateTime);
+
+	// Execute the query:
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
+	{
+		return ERROR;
+	}
+
+	rowDescr = radsqlitedirectGetRow(archiveDB);
+	if (rowDescr == NULL)
+	{
+		radsqlitedirectReleaseResults(archiveDB);
+		return ERROR;
+	}
+
+	field = radsqlitedirectFieldGet(rowDescr, "min");
+	if (field == NULL)
+	{
+		MsgLog(PRI_MEDIUM,
+			"getNextRecord: radsqlitedirectFieldGet failed!");
+		radsqlitedirectReleaseResults(archiveDB);
+		return ERROR;
+	}
+
+	retVal = (time_t)radsqliteFieldGetBigIntValue(field);
+
 	// Clean up:
 	radsqlitedirectReleaseResults(archiveDB);
 
@@ -648,7 +1121,7 @@ static int getNextRecord(time_t dateTime, ARCHIVE_PKT* newRec)
 	sprintf(query, "SELECT * FROM archive WHERE dateTime = '%d'", (int)retVal);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
 	{
 		return ERROR;
 	}
@@ -682,7 +1155,7 @@ static int getRecord(time_t dateTime, ARCHIVE_PKT* newRec)
 	sprintf(query, "SELECT * FROM archive WHERE dateTime = '%d'", (int)dateTime);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
 	{
 		return ERROR;
 	}
@@ -717,7 +1190,7 @@ static int getFirstRecord(time_t startTime, time_t stopTime, ARCHIVE_PKT* record
 		(int)startTime, (int)stopTime);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
 	{
 		return ERROR;
 	}
@@ -754,7 +1227,7 @@ static int getCount(char* whereClause)
 		whereClause);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
 	{
 		MsgLog(PRI_HIGH, "getCount: radsqlitedirectQuery failed!");
 		return ERROR;
@@ -791,7 +1264,7 @@ static int getCount(char* whereClause)
 // Initialize the database interface (returns OK or ERROR):
 int dbsqliteArchiveInit(void)
 {
-	archiveDB = radsqliteOpen(getArchiveDBFilename());
+	archiveDB = dbsqliteSessionOpen(getArchiveDBFilename(), "archive", DBSQLITE_PROFILE_PRIMARY);
 	if (archiveDB == NULL)
 	{
 		MsgLog(PRI_HIGH, "dbsqliteArchiveInit: failed to open %s!", getArchiveDBFilename());
@@ -804,8 +1277,12 @@ int dbsqliteArchiveInit(void)
 // Clean up the database interface:
 void dbsqliteArchiveExit(void)
 {
+	writerClose();
 	if (archiveDB)
-		radsqliteClose(archiveDB);
+	{
+		dbsqliteSessionClose(archiveDB);
+		archiveDB = NULL;
+	}
 }
 
 // PRAGMA statement to modify the operation of the SQLite library
@@ -813,83 +1290,461 @@ int dbsqliteArchivePragmaSet(char* pragma, char* setting)
 {
 	char        query[DB_SQLITE_QUERY_LENGTH_MAX];
 
-	// Check SQLite version if a journalling pragma:
-	if (!strcmp(pragma, "journal_mode"))
+	// Check SQLite version if a journalling pragma:
+	if (!strcmp(pragma, "journal_mode"))
+	{
+		if (SQLITE_VERSION_NUMBER < 3005009)
+		{
+			// Not supported:
+			return OK;
+		}
+	}
+
+	sprintf(query, "PRAGMA %s = %s", pragma, setting);
+
+	// Execute the query:
+	if (dbsqliteSessionQuery(archiveDB, query, FALSE) == ERROR)
+	{
+		return ERROR;
+	}
+
+	return OK;
+}
+
+//  ... Reset the default archive database location (used by conversion utils);
+void dbsqliteArchiveSetPath(char* newPath)
+{
+	wvstrncpy(DefaultArchivePath, newPath, _MAX_PATH);
+}
+
+char* dbsqliteArchiveGetPath(void)
+{
+	return DefaultArchivePath;
+}
+
+#if defined(BUILD_HTMLGEND) || defined(BUILD_WVIEWD)
+
+//  ... calculate averages over a given period of time
+//  ... (given in arcInterval minute samples);
+//  ... this will zero out the HISTORY_DATA store before beginning
+//  ... the processing;
+//  ... returns OK or ERROR
+
+int dbsqliteArchiveGetAverages
+(
+	int             isMetricUnits,
+	int             arcInterval,
+	HISTORY_DATA*    store,
+	time_t          startTime,
+	int             numSamples
+)
+{
+	int             retVal;
+	int             numMins = numSamples * arcInterval;
+	WAVG            windAvg;
+
+	memset(store, 0, sizeof(HISTORY_DATA));
+	store->startTime = startTime;
+
+	//  create the wind average object
+	windAverageReset(&windAvg);
+
+	retVal = rollIntoAverages(isMetricUnits,
+		&windAvg,
+		startTime,
+		store,
+		numMins);
+
+	if (retVal > 0)
+	{
+		store->values[DATA_INDEX_windDir] = windAverageCompute(&windAvg);
+	}
+
+	return retVal;
+}
+
+//  ... calculate averages for 'numBuckets' consecutive windows of
+//  ... 'bucketSeconds' each, starting at 'startTime', in one pass over the
+//  ... archive; each bucket is filled as dbsqliteArchiveGetAverages would;
+//  ... returns the number of buckets with data or ERROR
+
+int dbsqliteArchiveGetAveragesRange
+(
+	int             isMetricUnits,
+	HISTORY_DATA*   stores,
+	time_t          startTime,
+	int             bucketSeconds,
+	int             numBuckets
+)
+{
+	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
+	WAVG*                   windAvgs;
+	int*                    mins;
+	int                     i, bucket, count, retVal = 0;
+
+	if (archiveDB == NULL)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteArchiveGetAveragesRange: failed to open %s!", getArchiveDBFilename());
+		return ERROR;
+	}
+	if (numBuckets <= 0 || bucketSeconds <= 0)
+	{
+		return 0;
+	}
+
+	windAvgs = (WAVG*)malloc(numBuckets * sizeof(WAVG));
+	mins = (int*)calloc(numBuckets, sizeof(int));
+	if (windAvgs == NULL || mins == NULL)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteArchiveGetAveragesRange: cannot allocate %d buckets", numBuckets);
+		free(windAvgs);
+		free(mins);
+		return ERROR;
+	}
+
+	for (i = 0; i < numBuckets; i++)
+	{
+		memset(&stores[i], 0, sizeof(HISTORY_DATA));
+		stores[i].startTime = startTime + ((time_t)i * bucketSeconds);
+		windAverageReset(&windAvgs[i]);
+	}
+
+	sprintf(query, "SELECT * FROM archive WHERE dateTime >= '%d' AND dateTime < '%d' ORDER BY dateTime ASC",
+		(int)startTime, (int)(startTime + ((time_t)numBuckets * bucketSeconds)));
+
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
+	{
+		free(windAvgs);
+		free(mins);
+		return ERROR;
+	}
+
+	while ((count = readConvertedBatch(isMetricUnits, CONVERT_BATCH_RECORDS)) > 0)
+	{
+		for (i = 0; i < count; i++)
+		{
+			bucket = (int)(((time_t)ConvertBatch[i].dateTime - startTime) / bucketSeconds);
+			if (bucket < 0 || bucket >= numBuckets)
+			{
+				continue;
+			}
+
+			mins[bucket] += accumulateRecord(&ConvertBatch[i], &windAvgs[bucket], &stores[bucket]);
+		}
+	}
+
+	radsqlitedirectReleaseResults(archiveDB);
+	if (count == ERROR)
+	{
+		retVal = ERROR;
+	}
+
+	if (retVal != ERROR)
+	{
+		for (i = 0; i < numBuckets; i++)
+		{
+			finishAverages(&stores[i]);
+			if (mins[i] > 0)
+			{
+				stores[i].values[DATA_INDEX_windDir] = windAverageCompute(&windAvgs[i]);
+				retVal ++;
+			}
+		}
+	}
+
+	free(windAvgs);
+	free(mins);
+	return retVal;
+}
+
+//  ... add one tier row (or SUM over tier rows) into 'store';
+//  ... returns the row's minutes or ERROR
+static int tierRowToStore
+(
+	SQLITE_DIRECT_ROW       rowDescr,
+	int                     isMetricUnits,
+	HISTORY_DATA*           store
+)
+{
+	char                    name[64];
+	SQLITE_FIELD_ID         field;
+	Data_Indices            index;
+	WAVG                    windAvg;
+	int                     bins[WAVG_NUM_BINS];
+	int64_t                 count, maxBin = 0;
+	UNIT_CONVERSION         conv;
+	int                     i, mins, scale;
+	float                   sum;
+
+	field = radsqlitedirectFieldGet(rowDescr, "mins");
+	if (field == NULL)
+	{
+		MsgLog(PRI_MEDIUM, "tierRowToStore: radsqlitedirectFieldGet failed!");
+		return ERROR;
+	}
+	mins = (FIELD_IS_NULL(field)) ? 0 : (int)radsqliteFieldGetBigIntValue(field);
+
+	// the tiers are kept in US units:
+	buildConversion(isMetricUnits, TRUE, &conv);
+
+	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
+	{
+		sprintf(name, "%s_n", ArchiveValueName[index]);
+		field = radsqlitedirectFieldGet(rowDescr, name);
+		if (field == NULL)
+		{
+			MsgLog(PRI_MEDIUM, "tierRowToStore: radsqlitedirectFieldGet %s failed!", name);
+			return ERROR;
+		}
+		count = (FIELD_IS_NULL(field)) ? 0 : radsqliteFieldGetBigIntValue(field);
+		if (count <= 0)
+		{
+			continue;
+		}
+
+		sprintf(name, "%s_sum", ArchiveValueName[index]);
+		field = radsqlitedirectFieldGet(rowDescr, name);
+		if (field == NULL)
+		{
+			MsgLog(PRI_MEDIUM, "tierRowToStore: radsqlitedirectFieldGet %s failed!", name);
+			return ERROR;
+		}
+		sum = (float)radsqliteFieldGetDoubleValue(field);
+
+		// affine, so the converted sum is the sum scaled plus one offset per sample:
+		store->samples[index] += (int)count;
+		store->values[index] += (sum * conv.scale[index]) + (conv.offset[index] * (float)count);
+	}
+
+	// wind bins can outgrow the WAVG counters over a long range - scale
+	// them down together, the consensus only needs their proportions:
+	for (i = 0; i < WAVG_NUM_BINS; i++)
+	{
+		sprintf(name, "wbin%d", i);
+		field = radsqlitedirectFieldGet(rowDescr, name);
+		if (field == NULL)
+		{
+			MsgLog(PRI_MEDIUM, "tierRowToStore: radsqlitedirectFieldGet %s failed!", name);
+			return ERROR;
+		}
+		count = (FIELD_IS_NULL(field)) ? 0 : radsqliteFieldGetBigIntValue(field);
+		bins[i] = (int)count;
+		if (count > maxBin)
+		{
+			maxBin = count;
+		}
+	}
+	scale = (int)(maxBin / 16384) + 1;
+	for (i = 0; i < WAVG_NUM_BINS; i++)
+	{
+		bins[i] /= scale;
+	}
+
+	windAverageReset(&windAvg);
+	windAverageAddBins(&windAvg, bins);
+	store->values[DATA_INDEX_windDir] = windAverageCompute(&windAvg);
+
+	return mins;
+}
+
+//  ... the tier rows in [startTime, stopTime) hold records up to a day past
+//  ... stopTime; they are only complete if the rebuild is done with those
+static int tierRangeBuilt(time_t startTime, time_t stopTime)
+{
+	SQLITE_DIRECT_ROW       rowDescr;
+	SQLITE_FIELD_ID         field;
+	time_t                  rebuildNext, rebuildBefore;
+	int                     retVal = TRUE;
+
+	if (dbsqliteSessionDirectQuery(archiveDB,
+		"SELECT rebuildNext, rebuildBefore FROM " TIER_STATE_TABLE, TRUE) == ERROR)
+	{
+		// no state table - tiers from an older wviewd, don't trust them:
+		return FALSE;
+	}
+
+	rowDescr = radsqlitedirectGetRow(archiveDB);
+	if (rowDescr != NULL)
+	{
+		field = radsqlitedirectFieldGet(rowDescr, "rebuildNext");
+		rebuildNext = (field == NULL) ? 0 : (time_t)radsqliteFieldGetBigIntValue(field);
+		field = radsqlitedirectFieldGet(rowDescr, "rebuildBefore");
+		rebuildBefore = (field == NULL) ? 0 : (time_t)radsqliteFieldGetBigIntValue(field);
+
+		if (rebuildNext < rebuildBefore &&
+			rebuildNext <= stopTime + WV_SECONDS_IN_DAY && rebuildBefore > startTime)
+		{
+			retVal = FALSE;
+		}
+	}
+
+	radsqlitedirectReleaseResults(archiveDB);
+	return retVal;
+}
+
+//  ... sum the tier rows in [startTime, stopTime) into 'store';
+//  ... returns number of minutes found or ERROR
+
+int dbsqliteArchiveGetTierAverages
+(
+	int             isMetricUnits,
+	DBSQLITE_TIER   tier,
+	time_t          startTime,
+	time_t          stopTime,
+	HISTORY_DATA*   store
+)
+{
+	char                    query[TIER_QUERY_LENGTH_MAX];
+	SQLITE_DIRECT_ROW       rowDescr;
+	Data_Indices            index;
+	int                     i, len, retVal;
+
+	memset(store, 0, sizeof(HISTORY_DATA));
+	store->startTime = startTime;
+
+	if (archiveDB == NULL)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteArchiveGetTierAverages: failed to open %s!", getArchiveDBFilename());
+		return ERROR;
+	}
+
+	if (!tierRangeBuilt(startTime, stopTime))
 	{
-		if (SQLITE_VERSION_NUMBER < 3005009)
-		{
-			// Not supported:
-			return OK;
-		}
+		return ERROR;
 	}
 
-	sprintf(query, "PRAGMA %s = %s", pragma, setting);
+	len = sprintf(query, "SELECT SUM(mins) AS mins");
+	for (index = DATA_INDEX_barometer; index < DATA_INDEX_MAX; index++)
+	{
+		len += sprintf(&query[len], ", SUM(%s_sum) AS %s_sum, SUM(%s_n) AS %s_n",
+			ArchiveValueName[index], ArchiveValueName[index],
+			ArchiveValueName[index], ArchiveValueName[index]);
+	}
+	for (i = 0; i < WAVG_NUM_BINS; i++)
+	{
+		len += sprintf(&query[len], ", SUM(wbin%d) AS wbin%d", i, i);
+	}
+	sprintf(&query[len], " FROM %s WHERE startTime >= '%d' AND startTime < '%d'",
+		TierTableName[tier], (int)startTime, (int)stopTime);
 
-	// Execute the query:
-	if (radsqliteQuery(archiveDB, query, FALSE) == ERROR)
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
 	{
 		return ERROR;
 	}
 
-	return OK;
-}
+	rowDescr = radsqlitedirectGetRow(archiveDB);
+	if (rowDescr == NULL)
+	{
+		retVal = 0;
+	}
+	else
+	{
+		retVal = tierRowToStore(rowDescr, isMetricUnits, store);
+	}
 
-//  ... Reset the default archive database location (used by conversion utils);
-void dbsqliteArchiveSetPath(char* newPath)
-{
-	wvstrncpy(DefaultArchivePath, newPath, _MAX_PATH);
+	radsqlitedirectReleaseResults(archiveDB);
+	finishAverages(store);
+	return retVal;
 }
+#endif
 
-char* dbsqliteArchiveGetPath(void)
+#if defined(BUILD_HTMLGEND)
+
+//  ... report timestamps: localtime_r once per local hour, the minute is
+//  ... the offset into the cached hour
+typedef struct
 {
-	return DefaultArchivePath;
-}
+	time_t      hourStart;
+	int         year, month, day, hour;
+} REPORT_CALENDAR;
 
-#if defined(BUILD_HTMLGEND) || defined(BUILD_WVIEWD)
+//  ... the live append file stays open until the day (file name) changes
+static FILE*    reportFile;
+static char     reportFileName[_MAX_PATH];
 
-//  ... calculate averages over a given period of time
-//  ... (given in arcInterval minute samples);
-//  ... this will zero out the HISTORY_DATA store before beginning
-//  ... the processing;
-//  ... returns OK or ERROR
+static void reportCloseCached(void)
+{
+	if (reportFile != NULL)
+	{
+		fclose(reportFile);
+		reportFile = NULL;
+	}
+	reportFileName[0] = 0;
+}
 
-int dbsqliteArchiveGetAverages
+static int formatReportLine
 (
-	int             isMetricUnits,
-	int             arcInterval,
-	HISTORY_DATA*    store,
-	time_t          startTime,
-	int             numSamples
+	ARCHIVE_PKT*        data,
+	int                 isMetric,
+	REPORT_CALENDAR*    calendar,
+	char*               store
 )
 {
-	int             retVal;
-	int             numMins = numSamples * arcInterval;
-	WAVG            windAvg;
-
-	memset(store, 0, sizeof(HISTORY_DATA));
-	store->startTime = startTime;
-
-	//  create the wind average object
-	windAverageReset(&windAvg);
-
-	retVal = rollIntoAverages(isMetricUnits,
-		&windAvg,
-		startTime,
-		store,
-		numMins);
+	struct tm           locTime;
+	time_t              timeval = (time_t)data->dateTime;
 
-	if (retVal > 0)
+	if (calendar->hourStart == 0 ||
+		timeval < calendar->hourStart || timeval >= calendar->hourStart + 3600)
 	{
-		store->values[DATA_INDEX_windDir] = windAverageCompute(&windAvg);
+		localtime_r(&timeval, &locTime);
+		calendar->year = locTime.tm_year + 1900;
+		calendar->month = locTime.tm_mon + 1;
+		calendar->day = locTime.tm_mday;
+		calendar->hour = locTime.tm_hour;
+		calendar->hourStart = timeval - (locTime.tm_min * 60) - locTime.tm_sec;
 	}
 
-	return retVal;
+	if (!isMetric)
+	{
+		return sprintf(store,
+			"%4.4d%2.2d%2.2d %2.2d:%2.2d\t%.1f\t%.1f\t%.1f\t%.0f\t%.1f\t%.0f\t%.0f\t%.0f\t%.2f\t%.3f\t%.0f\t%.3f\t%.1f\n",
+			calendar->year,
+			calendar->month,
+			calendar->day,
+			calendar->hour,
+			(int)((timeval - calendar->hourStart) / 60),
+			data->value[DATA_INDEX_outTemp],
+			data->value[DATA_INDEX_windchill],
+			data->value[DATA_INDEX_heatindex],
+			data->value[DATA_INDEX_outHumidity],
+			data->value[DATA_INDEX_dewpoint],
+			data->value[DATA_INDEX_windSpeed],
+			data->value[DATA_INDEX_windGust],
+			data->value[DATA_INDEX_windDir],
+			data->value[DATA_INDEX_rain],
+			data->value[DATA_INDEX_barometer],
+			data->value[DATA_INDEX_radiation],
+			data->value[DATA_INDEX_ET],
+			data->value[DATA_INDEX_UV]);
+	}
+	else
+	{
+		//    "--Timestamp---\tTemp\tChill\tHIndex\tHumid\tDewpt\tWind\tHiWind\tWindDir\tRain\tBarom\tSolar\tET\tUV\n"
+		return sprintf(store,
+			"%4.4d%2.2d%2.2d %2.2d:%2.2d\t%.1f\t%.1f\t%.1f\t%.0f\t%.1f\t%.0f\t%.0f\t%.0f\t%.1f\t%.1f\t%.0f\t%.3f\t%.1f\n",
+			calendar->year,
+			calendar->month,
+			calendar->day,
+			calendar->hour,
+			(int)((timeval - calendar->hourStart) / 60),
+			wvutilsConvertFToC(data->value[DATA_INDEX_outTemp]),
+			wvutilsConvertFToC(data->value[DATA_INDEX_windchill]),
+			wvutilsConvertFToC(data->value[DATA_INDEX_heatindex]),
+			data->value[DATA_INDEX_outHumidity],
+			wvutilsConvertFToC(data->value[DATA_INDEX_dewpoint]),
+			wvutilsConvertMPHToKPH(data->value[DATA_INDEX_windSpeed]),
+			wvutilsConvertMPHToKPH(data->value[DATA_INDEX_windGust]),
+			data->value[DATA_INDEX_windDir],
+			wvutilsConvertRainINToMetric(data->value[DATA_INDEX_rain]),
+			wvutilsConvertINHGToHPA(data->value[DATA_INDEX_barometer]),
+			data->value[DATA_INDEX_radiation],
+			wvutilsConvertRainINToMetric(data->value[DATA_INDEX_ET]),
+			data->value[DATA_INDEX_UV]);
+	}
 }
-#endif
-
-#if defined(BUILD_HTMLGEND)
 
-// write out all ASCII archive records for the given day to 'filename'
+// write out all ASCII archive records for the given day to 'filename';
+// the report is built in memory and replaces the old one in one rename
 int dbsqliteWriteDailyArchiveReport
 (
 	char*                    filename,
@@ -901,11 +1756,16 @@ int dbsqliteWriteDailyArchiveReport
 {
 	struct tm               locTime;
 	time_t                  startTime, stopTime;
-	struct stat             fileStatus;
 	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
+	char                    tempName[_MAX_PATH];
+	char                    line[256];
 	SQLITE_DIRECT_ROW       rowDescr;
 	ARCHIVE_PKT             arcRecord;
-	int                     numrecs = 0;
+	REPORT_CALENDAR         calendar;
+	FILE*                   report;
+	char*                   buffer = NULL;
+	size_t                  bufferSize = 0;
+	int                     numrecs = 0, length, retVal = OK;
 
 	localtime_r(&timeval, &locTime);
 	locTime.tm_hour = 0;
@@ -915,15 +1775,23 @@ int dbsqliteWriteDailyArchiveReport
 	startTime = (time_t)mktime(&locTime);
 	stopTime = startTime + WV_SECONDS_IN_DAY;
 
-	if (stat(filename, &fileStatus) != -1)
+	// a live append handle on this file would point at the old inode:
+	if (!strcmp(filename, reportFileName))
 	{
-		//  exists, delete it
-		unlink(filename);
+		reportCloseCached();
 	}
 
 	if (archiveDB == NULL)
 	{
 		MsgLog(PRI_HIGH, "dbsqliteWriteDailyArchiveReport: failed to open %s!", getArchiveDBFilename());
+		unlink(filename);
+		return ERROR;
+	}
+
+	report = open_memstream(&buffer, &bufferSize);
+	if (report == NULL)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteWriteDailyArchiveReport: open_memstream failed!");
 		return ERROR;
 	}
 
@@ -932,11 +1800,17 @@ int dbsqliteWriteDailyArchiveReport
 		(int)startTime, (int)stopTime);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
 	{
+		fclose(report);
+		free(buffer);
+		unlink(filename);
 		return ERROR;
 	}
 
+	memset(&calendar, 0, sizeof(calendar));
+	(*writeHeader)(report);
+
 	for (rowDescr = radsqlitedirectGetRow(archiveDB);
 		rowDescr != NULL;
 		rowDescr = radsqlitedirectGetRow(archiveDB))
@@ -948,25 +1822,53 @@ int dbsqliteWriteDailyArchiveReport
 			continue;
 		}
 
-		// call our little updater
-		dbsqliteUpdateDailyArchiveReport(filename, &arcRecord, writeHeader, isMetric);
-
+		length = formatReportLine(&arcRecord, isMetric, &calendar, line);
+		fwrite(line, 1, length, report);
 		numrecs++;
 	}
 
 	radsqlitedirectReleaseResults(archiveDB);
+	fclose(report);
 
-	if (numrecs > 0)
+	if (numrecs == 0)
 	{
-		return OK;
+		// no records, no report:
+		free(buffer);
+		unlink(filename);
+		return ERROR;
 	}
-	else
+
+	sprintf(tempName, "%s.tmp", filename);
+	report = fopen(tempName, "w");
+	if (report == NULL)
+	{
+		MsgLog(PRI_MEDIUM, "dbsqliteWriteDailyArchiveReport: cannot open %s!", tempName);
+		free(buffer);
+		return ERROR;
+	}
+
+	if (fwrite(buffer, 1, bufferSize, report) != bufferSize)
 	{
+		retVal = ERROR;
+	}
+	if (fclose(report) != 0)
+	{
+		retVal = ERROR;
+	}
+	free(buffer);
+
+	if (retVal == ERROR || rename(tempName, filename) != 0)
+	{
+		MsgLog(PRI_MEDIUM, "dbsqliteWriteDailyArchiveReport: writing %s failed!", filename);
+		unlink(tempName);
 		return ERROR;
 	}
+
+	return OK;
 }
 
-// update (or create) the current day's ASCII archive records file
+// update (or create) the current day's ASCII archive records file;
+// returns 1 if the file was created (header written), OK or ERROR
 int dbsqliteUpdateDailyArchiveReport
 (
 	char*            file,
@@ -976,107 +1878,195 @@ int dbsqliteUpdateDailyArchiveReport
 )
 
 {
-	FILE*            outfile;
+	REPORT_CALENDAR calendar;
 	char            temp[256];
 	struct stat     fileStatus;
-	int             writeHeader = FALSE;
+	int             writeHeader = FALSE, length;
 
-	if (stat(file, &fileStatus) == -1)
+	// first, take care of creating/opening the file
+	if (reportFile == NULL || strcmp(file, reportFileName))
 	{
-		//  new file, write a header
-		writeHeader = TRUE;
+		reportCloseCached();
+
+		if (stat(file, &fileStatus) == -1)
+		{
+			//  new file, write a header
+			writeHeader = TRUE;
+		}
+
+		reportFile = fopen(file, "a");
+		if (reportFile == NULL)
+		{
+			return ERROR;
+		}
+		wvstrncpy(reportFileName, file, sizeof(reportFileName));
+
+		if (writeHeader)
+		{
+			// callback the user with the supplied routine
+			(*writeHeaderFcn)(reportFile);
+		}
 	}
 
-	// first, take care of creating/opening the file
-	outfile = fopen(file, "a");
-	if (outfile == NULL)
+	// append the new record
+	memset(&calendar, 0, sizeof(calendar));
+	length = formatReportLine(data, isMetric, &calendar, temp);
+
+	if (fwrite(temp, 1, length, reportFile) != (size_t)length ||
+		fflush(reportFile) != 0)
 	{
+		reportCloseCached();
 		return ERROR;
 	}
 
 	if (writeHeader)
+		return 1;
+	else
+		return OK;
+}
+#endif
+
+//  ... append an archive record to the archive database;
+//  ... returns OK or ERROR
+
+int dbsqliteArchiveStoreRecord(ARCHIVE_PKT* record)
+{
+	return ((dbsqliteArchiveStoreRecords(record, 1) == 1) ? OK : ERROR);
+}
+
+//  ... append 'count' archive records in one transaction; a record that fails
+//  ... (duplicate time) doesn't stop the rest;
+//  ... returns the number stored or ERROR
+
+int dbsqliteArchiveStoreRecords(ARCHIVE_PKT* records, int count)
+{
+	int         i, stored = 0, ownTransaction;
+
+	if (writerOpen() == ERROR)
 	{
-		// callback the user with the supplied routine
-		(*writeHeaderFcn)(outfile);
+		return ERROR;
 	}
 
-	// append the new record
-
-	if (!isMetric)
+	ownTransaction = (count > 1);
+	if (ownTransaction && writerExec("BEGIN TRANSACTION") == ERROR)
 	{
-		sprintf(temp,
-			"%4.4d%2.2d%2.2d %2.2d:%2.2d\t%.1f\t%.1f\t%.1f\t%.0f\t%.1f\t%.0f\t%.0f\t%.0f\t%.2f\t%.3f\t%.0f\t%.3f\t%.1f\n",
-			wvutilsGetYear(data->dateTime),
-			wvutilsGetMonth(data->dateTime),
-			wvutilsGetDay(data->dateTime),
-			wvutilsGetHour(data->dateTime),
-			wvutilsGetMin(data->dateTime),
-			data->value[DATA_INDEX_outTemp],
-			data->value[DATA_INDEX_windchill],
-			data->value[DATA_INDEX_heatindex],
-			data->value[DATA_INDEX_outHumidity],
-			data->value[DATA_INDEX_dewpoint],
-			data->value[DATA_INDEX_windSpeed],
-			data->value[DATA_INDEX_windGust],
-			data->value[DATA_INDEX_windDir],
-			data->value[DATA_INDEX_rain],
-			data->value[DATA_INDEX_barometer],
-			data->value[DATA_INDEX_radiation],
-			data->value[DATA_INDEX_ET],
-			data->value[DATA_INDEX_UV]);
+		return ERROR;
 	}
-	else
+
+	for (i = 0; i < count; i++)
 	{
-		//    "--Timestamp---\tTemp\tChill\tHIndex\tHumid\tDewpt\tWind\tHiWind\tWindDir\tRain\tBarom\tSolar\tET\tUV\n"
-		sprintf(temp,
-			"%4.4d%2.2d%2.2d %2.2d:%2.2d\t%.1f\t%.1f\t%.1f\t%.0f\t%.1f\t%.0f\t%.0f\t%.0f\t%.1f\t%.1f\t%.0f\t%.3f\t%.1f\n",
-			wvutilsGetYear(data->dateTime),
-			wvutilsGetMonth(data->dateTime),
-			wvutilsGetDay(data->dateTime),
-			wvutilsGetHour(data->dateTime),
-			wvutilsGetMin(data->dateTime),
-			wvutilsConvertFToC(data->value[DATA_INDEX_outTemp]),
-			wvutilsConvertFToC(data->value[DATA_INDEX_windchill]),
-			wvutilsConvertFToC(data->value[DATA_INDEX_heatindex]),
-			data->value[DATA_INDEX_outHumidity],
-			wvutilsConvertFToC(data->value[DATA_INDEX_dewpoint]),
-			wvutilsConvertMPHToKPH(data->value[DATA_INDEX_windSpeed]),
-			wvutilsConvertMPHToKPH(data->value[DATA_INDEX_windGust]),
-			data->value[DATA_INDEX_windDir],
-			wvutilsConvertRainINToMetric(data->value[DATA_INDEX_rain]),
-			wvutilsConvertINHGToHPA(data->value[DATA_INDEX_barometer]),
-			data->value[DATA_INDEX_radiation],
-			wvutilsConvertRainINToMetric(data->value[DATA_INDEX_ET]),
-			data->value[DATA_INDEX_UV]);
+		if (insertDBData(&records[i]) == OK)
+		{
+			stored ++;
+		}
 	}
 
-	if (fwrite(temp, 1, strlen(temp), outfile) != strlen(temp))
+	if (ownTransaction && writerExec("COMMIT TRANSACTION") == ERROR)
 	{
-		fclose(outfile);
+		writerExec("ROLLBACK TRANSACTION");
 		return ERROR;
 	}
 
-	// cleanup and bail out
-	fclose(outfile);
-
-	if (writeHeader)
-		return 1;
-	else
-		return OK;
+	return stored;
 }
-#endif
 
-//  ... append an archive record to the archive database;
-//  ... returns OK or ERROR
+//  ... fold up to 'maxRecords' more of the existing archive into the tiers
+//  ... (one transaction per step); returns TRUE while more remain, FALSE
+//  ... when the tiers are complete or ERROR
 
-int dbsqliteArchiveStoreRecord(ARCHIVE_PKT* record)
+int dbsqliteArchiveTierRebuildStep(int maxRecords)
 {
-	char        fileName[128];
+	ARCHIVE_PKT     record;
+	Data_Indices    index;
+	time_t          next;
+	int             column, count = 0, result;
+	char            query[DB_SQLITE_QUERY_LENGTH_MAX];
 
-	insertDBData(record);
-	//sprintf( fileName, "%s/export/%s", wvutilsGetConfigPath(), WVIEW_ARCHIVE_MARKER_FILE );
-	//wvutilsWriteMarkerFile( fileName, record->dateTime );
-	return OK;
+	if (writerOpen() == ERROR)
+	{
+		return ERROR;
+	}
+	if (!tierRebuildPending())
+	{
+		return FALSE;
+	}
+	if (writerExec("BEGIN TRANSACTION") == ERROR)
+	{
+		return ERROR;
+	}
+
+	next = tierRebuildBefore;
+	sqlite3_reset(tierRebuildStmt);
+	sqlite3_bind_int64(tierRebuildStmt, 1, (sqlite3_int64)tierRebuildNext);
+	sqlite3_bind_int64(tierRebuildStmt, 2, (sqlite3_int64)tierRebuildBefore);
+	sqlite3_bind_int(tierRebuildStmt, 3, maxRecords);
+
+	while ((result = sqlite3_step(tierRebuildStmt)) == SQLITE_ROW)
+	{
+		memset(&record, 0, sizeof(record));
+		record.dateTime = (int32_t)sqlite3_column_int64(tierRebuildStmt, 0);
+		record.usUnits  = sqlite3_column_int(tierRebuildStmt, 1);
+		record.interval = sqlite3_column_int(tierRebuildStmt, 2);
+		for (index = DATA_INDEX_barometer, column = 3; index < DATA_INDEX_MAX; index++, column++)
+		{
+			if (sqlite3_column_type(tierRebuildStmt, column) == SQLITE_NULL)
+			{
+				record.value[index] = ARCHIVE_VALUE_NULL;
+			}
+			else
+			{
+				record.value[index] = (float)sqlite3_column_double(tierRebuildStmt, column);
+			}
+		}
+
+		if (tierAccumulate(&record) == ERROR)
+		{
+			sqlite3_reset(tierRebuildStmt);
+			writerExec("ROLLBACK TRANSACTION");
+			return ERROR;
+		}
+		next = (time_t)record.dateTime + 1;
+		count ++;
+	}
+	sqlite3_reset(tierRebuildStmt);
+
+	if (result != SQLITE_DONE)
+	{
+		MsgLog(PRI_HIGH, "dbsqlite: tier rebuild read failed: %s", sqlite3_errmsg(archiveWriteDB));
+		writerExec("ROLLBACK TRANSACTION");
+		return ERROR;
+	}
+
+	// a short step means the range is done:
+	if (count < maxRecords)
+	{
+		next = tierRebuildBefore;
+	}
+
+	if (next >= tierRebuildBefore)
+	{
+		sprintf(query, "DELETE FROM %s", TIER_STATE_TABLE);
+	}
+	else
+	{
+		sprintf(query, "UPDATE %s SET rebuildNext = %d", TIER_STATE_TABLE, (int)next);
+	}
+	if (writerExec(query) == ERROR || writerExec("COMMIT TRANSACTION") == ERROR)
+	{
+		writerExec("ROLLBACK TRANSACTION");
+		return ERROR;
+	}
+
+	tierRebuildNext = next;
+	tierRebuildCount += count;
+	if (!tierRebuildPending())
+	{
+		MsgLog(PRI_STATUS, "dbsqlite: average tiers built from %d archive records",
+			tierRebuildCount);
+		return FALSE;
+	}
+
+	return TRUE;
 }
 
 //  ... search the archive path for the most recent archive record date;
@@ -1162,7 +2152,7 @@ int dbsqliteArchiveExecutePerRecord
 	}
 
 	// Execute the query:
-	if (radsqlitedirectQuery(archiveDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(archiveDB, query, TRUE) == ERROR)
 	{
 		return ERROR;
 	}
@@ -59,6 +59,63 @@
 /*  ... API methods
 */
 
+// ------------------------ Session Profiles ----------------------
+typedef enum
+{
+	DBSQLITE_PROFILE_PRIMARY = 0,       // archive: commits reach the disk
+	DBSQLITE_PROFILE_DERIVED,           // rebuildable from the archive
+	DBSQLITE_PROFILE_BULK               // rebuild in progress
+} DBSQLITE_PROFILE;
+
+// Per database health counters (kept across close/reopen):
+typedef struct
+{
+	const char*         name;
+	int                 isOpen;
+	int                 opens;
+	uint64_t            statements;
+	uint64_t            errors;
+	time_t              lastError;
+} DBSQLITE_SESSION_STATS;
+
+// Return this process' long-lived handle for database 'name', opening it
+// and applying 'profile' on first use; close it with dbsqliteSessionClose;
+// returns the handle or NULL
+extern SQLITE_DATABASE_ID dbsqliteSessionOpen
+(
+	const char*         filename,
+	const char*         name,
+	DBSQLITE_PROFILE    profile
+);
+
+extern void dbsqliteSessionClose(SQLITE_DATABASE_ID db);
+
+// Apply the pragma profile (WAL, synchronous, cache_size, mmap_size,
+// temp_store) to an open database and (except for BULK) register it for
+// scheduled checkpoints ('name' is for log messages);
+// returns OK or ERROR
+extern int dbsqliteSessionApplyProfile
+(
+	SQLITE_DATABASE_ID  db,
+	const char*         name,
+	DBSQLITE_PROFILE    profile
+);
+
+// Unregister a database before it is closed:
+extern void dbsqliteSessionRelease(SQLITE_DATABASE_ID db);
+
+// radsqliteQuery/radsqlitedirectQuery, counted against the session:
+extern int dbsqliteSessionQuery(SQLITE_DATABASE_ID db, const char* query, int createResults);
+extern int dbsqliteSessionDirectQuery(SQLITE_DATABASE_ID db, const char* query, int createResults);
+
+// Copy up to 'maxStats' session counters into 'stats';
+// returns the number copied
+extern int dbsqliteSessionGetStats(DBSQLITE_SESSION_STATS* stats, int maxStats);
+
+// Run a passive WAL checkpoint on every registered database;
+// call at quiet moments (after archive generation):
+extern void dbsqliteSessionCheckpoint(void);
+
 // ---------------------- History Computation ---------------------
 
 /*  ... calculate averages over a given period of time
@@ -76,6 +133,54 @@ extern int dbsqliteArchiveGetAverages
 	int             numSamples
 );
 
+/*  ... calculate averages for 'numBuckets' consecutive windows of
+	... 'bucketSeconds' each starting at 'startTime' with a single query;
+	... 'stores' must hold 'numBuckets' entries, each filled as
+	... dbsqliteArchiveGetAverages would fill it (windDir is the consensus
+	... direction for the bucket);
+	... returns the number of buckets with data or ERROR
+*/
+extern int dbsqliteArchiveGetAveragesRange
+(
+	int             isMetricUnits,
+	HISTORY_DATA*   stores,
+	time_t          startTime,
+	int             bucketSeconds,
+	int             numBuckets
+);
+
+// ----------------------- Average Tiers --------------------------
+// The archive writer keeps per-day sums, sample counts and wind direction
+// bins (table archive_day, US units) up to date in the same transaction as
+// each archive insert; a day row covers the records stamped in
+// (00:00, 24:00] local time, the same window the day history averages.
+// Records already in the archive when the tier is created are folded in
+// afterwards by dbsqliteArchiveTierRebuildStep.
+typedef enum
+{
+	DBSQLITE_TIER_DAY = 0,
+	DBSQLITE_TIER_MAX
+} DBSQLITE_TIER;
+
+/*  ... roll every tier row in [startTime, stopTime) into one 'store';
+	... returns number of minutes found or ERROR (also while the rebuild
+	... has not reached the range yet - fall back to the archive then)
+*/
+extern int dbsqliteArchiveGetTierAverages
+(
+	int             isMetricUnits,
+	DBSQLITE_TIER   tier,
+	time_t          startTime,
+	time_t          stopTime,
+	HISTORY_DATA*   store
+);
+
+/*  ... fold the next 'maxRecords' existing archive records into the tiers;
+	... wviewd calls this from a timer until it returns FALSE (done);
+	... returns TRUE while records remain, FALSE or ERROR
+*/
+extern int dbsqliteArchiveTierRebuildStep(int maxRecords);
+
 // --------------------- ARCHIVE Day History ----------------------
 
 extern int dbsqliteWriteDailyArchiveReport
@@ -118,6 +223,10 @@ extern char* dbsqliteArchiveGetPath(void);
 //  ... returns OK or ERROR
 extern int dbsqliteArchiveStoreRecord(ARCHIVE_PKT* record);
 
+//  ... append 'count' archive records with one cached prepared INSERT and a
+//  ... single transaction; returns the number stored or ERROR
+extern int dbsqliteArchiveStoreRecords(ARCHIVE_PKT* records, int count);
+
 //  ... search the archive database for the most recent archive record date;
 //  ... returns time or ERROR if no archives found
 extern time_t dbsqliteArchiveGetNewestTime(ARCHIVE_PKT* newestRecord);
@@ -192,6 +301,22 @@ extern int dbsqliteHiLowGetDay
 	SENSOR_TIMEFRAMES       timeFrame
 );
 
+//  ... Summarize each local day in [first, last) into 'timeFrame' of
+//  ... 'sensors' and call 'dayDone' for it; days without data are skipped.
+//  ... Reads each HILOW table once per block of days instead of once per day.
+//  ... Returns number of records processed or ERROR
+typedef void (*HILOW_DAY_FUNC)(time_t day, int numRecs, void* data);
+
+extern int dbsqliteHiLowGetDays
+(
+	time_t                  first,
+	time_t                  last,
+	SENSOR_STORE*           sensors,
+	SENSOR_TIMEFRAMES       timeFrame,
+	HILOW_DAY_FUNC          dayDone,
+	void*                   data
+);
+
 //  ... Update sensors for the given month and time frame:
 //  ... Returns number of records processed or ERROR
 extern int dbsqliteHiLowGetMonth
@@ -231,9 +356,12 @@ extern time_t dbsqliteHiLowGetLastUpdate(void);
 #ifdef BUILD_HTMLGEND
 // ----------------------- History Database -----------------------
 
-// Initialize the day history table:
+// Open the history database and create the day history table if needed:
 extern void dbsqliteHistoryInit(void);
 
+// Close the history database:
+extern void dbsqliteHistoryExit(void);
+
 extern int dbsqliteHistoryPragmaSet(char* pragma, char* setting);
 
 // Insert a day record in the history table:
@@ -11,7 +11,12 @@
 //        08/31/2008      M.S. Teel       0               Original
 //
 //  NOTES:
-//
+//        One row per local hour in WVIEW_HILOW_HOUR_TABLE holds every
+//        sensor's low/high/times/cumulative/samples plus the wind bins
+//        packed into a BLOB. A sensor with no samples in the hour has NULL
+//        columns; an hour without wind samples has a NULL windBins.
+//        Databases with the older table-per-sensor layout are folded into
+//        it by dbsqliteHiLowInit(TRUE).
 //
 //  LICENSE:
 //        Copyright (c) 2008, Mark S. Teel (mark@teel.ws)
@@ -36,16 +41,22 @@
 #include <errno.h>
 
 //  ... Library include files
+#include <sqlite3.h>
 #include <radmsgLog.h>
 
 //  ... Local include files
 #include <dbsqlite.h>
+#include <sensor.h>
+#include <metrics.h>
+#include <latency.h>
 
 //  ... local memory:
 
 #define HILOWDIR "/tmp"
 static SQLITE_DATABASE_ID hilowDB = NULL;
+static int hilowUpdateMode = FALSE;
 
+// legacy table names, and the column prefix of each sensor in the hour table:
 static char *sensorTables[SENSOR_MAX] =
 	{
 		"inTemp",
@@ -72,6 +83,57 @@ static char *sensorTables[SENSOR_MAX] =
 		"soilMoist1",
 		"leafWet1"};
 
+// The hour table is reached through a second connection holding prepared
+// statements for the life of the process (radlib cannot bind a BLOB).
+// Columns: dateTime, updated, windBins, then HILOW_SENSOR_FIELDS per sensor
+// in SENSOR_TYPES order, named <sensorTables[type]>_<hilowFieldNames[i]>
+#define HILOW_QUERY_LENGTH_MAX      16384
+#define HILOW_COL_DATETIME          0
+#define HILOW_COL_UPDATED           1
+#define HILOW_COL_WINDBINS          2
+#define HILOW_COL_SENSORS           3
+#define HILOW_SENSOR_FIELDS         7
+#define HILOW_COLUMNS               (HILOW_COL_SENSORS + (SENSOR_MAX * HILOW_SENSOR_FIELDS))
+#define HILOW_BIN_BYTES             4
+
+static const char *hilowFieldNames[HILOW_SENSOR_FIELDS] =
+	{
+		"low",
+		"timeLow",
+		"high",
+		"timeHigh",
+		"whenHigh",
+		"cumulative",
+		"samples"};
+static const char *hilowFieldTypes[HILOW_SENSOR_FIELDS] =
+	{
+		"REAL",
+		"INTEGER",
+		"REAL",
+		"INTEGER",
+		"REAL",
+		"REAL",
+		"INTEGER"};
+
+static sqlite3 *hourDB = NULL;
+static sqlite3_stmt *hourWriteStmt = NULL;
+static sqlite3_stmt *hourReadStmt = NULL;
+static sqlite3_stmt *hourRangeStmt = NULL;
+
+typedef struct
+{
+	time_t dateTime;
+	time_t updated;
+	int windBins[WAVG_NUM_BINS];
+	WV_SENSOR sensor[SENSOR_MAX];           // samples == 0: none this hour
+} HILOW_HOUR;
+
+// LOOP samples and archive records accumulate into the current hour here
+// and the row is written once per store call:
+static HILOW_HOUR hourRow;
+static int hourValid = FALSE, hourDirty = FALSE;
+static time_t hilowLastUpdate = 0;
+
 //  ... ----- static (local) methods -----
 
 static const char *hilowGetDBFilename(void)
@@ -90,460 +152,439 @@ static const char *hilowGetDBFilename(void)
 	return dbHiLowFileName;
 }
 
-static int hilowExtractValues(SQLITE_DIRECT_ROW row, WV_SENSOR *newRec)
+static int hourExec(const char *sql)
 {
-	SQLITE_FIELD_ID field;
+	char *errMsg = NULL;
 
-	field = radsqlitedirectFieldGet(row, "low");
-	if (field == NULL)
+	if (sqlite3_exec(hourDB, sql, NULL, NULL, &errMsg) != SQLITE_OK)
 	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLow: %s failed: %s", sql, ((errMsg) ? errMsg : "unknown"));
+		sqlite3_free(errMsg);
 		return ERROR;
 	}
-	else
+
+	return OK;
+}
+
+static void hilowHourClear(HILOW_HOUR *hour, time_t dateTime)
+{
+	memset(hour, 0, sizeof(*hour));
+	hour->dateTime = dateTime;
+}
+
+static int hilowHourHasWind(HILOW_HOUR *hour)
+{
+	int i;
+
+	for (i = 0; i < WAVG_NUM_BINS; i++)
 	{
-		newRec->low = (float)radsqliteFieldGetDoubleValue(field);
+		if (hour->windBins[i] > 0)
+		{
+			return TRUE;
+		}
 	}
 
-	field = radsqlitedirectFieldGet(row, "timeLow");
-	if (field == NULL)
+	return FALSE;
+}
+
+// bins are packed as little-endian 32-bit counts:
+static void hilowPackBins(int *bins, unsigned char *blob)
+{
+	int i, j;
+
+	for (i = 0; i < WAVG_NUM_BINS; i++)
 	{
-		return ERROR;
+		for (j = 0; j < HILOW_BIN_BYTES; j++)
+		{
+			blob[(i * HILOW_BIN_BYTES) + j] = (unsigned char)(((uint32_t)bins[i] >> (8 * j)) & 0xFF);
+		}
 	}
-	else
+}
+
+static void hilowUnpackBins(const unsigned char *blob, int length, int *bins)
+{
+	int i, j;
+	uint32_t value;
+
+	for (i = 0; i < WAVG_NUM_BINS; i++)
 	{
-		newRec->time_low = (time_t)radsqliteFieldGetBigIntValue(field);
+		value = 0;
+		if (length >= (i + 1) * HILOW_BIN_BYTES)
+		{
+			for (j = 0; j < HILOW_BIN_BYTES; j++)
+			{
+				value |= (uint32_t)blob[(i * HILOW_BIN_BYTES) + j] << (8 * j);
+			}
+		}
+		bins[i] = (int)value;
 	}
+}
 
-	field = radsqlitedirectFieldGet(row, "high");
-	if (field == NULL)
+// copy the current row of 'stmt' (a SELECT * on the hour table) to 'hour':
+static void hilowHourFromStmt(sqlite3_stmt *stmt, HILOW_HOUR *hour)
+{
+	SENSOR_TYPES type;
+	WV_SENSOR *sensor;
+	int column;
+
+	hilowHourClear(hour, (time_t)sqlite3_column_int64(stmt, HILOW_COL_DATETIME));
+	hour->updated = (time_t)sqlite3_column_int64(stmt, HILOW_COL_UPDATED);
+	if (sqlite3_column_type(stmt, HILOW_COL_WINDBINS) != SQLITE_NULL)
 	{
-		return ERROR;
+		hilowUnpackBins((const unsigned char *)sqlite3_column_blob(stmt, HILOW_COL_WINDBINS),
+						sqlite3_column_bytes(stmt, HILOW_COL_WINDBINS),
+						hour->windBins);
 	}
-	else
+
+	for (type = SENSOR_INTEMP; type < SENSOR_MAX; type++)
 	{
-		newRec->high = (float)radsqliteFieldGetDoubleValue(field);
+		column = HILOW_COL_SENSORS + (type * HILOW_SENSOR_FIELDS);
+		if (sqlite3_column_type(stmt, column + 6) == SQLITE_NULL)
+		{
+			continue;
+		}
+
+		sensor = &hour->sensor[type];
+		sensor->low = (float)sqlite3_column_double(stmt, column);
+		sensor->time_low = (time_t)sqlite3_column_int64(stmt, column + 1);
+		sensor->high = (float)sqlite3_column_double(stmt, column + 2);
+		sensor->time_high = (time_t)sqlite3_column_int64(stmt, column + 3);
+		sensor->when_high = (float)sqlite3_column_double(stmt, column + 4);
+		sensor->cumulative = (float)sqlite3_column_double(stmt, column + 5);
+		sensor->samples = sqlite3_column_int(stmt, column + 6);
 	}
+}
 
-	field = radsqlitedirectFieldGet(row, "timeHigh");
-	if (field == NULL)
+static void hilowHourClose(void)
+{
+	if (hourWriteStmt != NULL)
 	{
-		return ERROR;
+		sqlite3_finalize(hourWriteStmt);
+		hourWriteStmt = NULL;
 	}
-	else
+	if (hourReadStmt != NULL)
+	{
+		sqlite3_finalize(hourReadStmt);
+		hourReadStmt = NULL;
+	}
+	if (hourRangeStmt != NULL)
+	{
+		sqlite3_finalize(hourRangeStmt);
+		hourRangeStmt = NULL;
+	}
+	if (hourDB != NULL)
 	{
-		newRec->time_high = (time_t)radsqliteFieldGetBigIntValue(field);
+		sqlite3_close(hourDB);
+		hourDB = NULL;
 	}
+	hourValid = FALSE;
+	hourDirty = FALSE;
+}
 
-	field = radsqlitedirectFieldGet(row, "whenHigh");
-	if (field == NULL)
+// open the hour connection (creating the table if 'create'); readers call
+// this on every scan so htmlgend picks the table up once wviewd made it
+static int hilowHourOpen(int create)
+{
+	char query[HILOW_QUERY_LENGTH_MAX];
+	SENSOR_TYPES type;
+	int i, len;
+
+	if (hourRangeStmt != NULL)
 	{
+		return OK;
+	}
+
+	if (sqlite3_open_v2(hilowGetDBFilename(), &hourDB,
+						SQLITE_OPEN_READWRITE | ((create) ? SQLITE_OPEN_CREATE : 0),
+						NULL) != SQLITE_OK)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLow: failed to open %s: %s",
+			   hilowGetDBFilename(), sqlite3_errmsg(hourDB));
+		sqlite3_close(hourDB);
+		hourDB = NULL;
 		return ERROR;
 	}
-	else
+
+	// the other daemon holds the file briefly:
+	sqlite3_busy_timeout(hourDB, 5000);
+
+	// synchronous is per connection - match the DERIVED profile:
+	hourExec("PRAGMA synchronous = NORMAL");
+
+	if (create)
 	{
-		newRec->when_high = (float)radsqliteFieldGetDoubleValue(field);
+		len = sprintf(query, "CREATE TABLE IF NOT EXISTS %s (dateTime INTEGER PRIMARY KEY, "
+							 "updated INTEGER NOT NULL DEFAULT 0, windBins BLOB",
+					  WVIEW_HILOW_HOUR_TABLE);
+		for (type = SENSOR_INTEMP; type < SENSOR_MAX; type++)
+		{
+			for (i = 0; i < HILOW_SENSOR_FIELDS; i++)
+			{
+				len += sprintf(&query[len], ", %s_%s %s",
+							   sensorTables[type], hilowFieldNames[i], hilowFieldTypes[i]);
+			}
+		}
+		sprintf(&query[len], ")");
+
+		if (hourExec(query) == ERROR)
+		{
+			hilowHourClose();
+			return ERROR;
+		}
 	}
 
-	field = radsqlitedirectFieldGet(row, "cumulative");
-	if (field == NULL)
+	len = sprintf(query, "INSERT OR REPLACE INTO %s VALUES (?", WVIEW_HILOW_HOUR_TABLE);
+	for (i = 1; i < HILOW_COLUMNS; i++)
 	{
-		return ERROR;
+		len += sprintf(&query[len], ",?");
 	}
-	else
+	sprintf(&query[len], ")");
+	if (sqlite3_prepare_v2(hourDB, query, -1, &hourWriteStmt, NULL) != SQLITE_OK)
 	{
-		newRec->cumulative = (float)radsqliteFieldGetDoubleValue(field);
+		MsgLog(PRI_MEDIUM, "dbsqliteHiLow: prepare %s write failed: %s",
+			   WVIEW_HILOW_HOUR_TABLE, sqlite3_errmsg(hourDB));
+		hilowHourClose();
+		return ERROR;
 	}
 
-	field = radsqlitedirectFieldGet(row, "samples");
-	if (field == NULL)
+	sprintf(query, "SELECT * FROM %s WHERE dateTime = ?", WVIEW_HILOW_HOUR_TABLE);
+	if (sqlite3_prepare_v2(hourDB, query, -1, &hourReadStmt, NULL) != SQLITE_OK)
 	{
+		MsgLog(PRI_MEDIUM, "dbsqliteHiLow: prepare %s read failed: %s",
+			   WVIEW_HILOW_HOUR_TABLE, sqlite3_errmsg(hourDB));
+		hilowHourClose();
 		return ERROR;
 	}
-	else
+
+	sprintf(query, "SELECT * FROM %s WHERE dateTime >= ? AND dateTime < ? ORDER BY dateTime ASC",
+			WVIEW_HILOW_HOUR_TABLE);
+	if (sqlite3_prepare_v2(hourDB, query, -1, &hourRangeStmt, NULL) != SQLITE_OK)
 	{
-		newRec->samples = (int)radsqliteFieldGetBigIntValue(field);
+		MsgLog(PRI_MEDIUM, "dbsqliteHiLow: prepare %s range failed: %s",
+			   WVIEW_HILOW_HOUR_TABLE, sqlite3_errmsg(hourDB));
+		hilowHourClose();
+		return ERROR;
 	}
 
 	return OK;
 }
 
-static int hilowGetRecord(time_t dateTime, SENSOR_TYPES type, WV_SENSOR *newRec)
+// write 'hour' as one row (replacing any stored copy):
+static int hilowHourWrite(HILOW_HOUR *hour)
 {
-	char query[DB_SQLITE_QUERY_LENGTH_MAX];
-	SQLITE_DIRECT_ROW row;
+	unsigned char blob[WAVG_NUM_BINS * HILOW_BIN_BYTES];
+	SENSOR_TYPES type;
+	WV_SENSOR *sensor;
+	int i, column, retVal;
+	uint64_t startTime;
 
-	if (hilowDB == NULL)
+	sqlite3_reset(hourWriteStmt);
+	sqlite3_bind_int64(hourWriteStmt, HILOW_COL_DATETIME + 1, (sqlite3_int64)hour->dateTime);
+	sqlite3_bind_int64(hourWriteStmt, HILOW_COL_UPDATED + 1, (sqlite3_int64)hour->updated);
+	if (hilowHourHasWind(hour))
 	{
-		MsgLog(PRI_HIGH, "hilowGetRecord: failed to open %s!", hilowGetDBFilename());
-		return ERROR;
+		hilowPackBins(hour->windBins, blob);
+		sqlite3_bind_blob(hourWriteStmt, HILOW_COL_WINDBINS + 1, blob, sizeof(blob), SQLITE_TRANSIENT);
+	}
+	else
+	{
+		sqlite3_bind_null(hourWriteStmt, HILOW_COL_WINDBINS + 1);
 	}
 
-	// grab the entire row:
-	sprintf(query, "SELECT * FROM %s WHERE dateTime = '%d'",
-			sensorTables[type], (int)dateTime);
-
-	// Execute the query:
-	if (radsqlitedirectQuery(hilowDB, query, TRUE) == ERROR)
+	for (type = SENSOR_INTEMP; type < SENSOR_MAX; type++)
 	{
-		return ERROR;
+		column = HILOW_COL_SENSORS + (type * HILOW_SENSOR_FIELDS) + 1;
+		sensor = &hour->sensor[type];
+		if (sensor->samples <= 0)
+		{
+			for (i = 0; i < HILOW_SENSOR_FIELDS; i++)
+			{
+				sqlite3_bind_null(hourWriteStmt, column + i);
+			}
+			continue;
+		}
+
+		sqlite3_bind_double(hourWriteStmt, column, (double)sensor->low);
+		sqlite3_bind_int64(hourWriteStmt, column + 1, (sqlite3_int64)sensor->time_low);
+		sqlite3_bind_double(hourWriteStmt, column + 2, (double)sensor->high);
+		sqlite3_bind_int64(hourWriteStmt, column + 3, (sqlite3_int64)sensor->time_high);
+		sqlite3_bind_double(hourWriteStmt, column + 4, (double)sensor->when_high);
+		sqlite3_bind_double(hourWriteStmt, column + 5, (double)sensor->cumulative);
+		sqlite3_bind_int(hourWriteStmt, column + 6, sensor->samples);
 	}
 
-	row = radsqlitedirectGetRow(hilowDB);
-	if (row == NULL)
+	startTime = latencyStart();
+	retVal = sqlite3_step(hourWriteStmt);
+	metricsAdd(METRIC_SQL_STATEMENTS, 1);
+	if (startTime != 0)
 	{
-		radsqlitedirectReleaseResults(hilowDB);
-		return ERROR;
+		metricsAdd(METRIC_SQL_SECONDS, (double)(latencyStart() - startTime) / 1000000000.0);
 	}
+	sqlite3_reset(hourWriteStmt);
 
-	// copy it to the internal sensor:
-	if (hilowExtractValues(row, newRec) == ERROR)
+	if (retVal != SQLITE_DONE)
 	{
-		radsqlitedirectReleaseResults(hilowDB);
-		MsgLog(PRI_MEDIUM, "hilowGetRecord: radsqlitedirectFieldGet failed!");
+		MsgLog(PRI_HIGH, "dbsqliteHiLow: hour write failed for %d: %s",
+			   (int)hour->dateTime, sqlite3_errmsg(hourDB));
 		return ERROR;
 	}
 
-	radsqlitedirectReleaseResults(hilowDB);
 	return OK;
 }
 
-static int hilowGetWindRecord(time_t dateTime, int binIndex)
+// read the stored row for 'dateTime'; returns TRUE, FALSE (no row) or ERROR
+static int hilowHourRead(time_t dateTime, HILOW_HOUR *hour)
 {
-	char query[DB_SQLITE_QUERY_LENGTH_MAX];
-	SQLITE_DIRECT_ROW row;
-	SQLITE_FIELD_ID field;
-	char binName[16];
 	int retVal;
 
-	if (hilowDB == NULL)
+	sqlite3_reset(hourReadStmt);
+	sqlite3_bind_int64(hourReadStmt, 1, (sqlite3_int64)dateTime);
+
+	retVal = sqlite3_step(hourReadStmt);
+	metricsAdd(METRIC_SQL_STATEMENTS, 1);
+	if (retVal == SQLITE_ROW)
 	{
-		MsgLog(PRI_HIGH, "hilowGetWindRecord: failed to open %s!", hilowGetDBFilename());
-		return ERROR;
+		hilowHourFromStmt(hourReadStmt, hour);
+		retVal = TRUE;
+	}
+	else if (retVal == SQLITE_DONE)
+	{
+		retVal = FALSE;
+	}
+	else
+	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLow: hour read failed for %d: %s",
+			   (int)dateTime, sqlite3_errmsg(hourDB));
+		retVal = ERROR;
 	}
 
-	// grab the entire row:
-	sprintf(query, "SELECT * FROM %s WHERE dateTime = '%d'",
-			WVIEW_HILOW_WINDDIR_TABLE, (int)dateTime);
+	sqlite3_reset(hourReadStmt);
+	return retVal;
+}
 
-	// Execute the query:
-	if (radsqlitedirectQuery(hilowDB, query, TRUE) == ERROR)
+static int hilowHourFlush(void)
+{
+	if (!hourDirty)
+	{
+		return OK;
+	}
+
+	hourRow.updated = hilowLastUpdate;
+	if (hilowHourWrite(&hourRow) == ERROR)
 	{
 		return ERROR;
 	}
 
-	row = radsqlitedirectGetRow(hilowDB);
-	if (row == NULL)
+	hourDirty = FALSE;
+	return OK;
+}
+
+// make hourRow the hour starting at 'hilowTime', writing out the previous one:
+static int hilowHourSelect(time_t hilowTime)
+{
+	int retVal;
+
+	if (hourValid && hourRow.dateTime == hilowTime)
 	{
-		radsqlitedirectReleaseResults(hilowDB);
+		return OK;
+	}
+
+	if (hourDB == NULL)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLow: %s is not open!", hilowGetDBFilename());
 		return ERROR;
 	}
 
-	sprintf(binName, "bin%d", binIndex);
+	if (hilowHourFlush() == ERROR)
+	{
+		return ERROR;
+	}
 
-	// retrieve current value:
-	field = radsqlitedirectFieldGet(row, binName);
-	if (field == NULL)
+	hourValid = FALSE;
+	retVal = hilowHourRead(hilowTime, &hourRow);
+	if (retVal == ERROR)
 	{
-		MsgLog(PRI_MEDIUM, "hilowGetWindRecord: radsqliteFieldGet failed!");
-		radsqlitedirectReleaseResults(hilowDB);
 		return ERROR;
 	}
-	else
+	else if (retVal == FALSE)
 	{
-		retVal = radsqliteFieldGetBigIntValue(field);
+		hilowHourClear(&hourRow, hilowTime);
 	}
 
-	radsqlitedirectReleaseResults(hilowDB);
-	return retVal;
+	hourValid = TRUE;
+	return OK;
 }
 
 static int hilowInsertData(time_t timestamp, SENSOR_TYPES type, float value, float whenHigh)
 {
-	SQLITE_ROW_ID row;
-	SQLITE_FIELD_ID field;
-	time_t hilowTime;
-	struct tm bknTime;
-	WV_SENSOR store;
-	char query[DB_SQLITE_QUERY_LENGTH_MAX];
+	WV_SENSOR *store;
 
 	if (value <= ARCHIVE_VALUE_NULL)
 	{
 		return ERROR;
 	}
 
-	hilowTime = timestamp;
-	localtime_r(&hilowTime, &bknTime);
-	bknTime.tm_min = 0;
-	bknTime.tm_sec = 0;
-	bknTime.tm_isdst = -1;
-	hilowTime = mktime(&bknTime);
+	if (hilowHourSelect(wvutilsHourStart(timestamp)) == ERROR)
+	{
+		return ERROR;
+	}
 
-	// First see if the record exists:
-	if (hilowGetRecord(hilowTime, type, &store) == OK)
+	store = &hourRow.sensor[type];
+	if (store->samples > 0)
 	{
 		// Found the guy, just update him:
-		store.samples++;
-		store.cumulative += value;
-		if (store.low > value)
+		store->samples++;
+		store->cumulative += value;
+		if (store->low > value)
 		{
 			// New low:
-			store.low = value;
-			store.time_low = timestamp;
+			store->low = value;
+			store->time_low = timestamp;
 		}
-		if (store.high < value)
+		if (store->high < value)
 		{
 			// New high:
-			store.high = value;
-			store.time_high = timestamp;
-			store.when_high = whenHigh;
-		}
-
-		// Update the database:
-		sprintf(query,
-				"UPDATE %s SET low = '%.3f', timeLow = '%d', "
-				"high = '%.3f', timeHigh = '%d', whenHigh = '%.3f', "
-				"cumulative = '%.6f', samples = '%d' "
-				"WHERE dateTime = '%d'",
-				sensorTables[type],
-				store.low, (int)store.time_low,
-				store.high, (int)store.time_high, store.when_high,
-				store.cumulative, store.samples,
-				(int)hilowTime);
-
-		// Execute the query:
-		if (radsqliteQuery(hilowDB, query, FALSE) == ERROR)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: query failed");
-			return ERROR;
+			store->high = value;
+			store->time_high = timestamp;
+			store->when_high = whenHigh;
 		}
 	}
 	else
 	{
-		// Must create a new record:
-		row = radsqliteTableDescriptionGet(hilowDB, sensorTables[type]);
-		if (row == NULL)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: databaseTableDescriptionGet failed!");
-			return ERROR;
-		}
-
-		field = radsqliteFieldGet(row, "dateTime");
-		if (field == NULL)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: radsqliteFieldGet failed!");
-			radsqliteRowDescriptionDelete(row);
-			return ERROR;
-		}
-		else
-		{
-			radsqliteFieldSetBigIntValue(field, (uint64_t)hilowTime);
-		}
-
-		field = radsqliteFieldGet(row, "low");
-		if (field == NULL)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: radsqliteFieldGet failed!");
-			radsqliteRowDescriptionDelete(row);
-			return ERROR;
-		}
-		else
-		{
-			radsqliteFieldSetDoubleValue(field, (double)value);
-		}
-
-		field = radsqliteFieldGet(row, "timeLow");
-		if (field == NULL)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: radsqliteFieldGet failed!");
-			radsqliteRowDescriptionDelete(row);
-			return ERROR;
-		}
-		else
-		{
-			radsqliteFieldSetBigIntValue(field, (uint64_t)timestamp);
-		}
-
-		field = radsqliteFieldGet(row, "high");
-		if (field == NULL)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: radsqliteFieldGet failed!");
-			radsqliteRowDescriptionDelete(row);
-			return ERROR;
-		}
-		else
-		{
-			radsqliteFieldSetDoubleValue(field, (double)value);
-		}
-
-		field = radsqliteFieldGet(row, "timeHigh");
-		if (field == NULL)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: radsqliteFieldGet failed!");
-			radsqliteRowDescriptionDelete(row);
-			return ERROR;
-		}
-		else
-		{
-			radsqliteFieldSetBigIntValue(field, (uint64_t)timestamp);
-		}
-
-		field = radsqliteFieldGet(row, "whenHigh");
-		if (field == NULL)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: radsqliteFieldGet failed!");
-			radsqliteRowDescriptionDelete(row);
-			return ERROR;
-		}
-		else
-		{
-			radsqliteFieldSetDoubleValue(field, (double)whenHigh);
-		}
-
-		field = radsqliteFieldGet(row, "cumulative");
-		if (field == NULL)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: radsqliteFieldGet failed!");
-			radsqliteRowDescriptionDelete(row);
-			return ERROR;
-		}
-		else
-		{
-			radsqliteFieldSetDoubleValue(field, (double)value);
-		}
-
-		field = radsqliteFieldGet(row, "samples");
-		if (field == NULL)
-		{
-			MsgLog(PRI_HIGH, "dbsqliteHiLow: radsqliteFieldGet failed!");
-			radsqliteRowDescriptionDelete(row);
-			return ERROR;
-		}
-		else
-		{
-			radsqliteFieldSetBigIntValue(field, (uint64_t)1);
-		}
-
-		// insert the row:
-		if (radsqliteTableInsertRow(hilowDB, sensorTables[type], row) == ERROR)
-		{
-			MsgLog(PRI_HIGH, "dbsqlite: radsqliteTableInsertRow (hilow) failed!");
-			radsqliteRowDescriptionDelete(row);
-			return ERROR;
-		}
-
-		radsqliteRowDescriptionDelete(row);
+		// First sample this hour:
+		store->low = value;
+		store->time_low = timestamp;
+		store->high = value;
+		store->time_high = timestamp;
+		store->when_high = whenHigh;
+		store->cumulative = value;
+		store->samples = 1;
 	}
 
+	hourDirty = TRUE;
 	return OK;
 }
 
 static int hilowInsertWindDir(time_t timestamp, int value)
 {
-	SQLITE_ROW_ID row, newrow;
-	SQLITE_RESULT_SET_ID results;
-	SQLITE_FIELD_ID field;
-	time_t hilowTime;
-	struct tm bknTime;
-	char query[DB_SQLITE_QUERY_LENGTH_MAX];
-	int i, binIndex, binValue;
-	char binName[16];
+	int binIndex;
 
-	if (hilowDB == NULL)
+	if (hilowHourSelect(wvutilsHourStart(timestamp)) == ERROR)
 	{
-		MsgLog(PRI_HIGH, "hilowInsertWindDir: failed to open %s!", hilowGetDBFilename());
 		return ERROR;
 	}
 
-	hilowTime = timestamp;
-	localtime_r(&hilowTime, &bknTime);
-	bknTime.tm_min = 0;
-	bknTime.tm_sec = 0;
-	bknTime.tm_isdst = -1;
-	hilowTime = mktime(&bknTime);
-
 	if (value < 0)
 		binIndex = 0;
 	else
 		binIndex = value;
 
 	binIndex += (WAVG_BIN_SIZE / 2);
-	binIndex /= WAVG_BIN_SIZE;
-	binIndex %= WAVG_NUM_BINS;
-
-	// First see if the record exists:
-	binValue = hilowGetWindRecord(hilowTime, binIndex);
-	if (binValue == ERROR)
-	{
-		// Create the row:
-		newrow = radsqliteTableDescriptionGet(hilowDB, WVIEW_HILOW_WINDDIR_TABLE);
-		if (newrow == NULL)
-		{
-			printf("hilowInsertWindDir: databaseTableDescriptionGet failed!");
-			return ERROR;
-		}
-
-		field = radsqliteFieldGet(newrow, "dateTime");
-		if (field == NULL)
-		{
-			MsgLog(PRI_MEDIUM, "hilowInsertWindDir: radsqliteFieldGet failed!");
-			radsqliteRowDescriptionDelete(newrow);
-			return ERROR;
-		}
-		else
-		{
-			radsqliteFieldSetBigIntValue(field, (uint64_t)hilowTime);
-		}
-
-		for (i = 0; i < WAVG_NUM_BINS; i++)
-		{
-			sprintf(binName, "bin%d", i);
-			field = radsqliteFieldGet(newrow, binName);
-			if (field == NULL)
-			{
-				MsgLog(PRI_MEDIUM, "hilowInsertWindDir: radsqliteFieldGet failed!");
-				radsqliteRowDescriptionDelete(newrow);
-				return ERROR;
-			}
-			else
-			{
-				if (i == binIndex)
-				{
-					// This is our guy:
-					radsqliteFieldSetBigIntValue(field, (uint64_t)1);
-				}
-				else
-				{
-					radsqliteFieldSetBigIntValue(field, (uint64_t)0);
-				}
-			}
-		}
-
-		// insert the row:
-		if (radsqliteTableInsertRow(hilowDB, WVIEW_HILOW_WINDDIR_TABLE, newrow) == ERROR)
-		{
-			MsgLog(PRI_HIGH, "hilowInsertWindDir: radsqliteTableInsertRow (hilow) failed!");
-			radsqliteRowDescriptionDelete(newrow);
-			return ERROR;
-		}
-
-		radsqliteRowDescriptionDelete(newrow);
-	}
-	else
-	{
-		sprintf(binName, "bin%d", binIndex);
-		binValue++;
-
-		sprintf(query, "UPDATE %s SET %s = '%d' WHERE dateTime = '%d'",
-				WVIEW_HILOW_WINDDIR_TABLE,
-				binName, binValue, (int)hilowTime);
-
-		// Execute the query:
-		if (radsqliteQuery(hilowDB, query, FALSE) == ERROR)
-		{
-			return ERROR;
-		}
-	}
+	binIndex /= WAVG_BIN_SIZE;
+	binIndex %= WAVG_NUM_BINS;
 
+	hourRow.windBins[binIndex]++;
+	hourDirty = TRUE;
 	return OK;
 }
 
@@ -735,113 +776,175 @@ static int hilowUpdateTableWithSample(SENSOR_TYPES type, time_t timestamp, LOOP_
 	return OK;
 }
 
+static void hilowAccumulate(WV_SENSOR *tempSensor, WV_SENSOR *store)
+{
+	tempSensor->cumulative += store->cumulative;
+	tempSensor->samples += store->samples;
+	if (tempSensor->low > store->low)
+	{
+		tempSensor->low = store->low;
+		tempSensor->time_low = store->time_low;
+	}
+	if (tempSensor->high < store->high)
+	{
+		tempSensor->high = store->high;
+		tempSensor->time_high = store->time_high;
+		tempSensor->when_high = store->when_high;
+	}
+}
+
+// fold one hour into 'set' and 'wind'; returns TRUE if the hour has wind
+// samples (the record count callers see is the number of wind hours)
+static int hilowAddHour(HILOW_HOUR *hour, WV_SENSOR *set, WAVG *wind)
+{
+	SENSOR_TYPES index;
+
+	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
+	{
+		if (hour->sensor[index].samples > 0)
+		{
+			hilowAccumulate(&set[index], &hour->sensor[index]);
+		}
+	}
+
+	if (!hilowHourHasWind(hour))
+	{
+		return FALSE;
+	}
+
+	windAverageAddBins(wind, hour->windBins);
+	return TRUE;
+}
+
+// one ordered range scan over the hour table:
+static int hilowHourScanBegin(time_t first, time_t last)
+{
+	if (hilowHourOpen(FALSE) == ERROR)
+	{
+		return ERROR;
+	}
+
+	sqlite3_reset(hourRangeStmt);
+	sqlite3_bind_int64(hourRangeStmt, 1, (sqlite3_int64)first);
+	sqlite3_bind_int64(hourRangeStmt, 2, (sqlite3_int64)last);
+	metricsAdd(METRIC_SQL_STATEMENTS, 1);
+	return OK;
+}
+
+// returns TRUE with 'hour' filled, FALSE at the end or ERROR
+static int hilowHourScanNext(HILOW_HOUR *hour)
+{
+	int retVal = sqlite3_step(hourRangeStmt);
+
+	if (retVal == SQLITE_ROW)
+	{
+		hilowHourFromStmt(hourRangeStmt, hour);
+		return TRUE;
+	}
+	else if (retVal == SQLITE_DONE)
+	{
+		return FALSE;
+	}
+
+	MsgLog(PRI_HIGH, "dbsqliteHiLow: hour scan failed: %s", sqlite3_errmsg(hourDB));
+	return ERROR;
+}
+
+static void hilowHourScanEnd(void)
+{
+	sqlite3_reset(hourRangeStmt);
+}
+
 static int hilowGetDataTimeFrame(
 	int32_t first,
 	int32_t last,
 	SENSOR_STORE *sensors,
 	SENSOR_TIMEFRAMES timeFrame)
 {
-	SENSOR_TYPES index;
-	int retVal = 0;
-	char query[DB_SQLITE_QUERY_LENGTH_MAX];
-	SQLITE_DIRECT_ROW rowDescr;
-	SQLITE_FIELD_ID field;
-	WV_SENSOR *tempSensor;
-	WV_SENSOR store;
-	int i, bins[WAVG_NUM_BINS];
-	char binName[16];
+	HILOW_HOUR hour;
+	int status, retVal = 0;
 
-	if (hilowDB == NULL)
+	if (hilowHourScanBegin(first, last) == ERROR)
 	{
 		MsgLog(PRI_HIGH, "dbsqliteHiLowGet: failed to open %s!", hilowGetDBFilename());
 		return ERROR;
 	}
 
-	// Loop through the sensor types:
-	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
+	while ((status = hilowHourScanNext(&hour)) == TRUE)
 	{
-		// grab the rows:
-		sprintf(query, "SELECT * FROM %s WHERE dateTime >= '%d' AND dateTime < '%d' ORDER BY dateTime ASC",
-				sensorTables[index], first, last);
-
-		// Execute the query:
-		if (radsqlitedirectQuery(hilowDB, query, TRUE) == ERROR)
+		if (hilowAddHour(&hour, sensors->sensor[timeFrame], &sensors->wind[timeFrame]))
 		{
-			return ERROR;
+			retVal++;
 		}
+	}
 
-		for (rowDescr = radsqlitedirectGetRow(hilowDB);
-			 rowDescr != NULL;
-			 rowDescr = radsqlitedirectGetRow(hilowDB))
-		{
-			// copy it to the internal store:
-			tempSensor = &sensors->sensor[timeFrame][index];
-
-			if (hilowExtractValues(rowDescr, &store) == ERROR)
-			{
-				radsqlitedirectReleaseResults(hilowDB);
-				MsgLog(PRI_HIGH, "dbsqliteHiLowGetDay: failed to extract data");
-				return ERROR;
-			}
+	hilowHourScanEnd();
+	return ((status == ERROR) ? ERROR : retVal);
+}
 
-			tempSensor->cumulative += store.cumulative;
-			tempSensor->samples += store.samples;
-			if (tempSensor->low > store.low)
-			{
-				tempSensor->low = store.low;
-				tempSensor->time_low = store.time_low;
-			}
-			if (tempSensor->high < store.high)
-			{
-				tempSensor->high = store.high;
-				tempSensor->time_high = store.time_high;
-				tempSensor->when_high = store.when_high;
-			}
-		}
+// Day summaries for a range are built HILOW_DAYS_PER_PASS days at a time:
+// one ordered scan over the block, each hour dropped into the bucket of
+// its local day.
+#define HILOW_DAYS_PER_PASS         366
 
-		radsqlitedirectReleaseResults(hilowDB);
+typedef struct
+{
+	time_t          dayStart;
+	time_t          dayEnd;
+	int             records;
+	WV_SENSOR       sensor[SENSOR_MAX];
+	WAVG            wind;
+} HILOW_DAY_BUCKET;
+
+// rows arrive in dateTime order, so the bucket index only moves forward
+static int hilowDayBucket(HILOW_DAY_BUCKET *days, int numDays, int current, time_t dateTime)
+{
+	while (current < numDays && dateTime >= days[current].dayEnd)
+	{
+		current++;
 	}
 
-	// Do the wind dir here:
-	sprintf(query, "SELECT * FROM %s WHERE dateTime >= '%d' AND dateTime < '%d' ORDER BY dateTime ASC",
-			WVIEW_HILOW_WINDDIR_TABLE, (int)first, (int)last);
+	return current;
+}
 
-	// Execute the query:
-	if (radsqlitedirectQuery(hilowDB, query, TRUE) == ERROR)
+static int hilowGetDaysBlock(
+	HILOW_DAY_BUCKET *days,
+	int numDays,
+	time_t last)
+{
+	HILOW_HOUR hour;
+	int status, current = 0;
+
+	if (hilowHourScanBegin(days[0].dayStart, last) == ERROR)
 	{
 		return ERROR;
 	}
 
-	retVal = 0;
-	for (rowDescr = radsqlitedirectGetRow(hilowDB);
-		 rowDescr != NULL;
-		 rowDescr = radsqlitedirectGetRow(hilowDB))
+	while ((status = hilowHourScanNext(&hour)) == TRUE)
 	{
-		retVal++;
-		for (i = 0; i < WAVG_NUM_BINS; i++)
+		current = hilowDayBucket(days, numDays, current, hour.dateTime);
+		if (current >= numDays)
 		{
-			bins[i] = 0;
-			sprintf(binName, "bin%d", i);
-			field = radsqlitedirectFieldGet(rowDescr, binName);
-			if (field == NULL)
-			{
-				radsqlitedirectReleaseResults(hilowDB);
-				return ERROR;
-			}
-			else
-			{
-				bins[i] = (int)radsqliteFieldGetBigIntValue(field);
-			}
+			break;
+		}
+
+		if (hilowAddHour(&hour, days[current].sensor, &days[current].wind))
+		{
+			days[current].records++;
 		}
+	}
 
-		windAverageAddBins(&sensors->wind[timeFrame], bins);
+	hilowHourScanEnd();
+	if (status == ERROR)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLowGetDays: failed to extract data");
+		return ERROR;
 	}
 
-	radsqlitedirectReleaseResults(hilowDB);
-	return retVal;
+	return OK;
 }
 
-static time_t hilowGetLastUpdateTime(void)
+static time_t hilowGetMetaUpdateTime(void)
 {
 	char query[DB_SQLITE_QUERY_LENGTH_MAX];
 	SQLITE_DIRECT_ROW rowDescr;
@@ -860,7 +963,7 @@ static time_t hilowGetLastUpdateTime(void)
 			WVIEW_HILOW_META_TABLE);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(hilowDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(hilowDB, query, TRUE) == ERROR)
 	{
 		return (time_t)(-1);
 	}
@@ -872,46 +975,358 @@ static time_t hilowGetLastUpdateTime(void)
 		return (time_t)(-1);
 	}
 
-	field = radsqlitedirectFieldGet(rowDescr, "value");
-	if (field == NULL)
+	field = radsqlitedirectFieldGet(rowDescr, "value");
+	if (field == NULL)
+	{
+		radsqlitedirectReleaseResults(hilowDB);
+		return (time_t)(-1);
+	}
+
+	memset(tempstr, 0, sizeof(tempstr));
+	strncpy(tempstr, radsqliteFieldGetCharValue(field), radsqliteFieldGetCharLength(field));
+	retVal = (time_t)atoi(tempstr);
+	radsqlitedirectReleaseResults(hilowDB);
+	return retVal;
+}
+
+// the newest hour row carries the time of the last store; the meta row
+// is only written at startup and exit (and by older versions):
+static time_t hilowGetLastUpdateTime(void)
+{
+	char query[DB_SQLITE_QUERY_LENGTH_MAX];
+	sqlite3_stmt *stmt;
+	time_t retVal = hilowGetMetaUpdateTime();
+
+	if (hilowHourOpen(FALSE) == ERROR)
+	{
+		return retVal;
+	}
+
+	sprintf(query, "SELECT updated FROM %s ORDER BY dateTime DESC LIMIT 1",
+			WVIEW_HILOW_HOUR_TABLE);
+	if (sqlite3_prepare_v2(hourDB, query, -1, &stmt, NULL) != SQLITE_OK)
+	{
+		return retVal;
+	}
+
+	if (sqlite3_step(stmt) == SQLITE_ROW &&
+		(time_t)sqlite3_column_int64(stmt, 0) > retVal)
+	{
+		retVal = (time_t)sqlite3_column_int64(stmt, 0);
+	}
+
+	sqlite3_finalize(stmt);
+	return retVal;
+}
+
+static void hilowSetLastUpdateTime(time_t newtime)
+{
+	hilowLastUpdate = newtime;
+}
+
+static int hilowSaveLastUpdateTime(void)
+{
+	char query[DB_SQLITE_QUERY_LENGTH_MAX];
+
+	if (hilowDB == NULL)
+	{
+		MsgLog(PRI_HIGH, "hilowSetLastUpdateTime: failed to open %s!", hilowGetDBFilename());
+		return ERROR;
+	}
+
+	// update the row:
+	sprintf(query, "UPDATE %s SET value = '%d' WHERE name = 'lastUpdate'",
+			WVIEW_HILOW_META_TABLE, (int)hilowLastUpdate);
+
+	// Execute the query:
+	if (dbsqliteSessionQuery(hilowDB, query, FALSE) == ERROR)
+	{
+		return ERROR;
+	}
+
+	return OK;
+}
+
+// Databases written before the hour table kept one table per sensor plus
+// WVIEW_HILOW_WINDDIR_TABLE. They are copied into the hour table a week
+// at a time, each week in its own transaction so htmlgend is never held
+// off for long, and the old tables are dropped once every week is in.
+// Hour starts are whole quarter hours in every zone, so a slot per quarter
+// hour gives each stored hour its own slot.
+#define HILOW_MIGRATE_SPAN          WV_SECONDS_IN_WEEK
+#define HILOW_MIGRATE_SLOT          900
+#define HILOW_MIGRATE_SLOTS         (HILOW_MIGRATE_SPAN / HILOW_MIGRATE_SLOT)
+
+static int LegacyTableExists[SENSOR_MAX], LegacyWindExists;
+
+static int hilowLegacyTablesExist(void)
+{
+	SENSOR_TYPES index;
+	int retVal;
+
+	LegacyWindExists = (radsqliteTableIfExists(hilowDB, WVIEW_HILOW_WINDDIR_TABLE) ? TRUE : FALSE);
+	retVal = LegacyWindExists;
+
+	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
+	{
+		LegacyTableExists[index] = (radsqliteTableIfExists(hilowDB, sensorTables[index]) ? TRUE : FALSE);
+		if (LegacyTableExists[index])
+		{
+			retVal = TRUE;
+		}
+	}
+
+	return retVal;
+}
+
+// widen [*first, *last] to cover 'table'; returns OK or ERROR
+static int hilowLegacyRange(const char *table, time_t *first, time_t *last)
+{
+	char query[DB_SQLITE_QUERY_LENGTH_MAX];
+	sqlite3_stmt *stmt;
+
+	sprintf(query, "SELECT MIN(dateTime), MAX(dateTime) FROM %s", table);
+	if (sqlite3_prepare_v2(hourDB, query, -1, &stmt, NULL) != SQLITE_OK)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLow: %s failed: %s", query, sqlite3_errmsg(hourDB));
+		return ERROR;
+	}
+
+	if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+	{
+		if (*first == 0 || (time_t)sqlite3_column_int64(stmt, 0) < *first)
+		{
+			*first = (time_t)sqlite3_column_int64(stmt, 0);
+		}
+		if ((time_t)sqlite3_column_int64(stmt, 1) > *last)
+		{
+			*last = (time_t)sqlite3_column_int64(stmt, 1);
+		}
+	}
+
+	sqlite3_finalize(stmt);
+	return OK;
+}
+
+// copy one legacy table's rows in [start, start + HILOW_MIGRATE_SPAN) to
+// 'slots'; 'type' SENSOR_MAX is the wind direction table
+static int hilowMigrateTable(SENSOR_TYPES type, HILOW_HOUR *slots, time_t start)
+{
+	char query[DB_SQLITE_QUERY_LENGTH_MAX];
+	sqlite3_stmt *stmt;
+	HILOW_HOUR *slot;
+	WV_SENSOR *sensor;
+	time_t dateTime;
+	int i, len, retVal;
+
+	if (type == SENSOR_MAX)
+	{
+		len = sprintf(query, "SELECT dateTime");
+		for (i = 0; i < WAVG_NUM_BINS; i++)
+		{
+			len += sprintf(&query[len], ", bin%d", i);
+		}
+		sprintf(&query[len], " FROM %s WHERE dateTime >= %d AND dateTime < %d",
+				WVIEW_HILOW_WINDDIR_TABLE, (int)start, (int)(start + HILOW_MIGRATE_SPAN));
+	}
+	else
+	{
+		sprintf(query, "SELECT dateTime, low, timeLow, high, timeHigh, whenHigh, cumulative, samples "
+					   "FROM %s WHERE dateTime >= %d AND dateTime < %d",
+				sensorTables[type], (int)start, (int)(start + HILOW_MIGRATE_SPAN));
+	}
+
+	if (sqlite3_prepare_v2(hourDB, query, -1, &stmt, NULL) != SQLITE_OK)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLow: %s failed: %s", query, sqlite3_errmsg(hourDB));
+		return ERROR;
+	}
+
+	while ((retVal = sqlite3_step(stmt)) == SQLITE_ROW)
+	{
+		dateTime = (time_t)sqlite3_column_int64(stmt, 0);
+		slot = &slots[(dateTime - start) / HILOW_MIGRATE_SLOT];
+		if (slot->dateTime == 0)
+		{
+			hilowHourClear(slot, dateTime);
+		}
+		else if (slot->dateTime != dateTime)
+		{
+			MsgLog(PRI_MEDIUM, "HILOW: skipping misaligned %s row %d",
+				   ((type == SENSOR_MAX) ? WVIEW_HILOW_WINDDIR_TABLE : sensorTables[type]),
+				   (int)dateTime);
+			continue;
+		}
+
+		if (type == SENSOR_MAX)
+		{
+			for (i = 0; i < WAVG_NUM_BINS; i++)
+			{
+				slot->windBins[i] = sqlite3_column_int(stmt, i + 1);
+			}
+			continue;
+		}
+
+		sensor = &slot->sensor[type];
+		sensor->low = (float)sqlite3_column_double(stmt, 1);
+		sensor->time_low = (time_t)sqlite3_column_int64(stmt, 2);
+		sensor->high = (float)sqlite3_column_double(stmt, 3);
+		sensor->time_high = (time_t)sqlite3_column_int64(stmt, 4);
+		sensor->when_high = (float)sqlite3_column_double(stmt, 5);
+		sensor->cumulative = (float)sqlite3_column_double(stmt, 6);
+		sensor->samples = sqlite3_column_int(stmt, 7);
+	}
+
+	sqlite3_finalize(stmt);
+	if (retVal != SQLITE_DONE)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLow: reading %s failed: %s",
+			   ((type == SENSOR_MAX) ? WVIEW_HILOW_WINDDIR_TABLE : sensorTables[type]),
+			   sqlite3_errmsg(hourDB));
+		return ERROR;
+	}
+
+	return OK;
+}
+
+static int hilowMigrateSpan(HILOW_HOUR *slots, time_t start)
+{
+	SENSOR_TYPES index;
+	int i;
+
+	memset(slots, 0, HILOW_MIGRATE_SLOTS * sizeof(HILOW_HOUR));
+
+	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
+	{
+		if (LegacyTableExists[index] && hilowMigrateTable(index, slots, start) == ERROR)
+		{
+			return ERROR;
+		}
+	}
+	if (LegacyWindExists && hilowMigrateTable(SENSOR_MAX, slots, start) == ERROR)
+	{
+		return ERROR;
+	}
+
+	// a rerun after an interrupted conversion simply replaces the rows:
+	for (i = 0; i < HILOW_MIGRATE_SLOTS; i++)
+	{
+		if (slots[i].dateTime != 0 && hilowHourWrite(&slots[i]) == ERROR)
+		{
+			return ERROR;
+		}
+	}
+
+	return OK;
+}
+
+static int hilowMigrate(void)
+{
+	HILOW_HOUR *slots;
+	SENSOR_TYPES index;
+	char query[DB_SQLITE_QUERY_LENGTH_MAX];
+	time_t first = 0, last = 0, start, runStartTime = time(NULL), diffTime;
+	int weeks = 0;
+
+	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
+	{
+		if (LegacyTableExists[index] &&
+			hilowLegacyRange(sensorTables[index], &first, &last) == ERROR)
+		{
+			return ERROR;
+		}
+	}
+	if (LegacyWindExists &&
+		hilowLegacyRange(WVIEW_HILOW_WINDDIR_TABLE, &first, &last) == ERROR)
+	{
+		return ERROR;
+	}
+
+	slots = (HILOW_HOUR *)malloc(HILOW_MIGRATE_SLOTS * sizeof(HILOW_HOUR));
+	if (slots == NULL)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLowInit: malloc failed!");
+		return ERROR;
+	}
+
+	MsgLog(PRI_STATUS, "HILOW: converting per-sensor tables to %s", WVIEW_HILOW_HOUR_TABLE);
+	MsgLog(PRI_STATUS, "HILOW: this is a one time process (this may take a while ...)");
+
+	for (start = first; first != 0 && start <= last; start += HILOW_MIGRATE_SPAN)
 	{
-		radsqlitedirectReleaseResults(hilowDB);
-		return (time_t)(-1);
-	}
+		if (hourExec("BEGIN TRANSACTION") == ERROR)
+		{
+			free(slots);
+			return ERROR;
+		}
 
-	strncpy(tempstr, radsqliteFieldGetCharValue(field), radsqliteFieldGetCharLength(field));
-	retVal = (time_t)atoi(tempstr);
-	radsqlitedirectReleaseResults(hilowDB);
-	return retVal;
-}
+		if (hilowMigrateSpan(slots, start) == ERROR)
+		{
+			hourExec("ROLLBACK TRANSACTION");
+			free(slots);
+			return ERROR;
+		}
 
-static int hilowSetLastUpdateTime(time_t newtime)
-{
-	char query[DB_SQLITE_QUERY_LENGTH_MAX];
+		if (hourExec("COMMIT TRANSACTION") == ERROR)
+		{
+			hourExec("ROLLBACK TRANSACTION");
+			free(slots);
+			return ERROR;
+		}
 
-	if (hilowDB == NULL)
+		diffTime = time(NULL) - runStartTime;
+		weeks++;
+		MsgLog(PRI_STATUS, "HILOW: Stats:");
+		MsgLog(PRI_STATUS, "HILOW:     Time               : %2.2d:%2.2d",
+			   (int)diffTime / 60, (int)diffTime % 60);
+		MsgLog(PRI_STATUS, "HILOW:     Weeks converted    : %d", weeks);
+	}
+
+	free(slots);
+
+	// everything is in - retire the old tables together:
+	if (hourExec("BEGIN TRANSACTION") == ERROR)
 	{
-		MsgLog(PRI_HIGH, "hilowSetLastUpdateTime: failed to open %s!", hilowGetDBFilename());
 		return ERROR;
 	}
+	for (index = SENSOR_INTEMP; index <= SENSOR_MAX; index++)
+	{
+		if (index == SENSOR_MAX)
+		{
+			if (!LegacyWindExists)
+			{
+				continue;
+			}
+			sprintf(query, "DROP TABLE %s", WVIEW_HILOW_WINDDIR_TABLE);
+		}
+		else
+		{
+			if (!LegacyTableExists[index])
+			{
+				continue;
+			}
+			sprintf(query, "DROP TABLE %s", sensorTables[index]);
+		}
 
-	// update the row:
-	sprintf(query, "UPDATE %s SET value = '%d' WHERE name = 'lastUpdate'",
-			WVIEW_HILOW_META_TABLE, (int)newtime);
-
-	// Execute the query:
-	if (radsqliteQuery(hilowDB, query, FALSE) == ERROR)
+		if (hourExec(query) == ERROR)
+		{
+			hourExec("ROLLBACK TRANSACTION");
+			return ERROR;
+		}
+	}
+	if (hourExec("COMMIT TRANSACTION") == ERROR)
 	{
+		hourExec("ROLLBACK TRANSACTION");
 		return ERROR;
 	}
 
+	MsgLog(PRI_STATUS, "HILOW: per-sensor tables converted and removed");
 	return OK;
 }
 
 // Make these static so we can use the dbsqliteArchiveExecutePerRecord call to
-// efficiently populate the HILOW tables when created:
-static int IfTablesCreated = FALSE, IfWindTableExists = FALSE, IfTableExists[SENSOR_MAX];
-static time_t LastHiLowUpdate, LastArchiveTime;
+// efficiently populate the HILOW table when created:
+static time_t LastArchiveTime;
 
 // Callback method for dbsqliteArchiveExecutePerRecord:
 static void hilowInitPerRecord(ARCHIVE_PKT *rec, void *data)
@@ -920,7 +1335,7 @@ static void hilowInitPerRecord(ARCHIVE_PKT *rec, void *data)
 	SENSOR_TYPES index;
 	time_t Time = (time_t)rec->dateTime;
 
-	localtime_r(&Time, &bknTime);
+	wvutilsLocalTime(Time, &bknTime);
 	if (bknTime.tm_hour == 0 &&
 		bknTime.tm_min == rec->interval)
 	{
@@ -931,26 +1346,13 @@ static void hilowInitPerRecord(ARCHIVE_PKT *rec, void *data)
 			   bknTime.tm_mday);
 	}
 
-	// Did we just create the wind dir table -OR- is this record newer than
-	// our last update?
-	if (IfWindTableExists == FALSE || LastHiLowUpdate < rec->dateTime)
-	{
-		// Insert wind direction data:
-		hilowInsertWindDir(rec->dateTime - (60 * rec->interval),
-						   (int)rec->value[DATA_INDEX_windDir]);
-	}
+	// Insert wind direction data:
+	hilowInsertWindDir(rec->dateTime - (60 * rec->interval),
+					   (int)rec->value[DATA_INDEX_windDir]);
 
-	// Now loop through the sensor types, only updating ones we just created:
+	// Now loop through the sensor types:
 	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
 	{
-		// If this table was not just created -AND- this is not a new record:
-		if (IfTableExists[index] && LastHiLowUpdate > rec->dateTime)
-		{
-			// Nothing to do here:
-			continue;
-		}
-
-		// Update table[index] with this record:
 		hilowUpdateTableWithArchive(index, rec);
 	}
 
@@ -967,15 +1369,14 @@ int dbsqliteHiLowInit(int update)
 	SQLITE_FIELD_ID field;
 	SENSOR_TYPES index;
 	int retVal;
-	int i, done = FALSE;
+	int done = FALSE, backFill;
 	int weeks = 0;
-	char tableName[64];
 	ARCHIVE_PKT archiveRec;
 	time_t archiveTime, startTime, stopTime, runStartTime = time(NULL), diffTime;
-	char binName[16];
 	struct tm bknTime;
 
-	hilowDB = radsqliteOpen(hilowGetDBFilename());
+	hilowUpdateMode = update;
+	hilowDB = dbsqliteSessionOpen(hilowGetDBFilename(), "HILOW", DBSQLITE_PROFILE_DERIVED);
 	if (hilowDB == NULL)
 	{
 		MsgLog(PRI_HIGH, "dbsqliteHiLowInit: failed to open %s!", hilowGetDBFilename());
@@ -984,18 +1385,18 @@ int dbsqliteHiLowInit(int update)
 
 	if (!update)
 	{
-		//dbsqliteHiLowPragmaSet("journal_mode", "DELETE");
-		dbsqliteHiLowPragmaSet("synchronous", "NORMAL");
-
+		// wviewd creates the hour table; until it has, readers retry the
+		// open on each query:
+		if (hilowHourOpen(FALSE) == ERROR)
+		{
+			MsgLog(PRI_STATUS, "HILOW: %s not available yet", WVIEW_HILOW_HOUR_TABLE);
+		}
 		MsgLog(PRI_STATUS, "HILOW: OK");
 		return OK;
 	}
 
 	// Make writes faster (and less safe) by avoiding fsyncs:
-	dbsqliteHiLowPragmaSet("synchronous", "OFF");
-
-	// Make things quicker but less safe by turning off journalling:
-	//dbsqliteHiLowPragmaSet("journal_mode", "OFF");
+	dbsqliteSessionApplyProfile(hilowDB, "HILOW", DBSQLITE_PROFILE_BULK);
 
 	// Do the meta table first:
 	if (!radsqliteTableIfExists(hilowDB, WVIEW_HILOW_META_TABLE))
@@ -1004,7 +1405,7 @@ int dbsqliteHiLowInit(int update)
 		rowDesc = radsqliteRowDescriptionCreate();
 		if (rowDesc == NULL)
 		{
-			radsqliteClose(hilowDB);
+			dbsqliteSessionClose(hilowDB);
 			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: radsqliteRowDescriptionCreate failed!");
 			return ERROR;
 		}
@@ -1016,7 +1417,7 @@ int dbsqliteHiLowInit(int update)
 												 64);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(hilowDB);
+			dbsqliteSessionClose(hilowDB);
 			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1027,7 +1428,7 @@ int dbsqliteHiLowInit(int update)
 												 64);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(hilowDB);
+			dbsqliteSessionClose(hilowDB);
 			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1036,7 +1437,7 @@ int dbsqliteHiLowInit(int update)
 		// Now create the table:
 		if (radsqliteTableCreate(hilowDB, WVIEW_HILOW_META_TABLE, rowDesc) == ERROR)
 		{
-			radsqliteClose(hilowDB);
+			dbsqliteSessionClose(hilowDB);
 			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: radsqliteTableCreate failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1085,177 +1486,46 @@ int dbsqliteHiLowInit(int update)
 		MsgLog(PRI_STATUS, "HILOW %s table created", WVIEW_HILOW_META_TABLE);
 	}
 
-	// Do the wind direction bins:
-	if (radsqliteTableIfExists(hilowDB, WVIEW_HILOW_WINDDIR_TABLE))
+	// Now the hour table:
+	backFill = !radsqliteTableIfExists(hilowDB, WVIEW_HILOW_HOUR_TABLE);
+	if (hilowHourOpen(TRUE) == ERROR)
 	{
-		IfWindTableExists = TRUE;
+		dbsqliteSessionClose(hilowDB);
+		hilowDB = NULL;
+		MsgLog(PRI_HIGH, "dbsqliteHiLowInit: failed to create %s!", WVIEW_HILOW_HOUR_TABLE);
+		return ERROR;
 	}
-	else
+	if (backFill)
 	{
-		IfTablesCreated = TRUE;
-
-		// Create it:
-		rowDesc = radsqliteRowDescriptionCreate();
-		if (rowDesc == NULL)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: radsqliteRowDescriptionCreate failed!");
-			return ERROR;
-		}
-
-		// Populate the table:
-		retVal = radsqliteRowDescriptionAddField(rowDesc,
-												 "dateTime",
-												 SQLITE_FIELD_BIGINT | SQLITE_FIELD_PRI_KEY,
-												 0);
-		if (retVal == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
-
-		for (i = 0; i < WAVG_NUM_BINS; i++)
-		{
-			sprintf(binName, "bin%d", i);
-			retVal = radsqliteRowDescriptionAddField(rowDesc, binName, SQLITE_FIELD_BIGINT, 0);
-			if (retVal == ERROR)
-			{
-				radsqliteClose(hilowDB);
-				MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-				radsqliteRowDescriptionDelete(rowDesc);
-				return ERROR;
-			}
-		}
-
-		// Now create the table:
-		if (radsqliteTableCreate(hilowDB, WVIEW_HILOW_WINDDIR_TABLE, rowDesc) == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: radsqliteTableCreate failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
-		radsqliteRowDescriptionDelete(rowDesc);
-		MsgLog(PRI_STATUS, "HILOW %s table created", WVIEW_HILOW_WINDDIR_TABLE);
+		MsgLog(PRI_STATUS, "HILOW %s table created", WVIEW_HILOW_HOUR_TABLE);
 	}
+	hourExec("PRAGMA synchronous = OFF");
 
-	// Loop through all sensor types, creating tables as needed:
-	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
+	hilowLastUpdate = hilowGetLastUpdateTime();
+	if (hilowLastUpdate < 0)
 	{
-		IfTableExists[index] = FALSE;
-
-		// Does the sensor HILOW table exist?
-		if (radsqliteTableIfExists(hilowDB, sensorTables[index]))
-		{
-			IfTableExists[index] = TRUE;
-			continue;
-		}
-
-		IfTablesCreated = TRUE;
-
-		// We need to create the table:
-		// Define the row first:
-		rowDesc = radsqliteRowDescriptionCreate();
-		if (rowDesc == NULL)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: radsqliteRowDescriptionCreate failed!");
-			return ERROR;
-		}
-
-		// Populate the table:
-		retVal = radsqliteRowDescriptionAddField(rowDesc,
-												 "dateTime",
-												 SQLITE_FIELD_BIGINT | SQLITE_FIELD_PRI_KEY,
-												 0);
-		if (retVal == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
-
-		retVal = radsqliteRowDescriptionAddField(rowDesc, "low", SQLITE_FIELD_DOUBLE, 0);
-		if (retVal == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
-		retVal = radsqliteRowDescriptionAddField(rowDesc, "timeLow", SQLITE_FIELD_BIGINT, 0);
-		if (retVal == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
-		retVal = radsqliteRowDescriptionAddField(rowDesc, "high", SQLITE_FIELD_DOUBLE, 0);
-		if (retVal == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
-		retVal = radsqliteRowDescriptionAddField(rowDesc, "timeHigh", SQLITE_FIELD_BIGINT, 0);
-		if (retVal == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
-		retVal = radsqliteRowDescriptionAddField(rowDesc, "whenHigh", SQLITE_FIELD_DOUBLE, 0);
-		if (retVal == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
-		retVal = radsqliteRowDescriptionAddField(rowDesc, "cumulative", SQLITE_FIELD_DOUBLE, 0);
-		if (retVal == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
-		retVal = radsqliteRowDescriptionAddField(rowDesc, "samples", SQLITE_FIELD_BIGINT, 0);
-		if (retVal == ERROR)
-		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: databaseRowDescriptionAddField failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
-			return ERROR;
-		}
+		hilowLastUpdate = 0;
+	}
 
-		// Now create the table:
-		if (radsqliteTableCreate(hilowDB, sensorTables[index], rowDesc) == ERROR)
+	// Fold in the older table-per-sensor layout:
+	if (hilowLegacyTablesExist())
+	{
+		if (hilowMigrate() == ERROR)
 		{
-			radsqliteClose(hilowDB);
-			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: radsqliteTableCreate failed!");
-			radsqliteRowDescriptionDelete(rowDesc);
+			MsgLog(PRI_HIGH, "dbsqliteHiLowInit: HILOW conversion failed, it will be retried");
+			hilowHourClose();
+			dbsqliteSessionClose(hilowDB);
+			hilowDB = NULL;
 			return ERROR;
 		}
 
-		// We're done with this table:
-		radsqliteRowDescriptionDelete(rowDesc);
-
-		MsgLog(PRI_STATUS, "HILOW: %s table created", sensorTables[index]);
+		backFill = FALSE;
 	}
 
-	// OK, if we had to create one or more sensor tables, assume they should
-	// be completely populated:
-	if (IfTablesCreated)
+	// OK, if we had to create the hour table, assume it should be
+	// completely populated:
+	if (backFill)
 	{
-		LastHiLowUpdate = hilowGetLastUpdateTime();
-
 		MsgLog(PRI_STATUS, "HILOW: back filling tables with ALL archive data");
 		MsgLog(PRI_STATUS, "HILOW: this is a one time process when tables are created");
 		MsgLog(PRI_STATUS, "HILOW: (this may take a while ...)");
@@ -1265,12 +1535,16 @@ int dbsqliteHiLowInit(int update)
 		stopTime = startTime + WV_SECONDS_IN_WEEK;
 		while (!done)
 		{
-			// execute per row:
+			// execute per row, one transaction per week:
+			hourExec("BEGIN TRANSACTION");
 			retVal = dbsqliteArchiveExecutePerRecord(hilowInitPerRecord,
 													 NULL,
 													 startTime,
 													 stopTime,
 													 NULL);
+			hilowHourFlush();
+			hourExec("COMMIT TRANSACTION");
+
 			if (retVal == ERROR)
 			{
 				done = TRUE;
@@ -1304,22 +1578,20 @@ int dbsqliteHiLowInit(int update)
 					   (float)diffTime / (float)weeks);
 			}
 		}
-
-		hilowSetLastUpdateTime(LastArchiveTime);
 	}
 	else
 	{
 		// See if we need to grab any recent archive records since we last ran:
-		LastHiLowUpdate = hilowGetLastUpdateTime();
 		LastArchiveTime = dbsqliteArchiveGetNewestTime(&archiveRec);
 
-		if (LastHiLowUpdate < LastArchiveTime)
+		if (hilowLastUpdate < LastArchiveTime)
 		{
-			// We need to grab all records after LastHiLowUpdate:
+			// We need to grab all records after the last update:
 			MsgLog(PRI_STATUS, "HILOW: adding gap records since last update");
+			hourExec("BEGIN TRANSACTION");
 
 			// Loop through all archive records:
-			for (archiveTime = dbsqliteArchiveGetNextRecord(LastHiLowUpdate, &archiveRec);
+			for (archiveTime = dbsqliteArchiveGetNextRecord(hilowLastUpdate, &archiveRec);
 				 (int)archiveTime != ERROR;
 				 archiveTime = dbsqliteArchiveGetNextRecord(archiveTime, &archiveRec))
 			{
@@ -1347,18 +1619,21 @@ int dbsqliteHiLowInit(int update)
 					// Update this table with this record:
 					hilowUpdateTableWithArchive(index, &archiveRec);
 				}
+
+				hilowSetLastUpdateTime(LastArchiveTime);
 			}
 
-			hilowSetLastUpdateTime(LastArchiveTime);
+			hilowHourFlush();
+			hourExec("COMMIT TRANSACTION");
 		}
 		MsgLog(PRI_STATUS, "HILOW: database OK");
 	}
 
-	// Reinstate journals:
-	//dbsqliteHiLowPragmaSet("journal_mode", "DELETE");
+	hilowSaveLastUpdateTime();
 
 	// Restore normal syncing behavior:
-	dbsqliteHiLowPragmaSet("synchronous", "NORMAL");
+	hourExec("PRAGMA synchronous = NORMAL");
+	dbsqliteSessionApplyProfile(hilowDB, "HILOW", DBSQLITE_PROFILE_DERIVED);
 
 	MsgLog(PRI_STATUS, "HILOW: beginning normal LOOP operation");
 	return OK;
@@ -1366,8 +1641,21 @@ int dbsqliteHiLowInit(int update)
 
 void dbsqliteHiLowExit(void)
 {
+	if (hilowUpdateMode && hourDB != NULL)
+	{
+		hilowHourFlush();
+	}
+	hilowHourClose();
+
 	if (hilowDB)
-		radsqliteClose(hilowDB);
+	{
+		if (hilowUpdateMode)
+		{
+			hilowSaveLastUpdateTime();
+		}
+		dbsqliteSessionClose(hilowDB);
+		hilowDB = NULL;
+	}
 }
 
 // set a PRAGMA to modify the operation of the SQLite library:
@@ -1389,7 +1677,7 @@ int dbsqliteHiLowPragmaSet(char *pragma, char *setting)
 	sprintf(query, "PRAGMA %s = %s", pragma, setting);
 
 	// Execute the query:
-	if (radsqliteQuery(hilowDB, query, FALSE) == ERROR)
+	if (dbsqliteSessionQuery(hilowDB, query, FALSE) == ERROR)
 	{
 		return ERROR;
 	}
@@ -1403,7 +1691,6 @@ int dbsqliteHiLowPragmaSet(char *pragma, char *setting)
 int dbsqliteHiLowStoreSample(time_t timestamp, LOOP_PKT *sample)
 {
 	SENSOR_TYPES index;
-	char fileName[128];
 
 	// Update the update time:
 	hilowSetLastUpdateTime(timestamp);
@@ -1411,17 +1698,15 @@ int dbsqliteHiLowStoreSample(time_t timestamp, LOOP_PKT *sample)
 	// Loop through the sensor types:
 	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
 	{
-		// Update this table with this record:
+		// Update this sensor with this record:
 		hilowUpdateTableWithSample(index, timestamp, sample);
 	}
 
 	// Update wind direction:
 	hilowInsertWindDir(timestamp, sample->windDir);
 
-	//sprintf(fileName, "%s/%s", HILOWDIR, WVIEW_HILOW_MARKER_FILE);
-	//wvutilsWriteMarkerFile( fileName, timestamp );
-
-	return OK;
+	// One row write for the whole sample:
+	return hilowHourFlush();
 }
 
 //  ... Update database with an archive record in lieu of LOOP samples:
@@ -1430,7 +1715,6 @@ int dbsqliteHiLowStoreSample(time_t timestamp, LOOP_PKT *sample)
 int dbsqliteHiLowStoreArchive(ARCHIVE_PKT *record)
 {
 	SENSOR_TYPES index;
-	char fileName[128];
 
 	// Update the update time:
 	hilowSetLastUpdateTime(record->dateTime);
@@ -1438,17 +1722,14 @@ int dbsqliteHiLowStoreArchive(ARCHIVE_PKT *record)
 	// Loop through the sensor types:
 	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
 	{
-		// Update this table with this record:
+		// Update this sensor with this record:
 		hilowUpdateTableWithArchive(index, record);
 	}
 
 	// Update wind direction:
 	hilowInsertWindDir(record->dateTime, (int)record->value[DATA_INDEX_windDir]);
 
-	//sprintf(fileName, "%s/%s", HILOWDIR, WVIEW_HILOW_MARKER_FILE);
-	//wvutilsWriteMarkerFile( fileName, record->dateTime );
-
-	return OK;
+	return hilowHourFlush();
 }
 
 //  ... Update database with an archive record, ignoring cumulative values:
@@ -1470,14 +1751,14 @@ int dbsqliteHiLowUpdateArchive(ARCHIVE_PKT *record)
 			continue;
 		}
 
-		// Update this table with this record:
+		// Update this sensor with this record:
 		hilowUpdateTableWithArchive(index, record);
 	}
 
 	// Update wind direction:
 	hilowInsertWindDir(record->dateTime, (int)record->value[DATA_INDEX_windDir]);
 
-	return OK;
+	return hilowHourFlush();
 }
 
 //  ... Update sensors for the given hour and time frame:
@@ -1521,23 +1802,76 @@ int dbsqliteHiLowGetDay(
 	return (hilowGetDataTimeFrame(first, last, sensors, timeFrame));
 }
 
+int dbsqliteHiLowGetDays(
+	time_t first,
+	time_t last,
+	SENSOR_STORE *sensors,
+	SENSOR_TIMEFRAMES timeFrame,
+	HILOW_DAY_FUNC dayDone,
+	void *data)
+{
+	HILOW_DAY_BUCKET *days;
+	time_t dayTime, blockEnd;
+	int i, numDays, numrecs = 0;
+
+	days = (HILOW_DAY_BUCKET *)malloc(HILOW_DAYS_PER_PASS * sizeof(HILOW_DAY_BUCKET));
+	if (days == NULL)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLowGetDays: malloc failed!");
+		return ERROR;
+	}
+
+	dayTime = wvutilsDayStart(first);
+	while (dayTime < last)
+	{
+		// lay out the next block of local days:
+		for (numDays = 0; numDays < HILOW_DAYS_PER_PASS && dayTime < last; numDays++)
+		{
+			days[numDays].dayStart = dayTime;
+			days[numDays].dayEnd = wvutilsDayEnd(dayTime);
+			days[numDays].records = 0;
+			sensorClearSet(days[numDays].sensor);
+			windAverageReset(&days[numDays].wind);
+			dayTime = days[numDays].dayEnd;
+		}
+
+		blockEnd = ((dayTime < last) ? dayTime : last);
+		if (hilowGetDaysBlock(days, numDays, blockEnd) == ERROR)
+		{
+			free(days);
+			return ERROR;
+		}
+
+		for (i = 0; i < numDays; i++)
+		{
+			if (days[i].records == 0)
+			{
+				continue;
+			}
+
+			memcpy(sensors->sensor[timeFrame], days[i].sensor, sizeof(days[i].sensor));
+			sensors->wind[timeFrame] = days[i].wind;
+			numrecs += days[i].records;
+			(*dayDone)(days[i].dayStart, days[i].records, data);
+		}
+	}
+
+	free(days);
+	return numrecs;
+}
+
 int dbsqliteHiLowGetMonth(
 	time_t month,
 	SENSOR_STORE *sensors,
 	SENSOR_TIMEFRAMES timeFrame,
 	int yearRainFlag)
 {
-	int retVal = 0;
-	char query[DB_SQLITE_QUERY_LENGTH_MAX];
-	SQLITE_DIRECT_ROW rowDescr;
-	SQLITE_FIELD_ID field;
+	int status, retVal = 0;
 	time_t first, last;
 	struct tm bknTime;
 	WV_SENSOR *tempSensor;
-	WV_SENSOR store;
-	int i, bins[WAVG_NUM_BINS];
-	char binName[16];
-	SENSOR_TYPES index;
+	WV_SENSOR *store;
+	HILOW_HOUR hour;
 
 	localtime_r(&month, &bknTime);
 	bknTime.tm_mday = 1;
@@ -1549,148 +1883,63 @@ int dbsqliteHiLowGetMonth(
 	first = month;
 	last = mktime(&bknTime);
 
-	if (hilowDB == NULL)
+	if (hilowHourScanBegin(first, last) == ERROR)
 	{
 		MsgLog(PRI_HIGH, "dbsqliteHiLowGetMonth: failed to open %s!", hilowGetDBFilename());
 		return ERROR;
 	}
 
-	// Loop through the sensor types:
-	for (index = SENSOR_INTEMP; index < SENSOR_MAX; index++)
+	while ((status = hilowHourScanNext(&hour)) == TRUE)
 	{
-		// grab the rows:
-		sprintf(query, "SELECT * FROM %s WHERE dateTime >= '%d' AND dateTime < '%d' ORDER BY dateTime ASC",
-				sensorTables[index], (int)first, (int)last);
-
-		// Execute the query:
-		if (radsqlitedirectQuery(hilowDB, query, TRUE) == ERROR)
-		{
-			return ERROR;
-		}
-
-		retVal = 0;
-		for (rowDescr = radsqlitedirectGetRow(hilowDB);
-			 rowDescr != NULL;
-			 rowDescr = radsqlitedirectGetRow(hilowDB))
+		if (!yearRainFlag)
 		{
-			if (yearRainFlag)
+			if (hilowAddHour(&hour, sensors->sensor[timeFrame], &sensors->wind[timeFrame]))
 			{
-				tempSensor = &sensors->sensor[STF_YEAR][index];
-				if (index == SENSOR_RAIN)
-				{
-					retVal++;
-					if (hilowExtractValues(rowDescr, &store) == ERROR)
-					{
-						radsqlitedirectReleaseResults(hilowDB);
-						MsgLog(PRI_HIGH, "dbsqliteHiLowGetMonth: failed to extract data");
-						return ERROR;
-					}
-
-					tempSensor->cumulative += store.cumulative;
-					tempSensor->samples += store.samples;
-				}
-				else if (index == SENSOR_RAINRATE)
-				{
-					if (hilowExtractValues(rowDescr, &store) == ERROR)
-					{
-						radsqlitedirectReleaseResults(hilowDB);
-						MsgLog(PRI_HIGH, "dbsqliteHiLowGetMonth: failed to extract data");
-						return ERROR;
-					}
-
-					tempSensor->cumulative += store.cumulative;
-					tempSensor->samples += store.samples;
-					if (tempSensor->high < store.high)
-					{
-						tempSensor->high = store.high;
-						tempSensor->time_high = store.time_high;
-						tempSensor->when_high = store.when_high;
-					}
-				}
-				else if (index == SENSOR_ET)
-				{
-					if (hilowExtractValues(rowDescr, &store) == ERROR)
-					{
-						radsqlitedirectReleaseResults(hilowDB);
-						MsgLog(PRI_HIGH, "dbsqliteHiLowGetMonth: failed to extract data");
-						return ERROR;
-					}
-
-					tempSensor->cumulative += store.cumulative;
-					tempSensor->samples += store.samples;
-				}
-				continue;
+				retVal++;
 			}
+			continue;
+		}
 
-			// copy it to the internal store:
-			tempSensor = &sensors->sensor[timeFrame][index];
-
-			if (hilowExtractValues(rowDescr, &store) == ERROR)
-			{
-				radsqlitedirectReleaseResults(hilowDB);
-				MsgLog(PRI_HIGH, "dbsqliteHiLowGetMonth: failed to extract data");
-				return ERROR;
-			}
+		// only the rain season totals go to STF_YEAR:
+		store = &hour.sensor[SENSOR_RAIN];
+		if (store->samples > 0)
+		{
+			retVal++;
+			tempSensor = &sensors->sensor[STF_YEAR][SENSOR_RAIN];
+			tempSensor->cumulative += store->cumulative;
+			tempSensor->samples += store->samples;
+		}
 
-			tempSensor->cumulative += store.cumulative;
-			tempSensor->samples += store.samples;
-			if (tempSensor->low > store.low)
-			{
-				tempSensor->low = store.low;
-				tempSensor->time_low = store.time_low;
-			}
-			if (tempSensor->high < store.high)
+		store = &hour.sensor[SENSOR_RAINRATE];
+		if (store->samples > 0)
+		{
+			tempSensor = &sensors->sensor[STF_YEAR][SENSOR_RAINRATE];
+			tempSensor->cumulative += store->cumulative;
+			tempSensor->samples += store->samples;
+			if (tempSensor->high < store->high)
 			{
-				tempSensor->high = store.high;
-				tempSensor->time_high = store.time_high;
-				tempSensor->when_high = store.when_high;
+				tempSensor->high = store->high;
+				tempSensor->time_high = store->time_high;
+				tempSensor->when_high = store->when_high;
 			}
 		}
 
-		radsqlitedirectReleaseResults(hilowDB);
-	}
-
-	if (yearRainFlag)
-	{
-		return retVal;
+		store = &hour.sensor[SENSOR_ET];
+		if (store->samples > 0)
+		{
+			tempSensor = &sensors->sensor[STF_YEAR][SENSOR_ET];
+			tempSensor->cumulative += store->cumulative;
+			tempSensor->samples += store->samples;
+		}
 	}
 
-	// Do the wind dir here:
-	sprintf(query, "SELECT * FROM %s WHERE dateTime >= '%d' AND dateTime < '%d' ORDER BY dateTime ASC",
-			WVIEW_HILOW_WINDDIR_TABLE, (int)first, (int)last);
-
-	// Execute the query:
-	if (radsqlitedirectQuery(hilowDB, query, TRUE) == ERROR)
+	hilowHourScanEnd();
+	if (status == ERROR)
 	{
+		MsgLog(PRI_HIGH, "dbsqliteHiLowGetMonth: failed to extract data");
 		return ERROR;
 	}
 
-	retVal = 0;
-	for (rowDescr = radsqlitedirectGetRow(hilowDB);
-		 rowDescr != NULL;
-		 rowDescr = radsqlitedirectGetRow(hilowDB))
-	{
-		retVal++;
-		for (i = 0; i < WAVG_NUM_BINS; i++)
-		{
-			bins[i] = 0;
-			sprintf(binName, "bin%d", i);
-			field = radsqlitedirectFieldGet(rowDescr, binName);
-			if (field == NULL)
-			{
-				radsqlitedirectReleaseResults(hilowDB);
-				return ERROR;
-			}
-			else
-			{
-				bins[i] = (int)radsqliteFieldGetBigIntValue(field);
-			}
-		}
-
-		windAverageAddBins(&sensors->wind[timeFrame], bins);
-	}
-
-	radsqlitedirectReleaseResults(hilowDB);
 	return retVal;
 }
 
@@ -1699,4 +1948,4 @@ int dbsqliteHiLowGetMonth(
 time_t dbsqliteHiLowGetLastUpdate(void)
 {
 	return (hilowGetLastUpdateTime());
-}
\ No newline at end of file
+}
@@ -99,6 +99,7 @@ static const char*  historyName[DATA_INDEX_MAX] =
 };
 
 static char     DefaultArchivePath[_MAX_PATH] = { 0 };
+static SQLITE_DATABASE_ID  historyDB = NULL;
 
 //  ... ----- static (local) methods -----
 
@@ -142,7 +143,7 @@ static int getHistoryRecord(SQLITE_DATABASE_ID historyDB, time_t date, HISTORY_D
 		WVIEW_DAY_HISTORY_TABLE, dayString);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(historyDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(historyDB, query, TRUE) == ERROR)
 	{
 		MsgLog(PRI_MEDIUM, "dbsqliteHistory: row count query failed.");
 		return ERROR;
@@ -172,7 +173,7 @@ static int getHistoryRecord(SQLITE_DATABASE_ID historyDB, time_t date, HISTORY_D
 			WVIEW_DAY_HISTORY_TABLE, dayString);
 
 		// Execute the query:
-		radsqliteQuery(historyDB, query, FALSE);
+		dbsqliteSessionQuery(historyDB, query, FALSE);
 
 		// Return ERROR regardless...
 		return ERROR;
@@ -184,7 +185,7 @@ static int getHistoryRecord(SQLITE_DATABASE_ID historyDB, time_t date, HISTORY_D
 		WVIEW_DAY_HISTORY_TABLE, (int)date);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(historyDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(historyDB, query, TRUE) == ERROR)
 	{
 		return ERROR;
 	}
@@ -320,27 +321,17 @@ static int insertDBHistoryData(SQLITE_DATABASE_ID historyDB, HISTORY_DATA* data)
 	return OK;
 }
 
-//  #####################  API Functions #####################
-
-void dbsqliteHistoryInit(void)
+//  ... create the day history table if it isn't there yet; OK or ERROR
+static int historyCreateTable(SQLITE_DATABASE_ID db)
 {
 	SQLITE_ROW_ID       rowDesc;
 	Data_Indices        index;
 	int                 retVal;
-	SQLITE_DATABASE_ID  historyDB = NULL;
-
-	historyDB = radsqliteOpen(getHistoryDBFilename());
-	if (historyDB == NULL)
-	{
-		MsgLog(PRI_HIGH, "dbsqliteHistoryInit: failed to open %s!", getHistoryDBFilename());
-		return;
-	}
 
 	// Does the day history table exist?
-	if (radsqliteTableIfExists(historyDB, WVIEW_DAY_HISTORY_TABLE))
+	if (radsqliteTableIfExists(db, WVIEW_DAY_HISTORY_TABLE))
 	{
-		radsqliteClose(historyDB);
-		return;
+		return OK;
 	}
 
 	// We need to create the table:
@@ -348,9 +339,8 @@ void dbsqliteHistoryInit(void)
 	rowDesc = radsqliteRowDescriptionCreate();
 	if (rowDesc == NULL)
 	{
-		radsqliteClose(historyDB);
 		MsgLog(PRI_HIGH, "dbsqliteHistoryInit: radsqliteRowDescriptionCreate failed!");
-		return;
+		return ERROR;
 	}
 
 	// Populate the table:
@@ -360,10 +350,9 @@ void dbsqliteHistoryInit(void)
 		0);
 	if (retVal == ERROR)
 	{
-		radsqliteClose(historyDB);
 		MsgLog(PRI_HIGH, "dbsqliteHistoryInit: databaseRowDescriptionAddField failed!");
 		radsqliteRowDescriptionDelete(rowDesc);
-		return;
+		return ERROR;
 	}
 
 	for (index = 0; index < DATA_INDEX_MAX; index++)
@@ -374,39 +363,75 @@ void dbsqliteHistoryInit(void)
 			0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(historyDB);
 			MsgLog(PRI_HIGH, "dbsqliteHistoryInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
-			return;
+			return ERROR;
 		}
 	}
 
 	// Now create the table:
-	if (radsqliteTableCreate(historyDB, WVIEW_DAY_HISTORY_TABLE, rowDesc) == ERROR)
+	if (radsqliteTableCreate(db, WVIEW_DAY_HISTORY_TABLE, rowDesc) == ERROR)
 	{
-		radsqliteClose(historyDB);
 		MsgLog(PRI_HIGH, "dbsqliteHistoryInit: radsqliteTableCreate failed!");
 		radsqliteRowDescriptionDelete(rowDesc);
-		return;
+		return ERROR;
 	}
 
 	// We're done:
 	radsqliteRowDescriptionDelete(rowDesc);
+	return OK;
+}
+
+//  ... the history handle is opened on first use and kept until exit;
+//  ... returns NULL if the database can't be opened or set up
+static SQLITE_DATABASE_ID historyOpen(const char* caller)
+{
+	if (historyDB != NULL)
+	{
+		return historyDB;
+	}
+
+	historyDB = dbsqliteSessionOpen(getHistoryDBFilename(), "history", DBSQLITE_PROFILE_DERIVED);
+	if (historyDB == NULL)
+	{
+		MsgLog(PRI_HIGH, "%s: failed to open %s!", caller, getHistoryDBFilename());
+		return NULL;
+	}
+
+	if (historyCreateTable(historyDB) == ERROR)
+	{
+		dbsqliteSessionClose(historyDB);
+		historyDB = NULL;
+		return NULL;
+	}
+
+	return historyDB;
+}
+
+//  #####################  API Functions #####################
 
-	radsqliteClose(historyDB);
+void dbsqliteHistoryInit(void)
+{
+	historyOpen("dbsqliteHistoryInit");
 	return;
 }
 
+void dbsqliteHistoryExit(void)
+{
+	if (historyDB != NULL)
+	{
+		dbsqliteSessionClose(historyDB);
+		historyDB = NULL;
+	}
+}
+
 // PRAGMA statement to modify the operation of the SQLite library
 int dbsqliteHistoryPragmaSet(char* pragma, char* setting)
 {
 	char                query[DB_SQLITE_QUERY_LENGTH_MAX];
-	SQLITE_DATABASE_ID  historyDB = NULL;
 
-	historyDB = radsqliteOpen(getHistoryDBFilename());
-	if (historyDB == NULL)
+	if (historyOpen("dbsqliteHistoryPragmaSet") == NULL)
 	{
-		MsgLog(PRI_HIGH, "dbsqliteHistoryPragmaSet: failed to open %s!", getHistoryDBFilename());
 		return ERROR;
 	}
 
@@ -416,7 +441,6 @@ int dbsqliteHistoryPragmaSet(char* pragma, char* setting)
 		if (SQLITE_VERSION_NUMBER < 3005009)
 		{
 			// Not supported:
-			radsqliteClose(historyDB);
 			return OK;
 		}
 	}
@@ -424,64 +448,44 @@ int dbsqliteHistoryPragmaSet(char* pragma, char* setting)
 	sprintf(query, "PRAGMA %s = %s", pragma, setting);
 
 	// Execute the query:
-	if (radsqliteQuery(historyDB, query, FALSE) == ERROR)
+	if (dbsqliteSessionQuery(historyDB, query, FALSE) == ERROR)
 	{
 		return ERROR;
 	}
 
-	radsqliteClose(historyDB);
 	return OK;
 }
 
 int dbsqliteHistoryInsertDay(HISTORY_DATA* data)
 {
-	SQLITE_DATABASE_ID  historyDB = NULL;
-
-	historyDB = radsqliteOpen(getHistoryDBFilename());
-	if (historyDB == NULL)
+	if (historyOpen("dbsqliteHistoryInsertDay") == NULL)
 	{
-		MsgLog(PRI_HIGH, "dbsqliteHistoryInsertDay: failed to open %s!", getHistoryDBFilename());
 		return ERROR;
 	}
 
 	// Now do some inserting:
 	if (insertDBHistoryData(historyDB, data) == ERROR)
 	{
-		radsqliteClose(historyDB);
 		MsgLog(PRI_HIGH, "dbsqliteHistoryInsertDay: insertDBHistoryData failed!");
 		return ERROR;
 	}
 
-	radsqliteClose(historyDB);
 	return OK;
 }
 
 int dbsqliteHistoryGetDay(time_t date, HISTORY_DATA* store)
 {
-	SQLITE_DATABASE_ID  historyDB = NULL;
-
-	historyDB = radsqliteOpen(getHistoryDBFilename());
-	if (historyDB == NULL)
-	{
-		MsgLog(PRI_HIGH, "dbsqliteHistoryInsertDay: failed to open %s!", getHistoryDBFilename());
-		return ERROR;
-	}
-
-	// First make sure the day history table exists:
-	if (!radsqliteTableIfExists(historyDB, WVIEW_DAY_HISTORY_TABLE))
+	if (historyOpen("dbsqliteHistoryGetDay") == NULL)
 	{
-		radsqliteClose(historyDB);
 		return ERROR;
 	}
 
 	// Try to get the day requested:
 	if (getHistoryRecord(historyDB, date, store) == ERROR)
 	{
-		radsqliteClose(historyDB);
 		return ERROR;
 	}
 
-	radsqliteClose(historyDB);
 	return OK;
 }
 
@@ -224,7 +224,7 @@ static int noaaGetRecord(time_t dateTime, NOAA_DAY_REC* newRec)
 		WVIEW_NOAA_TABLE, (int)dateTime);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(noaaDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(noaaDB, query, TRUE) == ERROR)
 	{
 		return ERROR;
 	}
@@ -263,7 +263,7 @@ static int noaaDeleteRecord(time_t dateTime)
 		WVIEW_NOAA_TABLE, (int)dateTime);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(noaaDB, query, FALSE) == ERROR)
+	if (dbsqliteSessionDirectQuery(noaaDB, query, FALSE) == ERROR)
 	{
 		return ERROR;
 	}
@@ -276,27 +276,14 @@ static int noaaInsertData(time_t timestamp, SENSOR_STORE* sensorStore)
 	SQLITE_ROW_ID           row;
 	SQLITE_FIELD_ID         field;
 	time_t                  noaaDayTime;
-	struct tm               bknTime;
-	NOAA_DAY_REC            store;
-	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
 	double                  tempd, sum;
 	int                     tempint;
 	WV_SENSOR*              sensors = sensorStore->sensor[STF_DAY];
 
-	noaaDayTime = timestamp;
-	localtime_r(&noaaDayTime, &bknTime);
-	bknTime.tm_hour = 0;
-	bknTime.tm_min = 0;
-	bknTime.tm_sec = 0;
-	bknTime.tm_isdst = -1;
-	noaaDayTime = mktime(&bknTime);
+	noaaDayTime = wvutilsDayStart(timestamp);
 
-	// First see if the record exists:
-	if (noaaGetRecord(noaaDayTime, &store) == OK)
-	{
-		// Delete so we can replace it:
-		noaaDeleteRecord(noaaDayTime);
-	}
+	// Delete any existing record so we can replace it:
+	noaaDeleteRecord(noaaDayTime);
 
 	// create a new record:
 	row = radsqliteTableDescriptionGet(noaaDB, WVIEW_NOAA_TABLE);
@@ -1321,6 +1308,61 @@ static int noaaInsertData(time_t timestamp, SENSOR_STORE* sensorStore)
 	return OK;
 }
 
+// Sync state for noaaSyncDays:
+typedef struct
+{
+	SENSOR_STORE*           sensorStore;
+	int                     numNOAARecs;
+	time_t                  lastInsertTime;
+} NOAA_SYNC;
+
+static void noaaSyncDay(time_t day, int numRecs, void* data)
+{
+	NOAA_SYNC*              sync = (NOAA_SYNC*)data;
+
+	if (noaaInsertData(day, sync->sensorStore) == OK)
+	{
+		sync->numNOAARecs++;
+		sync->lastInsertTime = day;
+	}
+}
+
+// Build NOAA records for the local days in [startTime, stopTime) from one
+// grouped HILOW scan, written in a single transaction;
+// Returns number of HILOW records processed or ERROR
+static int noaaSyncDays(time_t startTime, time_t stopTime, NOAA_SYNC* sync)
+{
+	int                     retVal;
+
+	if (dbsqliteSessionQuery(noaaDB, "BEGIN TRANSACTION", FALSE) == ERROR)
+	{
+		MsgLog(PRI_HIGH, "noaaSyncDays: BEGIN TRANSACTION failed!");
+		return ERROR;
+	}
+
+	retVal = dbsqliteHiLowGetDays(startTime, stopTime,
+								  sync->sensorStore, STF_DAY,
+								  noaaSyncDay, sync);
+	if (retVal == ERROR)
+	{
+		dbsqliteSessionQuery(noaaDB, "ROLLBACK TRANSACTION", FALSE);
+		sync->numNOAARecs = 0;
+		sync->lastInsertTime = 0;
+		return ERROR;
+	}
+
+	if (dbsqliteSessionQuery(noaaDB, "COMMIT TRANSACTION", FALSE) == ERROR)
+	{
+		MsgLog(PRI_HIGH, "noaaSyncDays: COMMIT TRANSACTION failed!");
+		dbsqliteSessionQuery(noaaDB, "ROLLBACK TRANSACTION", FALSE);
+		sync->numNOAARecs = 0;
+		sync->lastInsertTime = 0;
+		return ERROR;
+	}
+
+	return retVal;
+}
+
 static time_t noaaGetFirstUpdateDay(void)
 {
 	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
@@ -1338,7 +1380,7 @@ static time_t noaaGetFirstUpdateDay(void)
 	sprintf(query, "SELECT MIN(dateTime) AS 'min' FROM %s", WVIEW_NOAA_TABLE);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(noaaDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(noaaDB, query, TRUE) == ERROR)
 	{
 		MsgLog(PRI_HIGH, "getNewestDateTime: radsqlitedirectQuery failed!");
 		return ERROR;
@@ -1387,7 +1429,7 @@ static time_t noaaGetLastUpdateDay(void)
 	sprintf(query, "SELECT MAX(dateTime) AS 'max' FROM %s", WVIEW_NOAA_TABLE);
 
 	// Execute the query:
-	if (radsqlitedirectQuery(noaaDB, query, TRUE) == ERROR)
+	if (dbsqliteSessionDirectQuery(noaaDB, query, TRUE) == ERROR)
 	{
 		MsgLog(PRI_HIGH, "noaaGetLastUpdateDay: radsqlitedirectQuery failed!");
 		return ERROR;
@@ -1427,17 +1469,17 @@ int dbsqliteNOAAInit(void)
 	SQLITE_ROW_ID       rowDesc, newrow;
 	SQLITE_FIELD_ID     field;
 	SENSOR_TYPES        index;
-	int                 retVal, numrecs = 0, numNOAARecs = 0;
+	int                 retVal, numrecs = 0;
 	int                 i, done = FALSE;
 	char                tableName[64];
 	ARCHIVE_PKT         archiveRec;
 	SENSOR_STORE        sensorStore;
-	time_t              archiveTime, startTime, stopTime, hilowTime;
+	NOAA_SYNC           sync;
+	time_t              archiveTime, startTime, stopTime;
 	char                binName[16];
-	struct tm           bknTime;
 	time_t              LastNOAAUpdateTime, LastArchiveTime;
 
-	noaaDB = radsqliteOpen(noaaGetDBFilename());
+	noaaDB = dbsqliteSessionOpen(noaaGetDBFilename(), "NOAA", DBSQLITE_PROFILE_DERIVED);
 	if (noaaDB == NULL)
 	{
 		MsgLog(PRI_HIGH, "dbsqliteNOAAInit: failed to open %s!", noaaGetDBFilename());
@@ -1448,14 +1490,14 @@ int dbsqliteNOAAInit(void)
 	if (!radsqliteTableIfExists(noaaDB, WVIEW_NOAA_TABLE))
 	{
 		// Make writes faster (and less safe) by avoiding fsyncs:
-		dbsqliteNOAAPragmaSet("synchronous", "off");
+		dbsqliteSessionApplyProfile(noaaDB, "NOAA", DBSQLITE_PROFILE_BULK);
 
 		// We need to create the table:
 		// Define the row first:
 		rowDesc = radsqliteRowDescriptionCreate();
 		if (rowDesc == NULL)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: radsqliteRowDescriptionCreate failed!");
 			return ERROR;
 		}
@@ -1467,7 +1509,7 @@ int dbsqliteNOAAInit(void)
 			0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1476,7 +1518,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanTemp", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1484,7 +1526,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highTemp", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1492,7 +1534,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highTempTime", SQLITE_FIELD_BIGINT, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1500,7 +1542,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowTemp", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1508,7 +1550,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowTempTime", SQLITE_FIELD_BIGINT, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1516,7 +1558,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "heatDegDays", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1524,7 +1566,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "coolDegDays", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1532,7 +1574,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "rain", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1540,7 +1582,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "avgWind", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1548,7 +1590,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highWind", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1556,7 +1598,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highWindTime", SQLITE_FIELD_BIGINT, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1564,7 +1606,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "domWindDir", SQLITE_FIELD_BIGINT, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1573,7 +1615,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanOutHumid", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1581,7 +1623,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highOutHumid", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1589,7 +1631,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowOutHumid", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1597,7 +1639,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanBP", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1605,7 +1647,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highBP", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1613,7 +1655,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowBP", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1621,7 +1663,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanDewPoint", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1629,7 +1671,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highDewPoint", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1637,7 +1679,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowDewPoint", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1645,7 +1687,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanWChill", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1653,7 +1695,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highWChill", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1661,7 +1703,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowWchill", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1669,7 +1711,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanHIndex", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1677,7 +1719,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highHIndex", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1685,7 +1727,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowHIndex", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1693,7 +1735,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "ET", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1701,7 +1743,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanUV", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1709,7 +1751,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highUV", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1717,7 +1759,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowUV", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1725,7 +1767,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanSolRad", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1733,7 +1775,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highSolRad", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1741,7 +1783,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowSolRad", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1749,7 +1791,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanExtraTemp1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1757,7 +1799,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highExtraTemp1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1765,7 +1807,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowExtraTemp1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1773,7 +1815,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanExtraTemp2", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1781,7 +1823,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highExtraTemp2", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1789,7 +1831,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowExtraTemp2", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1797,7 +1839,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanSoilTemp1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1805,7 +1847,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highSoilTemp1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1813,7 +1855,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowSoilTemp1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1821,7 +1863,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanSoilMoist1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1829,7 +1871,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highSoilMoist1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1837,7 +1879,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowSoilMoist1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1845,7 +1887,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "meanLeafWet1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1853,7 +1895,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "highLeafWet1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1861,7 +1903,7 @@ int dbsqliteNOAAInit(void)
 		retVal = radsqliteRowDescriptionAddField(rowDesc, "lowLeafWet1", SQLITE_FIELD_DOUBLE, 0);
 		if (retVal == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: databaseRowDescriptionAddField failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1870,7 +1912,7 @@ int dbsqliteNOAAInit(void)
 		// Now create the table:
 		if (radsqliteTableCreate(noaaDB, WVIEW_NOAA_TABLE, rowDesc) == ERROR)
 		{
-			radsqliteClose(noaaDB);
+			dbsqliteSessionClose(noaaDB);
 			MsgLog(PRI_HIGH, "dbsqliteNOAAInit: radsqliteTableCreate failed!");
 			radsqliteRowDescriptionDelete(rowDesc);
 			return ERROR;
@@ -1890,20 +1932,8 @@ int dbsqliteNOAAInit(void)
 		else
 		{
 			// Back fill the table:
-			localtime_r(&startTime, &bknTime);
-			bknTime.tm_hour = 4;            // Avoid DST issues
-			bknTime.tm_min = 0;
-			bknTime.tm_sec = 0;
-			bknTime.tm_isdst = -1;
-			startTime = mktime(&bknTime);
-
-			stopTime = time(NULL);
-			localtime_r(&stopTime, &bknTime);
-			bknTime.tm_hour = 0;
-			bknTime.tm_min = 0;
-			bknTime.tm_sec = 0;
-			bknTime.tm_isdst = -1;
-			stopTime = mktime(&bknTime);
+			startTime = wvutilsDayStart(startTime);
+			stopTime = wvutilsDayStart(time(NULL));
 
 			MsgLog(PRI_STATUS, "NOAA DB: back filling tables with ALL HILOW data");
 			MsgLog(PRI_STATUS, "NOAA DB: syncing %4.4d%2.2d%2.2d => %4.4d%2.2d%2.2d",
@@ -1915,46 +1945,18 @@ int dbsqliteNOAAInit(void)
 				wvutilsGetDay(stopTime - 1));
 			MsgLog(PRI_STATUS, "NOAA DB: (this may take a while ...)");
 
-			// Loop through all days:
-			while (startTime < stopTime)
+			// Summarize all days (gaps are skipped):
+			sync.sensorStore = &sensorStore;
+			sync.numNOAARecs = 0;
+			sync.lastInsertTime = 0;
+			numrecs = noaaSyncDays(startTime, stopTime, &sync);
+			if (numrecs == ERROR)
 			{
-				localtime_r(&startTime, &bknTime);
-				bknTime.tm_hour = 0;
-				bknTime.tm_min = 0;
-				bknTime.tm_sec = 0;
-				bknTime.tm_isdst = -1;
-				hilowTime = mktime(&bknTime);
-
-				windAverageReset(&sensorStore.wind[STF_DAY]);
-				sensorClearSet(sensorStore.sensor[STF_DAY]);
-
-				retVal = dbsqliteHiLowGetDay(hilowTime, &sensorStore, STF_DAY);
-				if (retVal == ERROR)
-				{
-					return ERROR;
-				}
-				else if (retVal == 0)
-				{
-					// Continue in case there is a gap:
-					startTime += WV_SECONDS_IN_DAY;
-					continue;
-				}
-				else
-				{
-					// Write a record:
-					numrecs += retVal;
-
-					if (noaaInsertData(startTime, &sensorStore) == OK)
-					{
-						numNOAARecs++;
-					}
-
-					startTime += WV_SECONDS_IN_DAY;
-				}
+				return ERROR;
 			}
 
 			MsgLog(PRI_STATUS, "NOAA DB: done: %d HILOW records => %d NOAA records",
-				numrecs, numNOAARecs);
+				numrecs, sync.numNOAARecs);
 		}
 	}
 	else
@@ -1963,7 +1965,7 @@ int dbsqliteNOAAInit(void)
 	}
 
 	// Set normal syncing behavior:
-	dbsqliteNOAAPragmaSet("synchronous", "normal");
+	dbsqliteSessionApplyProfile(noaaDB, "NOAA", DBSQLITE_PROFILE_DERIVED);
 
 	return OK;
 }
@@ -1971,7 +1973,10 @@ int dbsqliteNOAAInit(void)
 void dbsqliteNOAAExit(void)
 {
 	if (noaaDB)
-		radsqliteClose(noaaDB);
+	{
+		dbsqliteSessionClose(noaaDB);
+		noaaDB = NULL;
+	}
 }
 
 // set a PRAGMA to modify the operation of the SQLite library:
@@ -1993,7 +1998,7 @@ int dbsqliteNOAAPragmaSet(char* pragma, char* setting)
 	sprintf(query, "PRAGMA %s = %s", pragma, setting);
 
 	// Execute the query:
-	if (radsqliteQuery(noaaDB, query, FALSE) == ERROR)
+	if (dbsqliteSessionQuery(noaaDB, query, FALSE) == ERROR)
 	{
 		return ERROR;
 	}
@@ -2033,12 +2038,11 @@ int dbsqliteNOAAGetDay
 
 int dbsqliteNOAAComputeNorms(float* temps, float* rains, float* yearTemp, float* yearRain)
 {
-	NOAA_DAY_REC    record;
-	int             i, numDays[13], numMonths[13];
-	float           tempSum[13], rainSum[13];
-	int             thismonth, lastmonth = -1;
-	time_t          ntime, firstDay, lastDay;
-	struct tm       locTime;
+	char                query[DB_SQLITE_QUERY_LENGTH_MAX];
+	SQLITE_DIRECT_ROW   row;
+	SQLITE_FIELD_ID     field;
+	int                 i, month, numDays[13], numMonths[13];
+	float               tempSum[13], rainSum[13];
 
 	memset(temps, 0, 13 * sizeof(float));
 	memset(rains, 0, 13 * sizeof(float));
@@ -2048,32 +2052,59 @@ int dbsqliteNOAAComputeNorms(float* temps, float* rains, float* yearTemp, float*
 	memset(rainSum, 0, 13 * sizeof(float));
 	*yearTemp = *yearRain = 0.0;
 
-	firstDay = noaaGetFirstUpdateDay();
-	lastDay = noaaGetLastUpdateDay();
-	if ((int)firstDay == ERROR || (int)lastDay == ERROR ||
-		(int)firstDay == 0 || (int)lastDay == 0)
+	if (noaaDB == NULL)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteNOAAComputeNorms: failed to open %s!", noaaGetDBFilename());
+		return ERROR;
+	}
+
+	// One row per (local) year and month; a missing value counts as 0 as it
+	// always has, so sum over all the days rather than AVG():
+	sprintf(query, "SELECT CAST(strftime('%%m', dateTime, 'unixepoch', 'localtime') AS INTEGER) AS 'month', "
+			"COUNT(*) AS 'days', TOTAL(meanTemp) AS 'tempSum', TOTAL(rain) AS 'rainSum' "
+			"FROM %s GROUP BY strftime('%%Y-%%m', dateTime, 'unixepoch', 'localtime')",
+			WVIEW_NOAA_TABLE);
+
+	if (dbsqliteSessionDirectQuery(noaaDB, query, TRUE) == ERROR)
 	{
 		return ERROR;
 	}
 
-	for (ntime = firstDay; ntime <= lastDay; ntime += WV_SECONDS_IN_DAY)
+	for (row = radsqlitedirectGetRow(noaaDB);
+		 row != NULL;
+		 row = radsqlitedirectGetRow(noaaDB))
 	{
-		if (dbsqliteNOAAGetDay(&record, ntime) == ERROR)
+		field = radsqlitedirectFieldGet(row, "month");
+		if (field == NULL)
+		{
+			continue;
+		}
+		month = (int)radsqliteFieldGetBigIntValue(field);
+		if (month < 1 || month > 12)
 		{
 			continue;
 		}
 
-		thismonth = wvutilsGetMonth(ntime);
-		tempSum[thismonth] += record.meanTemp;
-		rainSum[thismonth] += record.rain;
-		numDays[thismonth] ++;
-		if (thismonth != lastmonth)
+		field = radsqlitedirectFieldGet(row, "days");
+		if (field != NULL)
+		{
+			numDays[month] += (int)radsqliteFieldGetBigIntValue(field);
+		}
+		field = radsqlitedirectFieldGet(row, "tempSum");
+		if (field != NULL)
+		{
+			tempSum[month] += (float)radsqliteFieldGetDoubleValue(field);
+		}
+		field = radsqlitedirectFieldGet(row, "rainSum");
+		if (field != NULL)
 		{
-			numMonths[thismonth] ++;
+			rainSum[month] += (float)radsqliteFieldGetDoubleValue(field);
 		}
-		lastmonth = thismonth;
+		numMonths[month] ++;
 	}
 
+	radsqlitedirectReleaseResults(noaaDB);
+
 	// Now make sense of it all:
 	for (i = 1; i < 13; i++)
 	{
@@ -2098,20 +2129,14 @@ int dbsqliteNOAAComputeNorms(float* temps, float* rains, float* yearTemp, float*
 
 void dbsqliteNOAAUpdate(void)
 {
-	time_t          ntime, lastNOAARecTime, nowDay, lastInsertTime = 0;
-	struct tm       locTime;
+	time_t          ntime, lastNOAARecTime, nowDay;
 	SENSOR_STORE    sensorStore;
-	int             retVal, numrecs = 0, numNOAARecs = 0;
+	NOAA_SYNC       sync;
+	int             numrecs;
 	char            fileName[128];
 	ARCHIVE_PKT     archiveRec;
 
-	nowDay = time(NULL);
-	localtime_r(&nowDay, &locTime);
-	locTime.tm_hour = 0;
-	locTime.tm_min = 0;
-	locTime.tm_sec = 0;
-	locTime.tm_isdst = -1;
-	nowDay = mktime(&locTime);
+	nowDay = wvutilsDayStart(time(NULL));
 
 	lastNOAARecTime = noaaGetLastUpdateDay();
 	if ((int)lastNOAARecTime == 0)
@@ -2125,18 +2150,13 @@ void dbsqliteNOAAUpdate(void)
 		}
 
 		lastNOAARecTime -= WV_SECONDS_IN_DAY;
-		localtime_r(&lastNOAARecTime, &locTime);
-		locTime.tm_hour = 0;
-		locTime.tm_min = 0;
-		locTime.tm_sec = 0;
-		locTime.tm_isdst = -1;
-		lastNOAARecTime = mktime(&locTime);
+		lastNOAARecTime = wvutilsDayStart(lastNOAARecTime);
 	}
 
-	ntime = lastNOAARecTime + WV_SECONDS_IN_DAY;
+	ntime = wvutilsDayEnd(lastNOAARecTime);
 
 	// Is there any work to do?
-	if ((ntime + WV_SECONDS_IN_DAY) <= nowDay)
+	if (ntime < nowDay)
 	{
 		// yes!
 		MsgLog(PRI_STATUS, "NOAA DB: syncing %4.4d%2.2d%2.2d => %4.4d%2.2d%2.2d",
@@ -2147,39 +2167,19 @@ void dbsqliteNOAAUpdate(void)
 			wvutilsGetMonth(nowDay - WV_SECONDS_IN_DAY),
 			wvutilsGetDay(nowDay - WV_SECONDS_IN_DAY));
 
-		// Loop through all days:
-		while (ntime < nowDay)
-		{
-			// Don't create a record if we have advanced to "today":
-			if (!wvutilsTimeIsToday(ntime))
-			{
-				windAverageReset(&sensorStore.wind[STF_DAY]);
-				sensorClearSet(sensorStore.sensor[STF_DAY]);
-
-				retVal = dbsqliteHiLowGetDay(ntime, &sensorStore, STF_DAY);
-				if (retVal > 0)
-				{
-					// Write a record:
-					numrecs += retVal;
-
-					if (noaaInsertData(ntime, &sensorStore) == OK)
-					{
-						numNOAARecs++;
-						lastInsertTime = ntime;
-					}
-				}
-			}
-
-			ntime += WV_SECONDS_IN_DAY;
-		}
+		// Summarize every complete day up to (not including) today:
+		sync.sensorStore = &sensorStore;
+		sync.numNOAARecs = 0;
+		sync.lastInsertTime = 0;
+		numrecs = noaaSyncDays(ntime, nowDay, &sync);
 
 		if (numrecs > 0)
 		{
 			MsgLog(PRI_STATUS, "NOAA DB: done: %d HILOW records => %d NOAA records",
-				numrecs, numNOAARecs);
+				numrecs, sync.numNOAARecs);
 		}
 
-		if (lastInsertTime != 0)
+		if (sync.lastInsertTime != 0)
 		{
 			// sprintf( fileName, "%s/export/%s", wvutilsGetConfigPath(), WVIEW_NOAA_MARKER_FILE );
 			// wvutilsWriteMarkerFile( fileName, lastInsertTime );
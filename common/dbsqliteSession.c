@@ -0,0 +1,339 @@
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		dbsqliteSession.c
+
+  PURPOSE:
+		Provide the long-lived per-process database handles, their pragma
+		profiles, statement counters and WAL checkpoint scheduling shared
+		by the archive, HILOW, NOAA and history databases.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		Every database runs in WAL mode so htmlgend readers never block
+		the wviewd writers. Automatic checkpoints are pushed out and the
+		owning process calls dbsqliteSessionCheckpoint at a quiet moment
+		(right after archive generation) so WAL fsyncs stay off the LOOP
+		path.
+
+		Each process opens a database once through dbsqliteSessionOpen and
+		keeps the handle until exit, so SQLite parses the schema and warms
+		its page cache once instead of on every access.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+//  ... System include files
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//  ... Local include files
+#include <dbsqlite.h>
+
+//  ... global memory declarations
+
+//  ... local memory:
+
+#define SESSION_MAX                     8
+
+// WAL pages before SQLite checkpoints on its own - a backstop only:
+#define SESSION_AUTOCHECKPOINT_PAGES    4000
+
+typedef struct
+{
+	const char*         synchronous;
+	int                 cacheKiB;           // page cache per connection
+	int                 mmapBytes;          // 0 => read through the page cache
+} SESSION_PROFILE;
+
+static const SESSION_PROFILE    Profiles[] =
+{
+	{ "FULL",   4096, 16*1024*1024 },       // DBSQLITE_PROFILE_PRIMARY
+	{ "NORMAL", 2048, 8*1024*1024 },        // DBSQLITE_PROFILE_DERIVED
+	{ "OFF",    8192, 0 }                   // DBSQLITE_PROFILE_BULK
+};
+
+static struct
+{
+	SQLITE_DATABASE_ID  db;
+	const char*         name;
+	int                 owned;              // opened by dbsqliteSessionOpen
+	DBSQLITE_SESSION_STATS  stats;
+} Sessions[SESSION_MAX];
+
+static int sessionFind(SQLITE_DATABASE_ID db)
+{
+	int         i;
+
+	for (i = 0; i < SESSION_MAX; i++)
+	{
+		if (Sessions[i].db != NULL && Sessions[i].db == db)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static int sessionRegister(SQLITE_DATABASE_ID db, const char* name)
+{
+	int         i, slot = sessionFind(db);
+
+	if (slot >= 0)
+	{
+		return slot;
+	}
+
+	// prefer the slot that last held this database so its counters carry
+	// on, then one never used:
+	for (i = 0; i < SESSION_MAX; i++)
+	{
+		if (Sessions[i].db == NULL && Sessions[i].stats.name != NULL &&
+			!strcmp(Sessions[i].stats.name, name))
+		{
+			slot = i;
+			break;
+		}
+		if (slot < 0 && Sessions[i].db == NULL && Sessions[i].stats.name == NULL)
+		{
+			slot = i;
+		}
+	}
+	for (i = 0; slot < 0 && i < SESSION_MAX; i++)
+	{
+		if (Sessions[i].db == NULL)
+		{
+			slot = i;
+		}
+	}
+	if (slot < 0)
+	{
+		return -1;
+	}
+
+	if (Sessions[slot].stats.name == NULL || strcmp(Sessions[slot].stats.name, name))
+	{
+		memset(&Sessions[slot].stats, 0, sizeof(Sessions[slot].stats));
+	}
+	Sessions[slot].db = db;
+	Sessions[slot].name = name;
+	Sessions[slot].owned = FALSE;
+	Sessions[slot].stats.name = name;
+	Sessions[slot].stats.isOpen = TRUE;
+	return slot;
+}
+
+static int sessionPragma(SQLITE_DATABASE_ID db, const char* name, const char* pragma)
+{
+	char        query[DB_SQLITE_QUERY_LENGTH_MAX];
+
+	sprintf(query, "PRAGMA %s", pragma);
+	if (radsqliteQuery(db, query, FALSE) == ERROR)
+	{
+		MsgLog(PRI_MEDIUM, "dbsqliteSession: %s: %s failed", name, query);
+		return ERROR;
+	}
+
+	return OK;
+}
+
+static void sessionCount(SQLITE_DATABASE_ID db, int retVal)
+{
+	int         slot = sessionFind(db);
+
+	if (slot < 0)
+	{
+		return;
+	}
+
+	Sessions[slot].stats.statements ++;
+	if (retVal == ERROR)
+	{
+		Sessions[slot].stats.errors ++;
+		Sessions[slot].stats.lastError = time(NULL);
+	}
+}
+
+//  #####################  API Functions #####################
+
+SQLITE_DATABASE_ID dbsqliteSessionOpen
+(
+	const char*         filename,
+	const char*         name,
+	DBSQLITE_PROFILE    profile
+)
+{
+	SQLITE_DATABASE_ID  db;
+	int                 i, slot;
+
+	for (i = 0; i < SESSION_MAX; i++)
+	{
+		if (Sessions[i].db != NULL && Sessions[i].owned &&
+			!strcmp(Sessions[i].name, name))
+		{
+			return Sessions[i].db;
+		}
+	}
+
+	db = radsqliteOpen(filename);
+	if (db == NULL)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteSession: failed to open %s!", filename);
+		return NULL;
+	}
+
+	slot = sessionRegister(db, name);
+	if (slot < 0)
+	{
+		MsgLog(PRI_HIGH, "dbsqliteSession: no session slot for %s!", name);
+		radsqliteClose(db);
+		return NULL;
+	}
+
+	Sessions[slot].owned = TRUE;
+	Sessions[slot].stats.opens ++;
+	dbsqliteSessionApplyProfile(db, name, profile);
+	return db;
+}
+
+void dbsqliteSessionClose(SQLITE_DATABASE_ID db)
+{
+	if (db == NULL)
+	{
+		return;
+	}
+
+	dbsqliteSessionRelease(db);
+	radsqliteClose(db);
+}
+
+int dbsqliteSessionApplyProfile
+(
+	SQLITE_DATABASE_ID  db,
+	const char*         name,
+	DBSQLITE_PROFILE    profile
+)
+{
+	char        pragma[64];
+
+	if (db == NULL)
+	{
+		return ERROR;
+	}
+
+	if (SQLITE_VERSION_NUMBER >= 3007000)
+	{
+		sessionPragma(db, name, "journal_mode = WAL");
+		sprintf(pragma, "wal_autocheckpoint = %d", SESSION_AUTOCHECKPOINT_PAGES);
+		sessionPragma(db, name, pragma);
+	}
+
+	// negative cache_size is KiB rather than pages (3.7.10):
+	if (SQLITE_VERSION_NUMBER >= 3007010)
+	{
+		sprintf(pragma, "cache_size = -%d", Profiles[profile].cacheKiB);
+		sessionPragma(db, name, pragma);
+	}
+	if (SQLITE_VERSION_NUMBER >= 3007017)
+	{
+		sprintf(pragma, "mmap_size = %d", Profiles[profile].mmapBytes);
+		sessionPragma(db, name, pragma);
+	}
+	sessionPragma(db, name, "temp_store = MEMORY");
+
+	sprintf(pragma, "synchronous = %s", Profiles[profile].synchronous);
+	if (sessionPragma(db, name, pragma) == ERROR)
+	{
+		return ERROR;
+	}
+
+	// register for scheduled checkpoints - a BULK profile on a handle the
+	// session manager doesn't own is transient (a rebuild that may bail out
+	// and close the handle) so skip it:
+	if (profile == DBSQLITE_PROFILE_BULK)
+	{
+		return OK;
+	}
+
+	sessionRegister(db, name);
+	return OK;
+}
+
+void dbsqliteSessionRelease(SQLITE_DATABASE_ID db)
+{
+	int         slot = sessionFind(db);
+
+	if (slot >= 0)
+	{
+		// keep the counters (and the name they belong to) for the stats:
+		Sessions[slot].db = NULL;
+		Sessions[slot].name = NULL;
+		Sessions[slot].owned = FALSE;
+		Sessions[slot].stats.isOpen = FALSE;
+	}
+}
+
+int dbsqliteSessionQuery(SQLITE_DATABASE_ID db, const char* query, int createResults)
+{
+	int         retVal;
+
+	retVal = radsqliteQuery(db, (char*)query, createResults);
+	sessionCount(db, retVal);
+	return retVal;
+}
+
+int dbsqliteSessionDirectQuery(SQLITE_DATABASE_ID db, const char* query, int createResults)
+{
+	int         retVal;
+
+	retVal = radsqlitedirectQuery(db, (char*)query, createResults);
+	sessionCount(db, retVal);
+	return retVal;
+}
+
+int dbsqliteSessionGetStats(DBSQLITE_SESSION_STATS* stats, int maxStats)
+{
+	int         i, count = 0;
+
+	for (i = 0; i < SESSION_MAX && count < maxStats; i++)
+	{
+		if (Sessions[i].stats.name != NULL)
+		{
+			stats[count++] = Sessions[i].stats;
+		}
+	}
+
+	return count;
+}
+
+void dbsqliteSessionCheckpoint(void)
+{
+	int         i;
+
+	if (SQLITE_VERSION_NUMBER < 3007000)
+	{
+		return;
+	}
+
+	// PASSIVE never waits on readers; whatever it can't copy now is
+	// picked up next time
+	for (i = 0; i < SESSION_MAX; i++)
+	{
+		if (Sessions[i].db != NULL)
+		{
+			sessionPragma(Sessions[i].db, Sessions[i].name, "wal_checkpoint(PASSIVE)");
+		}
+	}
+}
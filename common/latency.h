@@ -0,0 +1,85 @@
+#ifndef INC_latencyh
+#define INC_latencyh
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		latency.h
+
+  PURPOSE:
+		Provide per-stage latency histograms for the LOOP, archive and
+		generation pipelines.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		Usage around a stage:
+			uint64_t start = latencyStart();
+			...
+			latencyStop(LATENCY_STORE_LOOP, start);
+		latencyStart returns 0 when disabled and latencyStop ignores a 0
+		start, so a disabled stage costs one flag test.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+//  ... includes
+#include <stdio.h>
+#include <stdint.h>
+
+#include <sysdefs.h>
+
+//  ... definitions
+
+typedef enum
+{
+	LATENCY_SERIAL_READ = 0,            // station reads (readWithCRC)
+	LATENCY_STORE_LOOP,                 // LOOP/LOOP2 to LOOP_PKT
+	LATENCY_REALTIME,                   // processRealTimeData
+	LATENCY_COMPUTED_SAMPLE,            // computedDataStoreSample
+	LATENCY_HILOW_SAMPLE,               // dbsqliteHiLowStoreSample
+	LATENCY_ARCHIVE_STORE,              // daemonStoreArchiveRecord
+	LATENCY_COMPUTED_UPDATE,            // computedDataUpdate
+	LATENCY_TEMPLATE,                   // one htmlgend template
+	LATENCY_STAGE_MAX
+} LATENCY_STAGE;
+
+typedef struct
+{
+	uint64_t        count;
+	uint64_t        sum;                // all times in microseconds
+	uint32_t        p50;
+	uint32_t        p99;
+	uint32_t        max;
+} LATENCY_SUMMARY;
+
+//  ... API prototypes
+
+//  ... turn recording on or off (on by default):
+extern void latencySetEnabled(int enabled);
+
+//  ... monotonic start time in ns, 0 if disabled:
+extern uint64_t latencyStart(void);
+
+//  ... record the time since 'startTime' against 'stage';
+//  ... returns it in microseconds (0 if disabled):
+extern uint32_t latencyStop(LATENCY_STAGE stage, uint64_t startTime);
+
+//  ... returns OK or ERROR if nothing was recorded for 'stage':
+extern int latencyGetSummary(LATENCY_STAGE stage, LATENCY_SUMMARY* summary);
+
+extern const char* latencyStageName(LATENCY_STAGE stage);
+
+//  ... append a line per active stage to the status file:
+extern void latencyWriteStatus(FILE* file);
+
+//  ... log every active stage (SIGUSR2):
+extern void latencyDump(void);
+
+#endif
@@ -0,0 +1,574 @@
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		metrics.c
+
+  PURPOSE:
+		Provide process counters/gauges and a local Prometheus endpoint.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		A scrape that doesn't send its request within METRICS_CLIENT_TIMEOUT
+		seconds is dropped when the next one arrives. radProcess only gives
+		us read callbacks, so sockets are non-blocking: whatever part of the
+		response the kernel won't take is parked with the client and pushed
+		from a timer every METRICS_FLUSH_INTERVAL ms. A scraper that hasn't
+		taken it all within METRICS_CLIENT_TIMEOUT seconds is cut off (and
+		logged); the event loop never waits on it.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+//  ... System header files
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+//  ... Library header files
+#include <radprocess.h>
+#include <radtimers.h>
+
+//  ... Local header files
+#include <metrics.h>
+#include <latency.h>
+#include <msglog.h>
+#include <dbsqlite.h>
+
+//  ... Local memory:
+
+#define METRICS_CLIENTS_MAX         4
+#define METRICS_REQUEST_MAX         1024
+#define METRICS_RESPONSE_INITIAL    16384
+#define METRICS_RESPONSE_MAX        (1024 * 1024)
+#define METRICS_CLIENT_TIMEOUT      5
+#define METRICS_FLUSH_INTERVAL      20              // msecs
+#define METRICS_SESSIONS_MAX        8
+
+typedef enum
+{
+	METRIC_TYPE_COUNTER,
+	METRIC_TYPE_GAUGE
+} METRIC_TYPE;
+
+typedef struct
+{
+	const char*     name;
+	const char*     help;
+	METRIC_TYPE     type;
+} METRIC_DEF;
+
+static const METRIC_DEF     MetricDefs[METRIC_MAX] =
+{
+	{ "wview_loop_packets_total", "LOOP packets received", METRIC_TYPE_COUNTER },
+	{ "wview_crc_errors_total", "Station frames with a bad CRC", METRIC_TYPE_COUNTER },
+	{ "wview_read_retries_total", "Console wakeup retries during read recovery", METRIC_TYPE_COUNTER },
+	{ "wview_archive_records_total", "Archive records stored", METRIC_TYPE_COUNTER },
+	{ "wview_archive_queue_depth", "DMPAFT records queued for storage", METRIC_TYPE_GAUGE },
+	{ "wview_sql_statements_total", "SQL statements executed on the archive and HILOW databases", METRIC_TYPE_COUNTER },
+	{ "wview_sql_seconds_total", "Time spent in archive and HILOW SQL statements", METRIC_TYPE_COUNTER },
+	{ "wview_templates_generated_total", "Templates generated", METRIC_TYPE_COUNTER },
+	{ "wview_templates_failed_total", "Templates that failed to generate", METRIC_TYPE_COUNTER },
+	{ "wview_templates_skipped_total", "Templates left alone because their output was unchanged", METRIC_TYPE_COUNTER },
+	{ "wview_realtime_rejected_total", "Realtime push connections refused", METRIC_TYPE_COUNTER }
+};
+
+static struct
+{
+	double      value;
+	int         used;
+} Metrics[METRIC_MAX];
+
+typedef struct
+{
+	int         fd;
+	int         length;
+	time_t      opened;
+	char        request[METRICS_REQUEST_MAX];
+	char*       pending;                        // response, NULL until built
+	int         pendingLength;
+	int         pendingOffset;                  // bytes the kernel has taken
+} METRICS_CLIENT;
+
+static int                  ListenFd = -1;
+static const char*          ProcName = "wview";
+static METRICS_CLIENT       Clients[METRICS_CLIENTS_MAX];
+static char*                Response;
+static int                  ResponseSize;
+static TIMER_ID             FlushTimer;
+
+static int setNonBlocking(int fd)
+{
+	int         flags = fcntl(fd, F_GETFL, 0);
+
+	if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+	{
+		return ERROR;
+	}
+
+	return OK;
+}
+
+static void closeClient(METRICS_CLIENT* client)
+{
+	radProcessIODeRegisterDescriptor(client->fd);
+	close(client->fd);
+	client->fd = -1;
+	client->length = 0;
+	free(client->pending);
+	client->pending = NULL;
+	client->pendingLength = 0;
+	client->pendingOffset = 0;
+}
+
+//  ... append to Response, growing it as needed;
+//  ... returns the new length or ERROR (and stays ERROR once it is)
+static int append(int length, const char* format, ...)
+{
+	va_list     argList;
+	char*       newResponse;
+	int         retVal, newSize;
+
+	if (length < 0)
+	{
+		return ERROR;
+	}
+
+	for (;;)
+	{
+		if (Response != NULL)
+		{
+			va_start(argList, format);
+			retVal = vsnprintf(&Response[length], ResponseSize - length, format, argList);
+			va_end(argList);
+
+			if (retVal < 0)
+			{
+				return ERROR;
+			}
+			if (length + retVal < ResponseSize)
+			{
+				return (length + retVal);
+			}
+		}
+
+		newSize = ((ResponseSize == 0) ? METRICS_RESPONSE_INITIAL : ResponseSize * 2);
+		if (newSize > METRICS_RESPONSE_MAX)
+		{
+			MsgLog(PRI_HIGH, "metrics: exposition exceeds %d bytes", METRICS_RESPONSE_MAX);
+			return ERROR;
+		}
+		newResponse = (char*)realloc(Response, newSize);
+		if (newResponse == NULL)
+		{
+			MsgLog(PRI_HIGH, "metrics: cannot grow response to %d bytes", newSize);
+			return ERROR;
+		}
+		Response = newResponse;
+		ResponseSize = newSize;
+	}
+}
+
+//  ... render the exposition text into Response; returns its length or ERROR
+static int renderMetrics(void)
+{
+	LATENCY_SUMMARY     summary;
+	LATENCY_STAGE       stage;
+	METRIC_ID           id;
+	DBSQLITE_SESSION_STATS  sessions[METRICS_SESSIONS_MAX];
+	int                 i, numSessions, length = 0, haveLatency = FALSE;
+
+	length = append(length, "# HELP wview_process_info wview process exporting these metrics\n"
+		"# TYPE wview_process_info gauge\n"
+		"wview_process_info{process=\"%s\"} 1\n", ProcName);
+
+	for (id = METRIC_LOOP_PACKETS; id < METRIC_MAX; id++)
+	{
+		if (!Metrics[id].used)
+		{
+			continue;
+		}
+
+		length = append(length, "# HELP %s %s\n# TYPE %s %s\n%s %.6f\n",
+			MetricDefs[id].name, MetricDefs[id].help,
+			MetricDefs[id].name,
+			((MetricDefs[id].type == METRIC_TYPE_COUNTER) ? "counter" : "gauge"),
+			MetricDefs[id].name, Metrics[id].value);
+	}
+
+	for (stage = LATENCY_SERIAL_READ; stage < LATENCY_STAGE_MAX; stage++)
+	{
+		if (latencyGetSummary(stage, &summary) == ERROR)
+		{
+			continue;
+		}
+
+		if (!haveLatency)
+		{
+			length = append(length, "# HELP wview_latency_seconds Pipeline stage latency\n"
+				"# TYPE wview_latency_seconds summary\n");
+			haveLatency = TRUE;
+		}
+
+		length = append(length,
+			"wview_latency_seconds{stage=\"%s\",quantile=\"0.5\"} %.6f\n"
+			"wview_latency_seconds{stage=\"%s\",quantile=\"0.99\"} %.6f\n"
+			"wview_latency_seconds{stage=\"%s\",quantile=\"1\"} %.6f\n"
+			"wview_latency_seconds_sum{stage=\"%s\"} %.6f\n"
+			"wview_latency_seconds_count{stage=\"%s\"} %llu\n",
+			latencyStageName(stage), (double)summary.p50 / 1000000.0,
+			latencyStageName(stage), (double)summary.p99 / 1000000.0,
+			latencyStageName(stage), (double)summary.max / 1000000.0,
+			latencyStageName(stage), (double)summary.sum / 1000000.0,
+			latencyStageName(stage), (unsigned long long)summary.count);
+	}
+
+	numSessions = dbsqliteSessionGetStats(sessions, METRICS_SESSIONS_MAX);
+	if (numSessions > 0)
+	{
+		length = append(length, "# HELP wview_sqlite_statements_total SQL statements run per database\n"
+			"# TYPE wview_sqlite_statements_total counter\n");
+		for (i = 0; i < numSessions; i++)
+		{
+			length = append(length, "wview_sqlite_statements_total{db=\"%s\"} %llu\n",
+				sessions[i].name, (unsigned long long)sessions[i].statements);
+		}
+		length = append(length, "# HELP wview_sqlite_errors_total Failed SQL statements per database\n"
+			"# TYPE wview_sqlite_errors_total counter\n");
+		for (i = 0; i < numSessions; i++)
+		{
+			length = append(length, "wview_sqlite_errors_total{db=\"%s\"} %llu\n",
+				sessions[i].name, (unsigned long long)sessions[i].errors);
+		}
+		length = append(length, "# HELP wview_sqlite_open Database handle is open\n"
+			"# TYPE wview_sqlite_open gauge\n");
+		for (i = 0; i < numSessions; i++)
+		{
+			length = append(length, "wview_sqlite_open{db=\"%s\"} %d\n",
+				sessions[i].name, sessions[i].isOpen);
+		}
+	}
+
+	return length;
+}
+
+//  ... push as much of the parked response as the socket takes;
+//  ... returns OK (all sent or the rest still parked) or ERROR
+static int flushPending(METRICS_CLIENT* client)
+{
+	int         retVal;
+
+	while (client->pendingOffset < client->pendingLength)
+	{
+		retVal = send(client->fd, client->pending + client->pendingOffset,
+			client->pendingLength - client->pendingOffset, MSG_NOSIGNAL);
+		if (retVal < 0)
+		{
+			return ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? OK : ERROR);
+		}
+		client->pendingOffset += retVal;
+	}
+
+	return OK;
+}
+
+static void flushTimerHandler(void* parm)
+{
+	time_t      now = time(NULL);
+	int         i, waiting = FALSE;
+
+	for (i = 0; i < METRICS_CLIENTS_MAX; i++)
+	{
+		if (Clients[i].fd < 0 || Clients[i].pending == NULL)
+		{
+			continue;
+		}
+
+		if (flushPending(&Clients[i]) == ERROR ||
+			Clients[i].pendingOffset == Clients[i].pendingLength)
+		{
+			closeClient(&Clients[i]);
+		}
+		else if ((now - Clients[i].opened) > METRICS_CLIENT_TIMEOUT)
+		{
+			MsgLog(PRI_MEDIUM, "metrics: scrape took only %d of the %d byte response in %d s",
+				Clients[i].pendingOffset, Clients[i].pendingLength, METRICS_CLIENT_TIMEOUT);
+			closeClient(&Clients[i]);
+		}
+		else
+		{
+			waiting = TRUE;
+		}
+	}
+
+	if (waiting)
+	{
+		radTimerStart(FlushTimer, METRICS_FLUSH_INTERVAL);
+	}
+}
+
+//  ... build the response for 'client' and send what the socket takes now;
+//  ... the rest is left for flushTimerHandler
+static void respond(METRICS_CLIENT* client)
+{
+	static const char   notFound[] = "HTTP/1.0 404 Not Found\r\n"
+		"Content-Length: 0\r\nConnection: close\r\n\r\n";
+	static const char   failed[] = "HTTP/1.0 500 Internal Server Error\r\n"
+		"Content-Length: 0\r\nConnection: close\r\n\r\n";
+	char                header[256];
+	const char*         body = NULL;
+	int                 length = 0, headerLength;
+
+	if (strncmp(client->request, "GET /metrics", 12) && strncmp(client->request, "GET / ", 6))
+	{
+		headerLength = sprintf(header, "%s", notFound);
+	}
+	else if ((length = renderMetrics()) == ERROR)
+	{
+		length = 0;
+		headerLength = sprintf(header, "%s", failed);
+	}
+	else
+	{
+		body = Response;
+		headerLength = sprintf(header, "HTTP/1.0 200 OK\r\n"
+			"Content-Type: text/plain; version=0.0.4\r\n"
+			"Content-Length: %d\r\nConnection: close\r\n\r\n", length);
+	}
+
+	client->pending = (char*)malloc(headerLength + length);
+	if (client->pending == NULL)
+	{
+		MsgLog(PRI_HIGH, "metrics: cannot allocate a %d byte response", headerLength + length);
+		closeClient(client);
+		return;
+	}
+	memcpy(client->pending, header, headerLength);
+	if (body != NULL)
+	{
+		memcpy(client->pending + headerLength, body, length);
+	}
+	client->pendingLength = headerLength + length;
+	client->pendingOffset = 0;
+
+	if (flushPending(client) == ERROR || client->pendingOffset == client->pendingLength)
+	{
+		closeClient(client);
+		return;
+	}
+
+	radTimerStart(FlushTimer, METRICS_FLUSH_INTERVAL);
+}
+
+static void clientCallback(int fd, void* userData)
+{
+	METRICS_CLIENT*     client = (METRICS_CLIENT*)userData;
+	char                discard[256];
+	int                 retVal;
+
+	if (client->pending != NULL)
+	{
+		// already answering - only watch for the scraper going away
+		retVal = read(fd, discard, sizeof(discard));
+		if (retVal == 0 || (retVal < 0 && errno != EAGAIN && errno != EINTR))
+		{
+			closeClient(client);
+		}
+		return;
+	}
+
+	retVal = read(fd, &client->request[client->length],
+		METRICS_REQUEST_MAX - 1 - client->length);
+	if (retVal < 0 && (errno == EAGAIN || errno == EINTR))
+	{
+		return;
+	}
+	if (retVal <= 0)
+	{
+		closeClient(client);
+		return;
+	}
+
+	client->length += retVal;
+	client->request[client->length] = 0;
+
+	// the request line is all we care about, wait for the end of headers:
+	if (strstr(client->request, "\r\n\r\n") == NULL &&
+		strstr(client->request, "\n\n") == NULL &&
+		client->length < METRICS_REQUEST_MAX - 1)
+	{
+		return;
+	}
+
+	respond(client);
+}
+
+static void acceptCallback(int fd, void* userData)
+{
+	METRICS_CLIENT*     client = NULL;
+	time_t              now = time(NULL);
+	int                 newFd, i;
+
+	newFd = accept(fd, NULL, NULL);
+	if (newFd < 0)
+	{
+		return;
+	}
+
+	for (i = 0; i < METRICS_CLIENTS_MAX; i++)
+	{
+		if (Clients[i].fd >= 0 && (now - Clients[i].opened) > METRICS_CLIENT_TIMEOUT)
+		{
+			closeClient(&Clients[i]);
+		}
+		if (client == NULL && Clients[i].fd < 0)
+		{
+			client = &Clients[i];
+		}
+	}
+
+	if (client == NULL || setNonBlocking(newFd) == ERROR)
+	{
+		close(newFd);
+		return;
+	}
+
+	client->fd = newFd;
+	client->length = 0;
+	client->opened = now;
+	client->pending = NULL;
+	client->pendingLength = 0;
+	client->pendingOffset = 0;
+	if (radProcessIORegisterDescriptor(newFd, clientCallback, client) == ERROR)
+	{
+		close(newFd);
+		client->fd = -1;
+	}
+}
+
+//  ... API methods:
+
+int metricsInit(const char* procName, int port)
+{
+	struct sockaddr_in  addr;
+	int                 i, on = 1;
+
+	ProcName = procName;
+	for (i = 0; i < METRICS_CLIENTS_MAX; i++)
+	{
+		Clients[i].fd = -1;
+	}
+
+	if (port <= 0)
+	{
+		return OK;
+	}
+
+	ListenFd = socket(AF_INET, SOCK_STREAM, 0);
+	if (ListenFd < 0)
+	{
+		MsgLog(PRI_HIGH, "metricsInit: socket failed: %s", strerror(errno));
+		return ERROR;
+	}
+
+	setsockopt(ListenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((uint16_t)port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (bind(ListenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+		listen(ListenFd, METRICS_CLIENTS_MAX) < 0 ||
+		setNonBlocking(ListenFd) == ERROR)
+	{
+		MsgLog(PRI_HIGH, "metricsInit: cannot listen on 127.0.0.1:%d: %s",
+			port, strerror(errno));
+		close(ListenFd);
+		ListenFd = -1;
+		return ERROR;
+	}
+
+	FlushTimer = radTimerCreate(NULL, flushTimerHandler, NULL);
+	if (FlushTimer == NULL)
+	{
+		MsgLog(PRI_HIGH, "metricsInit: radTimerCreate failed");
+		close(ListenFd);
+		ListenFd = -1;
+		return ERROR;
+	}
+
+	if (radProcessIORegisterDescriptor(ListenFd, acceptCallback, NULL) == ERROR)
+	{
+		MsgLog(PRI_HIGH, "metricsInit: radProcessIORegisterDescriptor failed");
+		radTimerDelete(FlushTimer);
+		FlushTimer = NULL;
+		close(ListenFd);
+		ListenFd = -1;
+		return ERROR;
+	}
+
+	MsgLog(PRI_STATUS, "metrics: serving http://127.0.0.1:%d/metrics", port);
+	return OK;
+}
+
+void metricsExit(void)
+{
+	int         i;
+
+	if (ListenFd < 0)
+	{
+		return;
+	}
+
+	for (i = 0; i < METRICS_CLIENTS_MAX; i++)
+	{
+		if (Clients[i].fd >= 0)
+		{
+			closeClient(&Clients[i]);
+		}
+	}
+
+	radProcessIODeRegisterDescriptor(ListenFd);
+	close(ListenFd);
+	ListenFd = -1;
+
+	radTimerDelete(FlushTimer);
+	FlushTimer = NULL;
+
+	free(Response);
+	Response = NULL;
+	ResponseSize = 0;
+}
+
+void metricsAdd(METRIC_ID id, double value)
+{
+	if (id < METRIC_MAX)
+	{
+		Metrics[id].value += value;
+		Metrics[id].used = TRUE;
+	}
+}
+
+void metricsSet(METRIC_ID id, double value)
+{
+	if (id < METRIC_MAX)
+	{
+		Metrics[id].value = value;
+		Metrics[id].used = TRUE;
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef INC_metricsh
+#define INC_metricsh
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		metrics.h
+
+  PURPOSE:
+		Provide process counters/gauges and a local Prometheus endpoint.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		The endpoint is plain HTTP on 127.0.0.1 served from the radProcessWait
+		loop: sockets are non-blocking and each scrape is one request, one
+		response, close. Only metrics the process has touched are exported,
+		plus the latency histograms as summaries.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+//  ... includes
+#include <stdio.h>
+#include <stdint.h>
+
+#include <sysdefs.h>
+
+//  ... definitions
+
+typedef enum
+{
+	METRIC_LOOP_PACKETS = 0,
+	METRIC_CRC_ERRORS,
+	METRIC_READ_RETRIES,
+	METRIC_ARCHIVE_RECORDS,
+	METRIC_ARCHIVE_QUEUE_DEPTH,
+	METRIC_SQL_STATEMENTS,
+	METRIC_SQL_SECONDS,
+	METRIC_TEMPLATES_GENERATED,
+	METRIC_TEMPLATES_FAILED,
+	METRIC_TEMPLATES_SKIPPED,
+	METRIC_REALTIME_REJECTED,
+	METRIC_MAX
+} METRIC_ID;
+
+//  ... API prototypes
+
+//  ... start serving on 127.0.0.1:'port' (0 disables);
+//  ... returns OK or ERROR
+extern int metricsInit(const char* procName, int port);
+
+extern void metricsExit(void);
+
+//  ... counters:
+extern void metricsAdd(METRIC_ID id, double value);
+
+//  ... gauges:
+extern void metricsSet(METRIC_ID id, double value);
+
+#endif
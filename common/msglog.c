@@ -1,4 +1,3 @@
-
 /*      ... OS include files
 */
 #include <stdio.h>
@@ -6,6 +5,14 @@
 #include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <msglog.h>
 
 /*      ... Local include files
@@ -21,83 +28,164 @@
 */
 static int      msTimestamp = 0;
 
+/*  ... Messages are formatted by the caller into a slot of a bounded
+    ... multi-producer ring (per-slot sequence numbers, no locks) and a
+    ... background thread hands them to syslog, so a slow syslog daemon
+    ... never stalls the station state machine. MsgLogData copies the raw
+    ... bytes and the hex dump is formatted by the drain thread.
+    ... The producer side only uses atomics and write() on a self-pipe to
+    ... wake the drainer, so MsgLog stays safe to call from a signal
+    ... handler; the drainer itself runs with every signal blocked.
+*/
+#define MSGLOG_RING_SLOTS       128                 /* power of 2 */
+#define MSGLOG_TEXT_MAX         512
+#define MSGLOG_DATA_CHUNK       256                 /* multiple of 16 */
+#define MSGLOG_IDLE_WAIT_MS     100
 
-/*  ... for use in system wide initialization ONLY
+/*  ... per call site (format string) rate limit applied by the drainer
 */
-int MsgLogInit
-(
-	char        *procName,
-	int         useStderr,      /* T/F: also write to stderr */
-	int         timeStamp       /* T/F: include millisecond timestamps */
-)
+#define MSGLOG_RATE_SITES       64
+#define MSGLOG_RATE_WINDOW      10                  /* seconds */
+#define MSGLOG_RATE_MAX         20                  /* messages per window */
+
+typedef struct
 {
-	int         options;
+	uint32_t        sequence;
+	int             priority;
+	const char      *site;
+	int             dataLength;                     /* > 0: binary dump chunk */
+	char            text[MSGLOG_TEXT_MAX];
+} LOG_SLOT;
 
-	msTimestamp = timeStamp;
+typedef struct
+{
+	const char      *site;
+	time_t          windowStart;
+	int             count;
+	int             suppressed;
+} LOG_SITE;
 
-	options = LOG_NDELAY | LOG_PID;
-	if (useStderr)
-	{
-		options |= LOG_PERROR;
-	}
+static LOG_SLOT         logRing[MSGLOG_RING_SLOTS];
+static uint32_t         enqueuePos;
+static uint32_t         dequeuePos;
+static uint32_t         dropCount;
+static LOG_SITE         logSites[MSGLOG_RATE_SITES];
 
-	openlog(procName, options, LOG_USER);
+static pthread_t        drainThread;
+static int              wakePipe[2] = { -1, -1 };
+static int              asyncWanted = 0;
+static int              asyncStarting = 0;
+static int              asyncRunning = 0;
+static int              asyncStop = 0;
+static int              atForkDone = 0;
 
-	return OK;
-}
 
+static void resetRing(void)
+{
+	uint32_t        i;
 
-int MsgLogExit
-(
-	void
-)
+	for (i = 0; i < MSGLOG_RING_SLOTS; i++)
+	{
+		logRing[i].sequence = i;
+	}
+	enqueuePos = 0;
+	dequeuePos = 0;
+	dropCount = 0;
+}
+
+/*  ... claim a slot; returns NULL (and counts a drop) if the ring is full
+*/
+static LOG_SLOT *claimSlot(uint32_t *claimedPos)
 {
-	closelog();
+	LOG_SLOT        *slot;
+	uint32_t        pos, seq;
+	int32_t         diff;
 
-	return OK;
+	pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+	for (;;)
+	{
+		slot = &logRing[pos & (MSGLOG_RING_SLOTS - 1)];
+		seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+		diff = (int32_t)(seq - pos);
+		if (diff == 0)
+		{
+			if (__atomic_compare_exchange_n(&enqueuePos, &pos, pos + 1, 1,
+											__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				*claimedPos = pos;
+				return slot;
+			}
+		}
+		else if (diff < 0)
+		{
+			__atomic_add_fetch(&dropCount, 1, __ATOMIC_RELAXED);
+			return NULL;
+		}
+		else
+		{
+			pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+		}
+	}
 }
 
-/*  ... log a message - allow variable length parameter list
+/*  ... write() is async-signal-safe; a full pipe already has a wakeup
+    ... pending, and a lost one only costs the drainer's idle wait
 */
-int MsgLog
-(
-	int         priority,
-	char        *format,
-	...
-)
+static void wakeDrainer(void)
 {
-	va_list     argList;
-	char        temp1[512];
-	int         index;
+	int         savedErrno = errno;
 
-	if (msTimestamp)
+	if (wakePipe[1] >= 0)
 	{
-		index = sprintf(temp1, "<%llu> : ", radTimeGetMSSinceEpoch());
+		if (write(wakePipe[1], "", 1) < 0)
+		{
+			/*  ... EAGAIN: already signalled
+			*/
+		}
 	}
-	else
+	errno = savedErrno;
+}
+
+static void closeWakePipe(void)
+{
+	if (wakePipe[0] >= 0)
 	{
-		index = 0;
+		close(wakePipe[0]);
+		close(wakePipe[1]);
 	}
+	wakePipe[0] = wakePipe[1] = -1;
+}
 
-	/*  ... print the var arg stuff to the message
-	*/
-	va_start(argList, format);
-	vsprintf(&temp1[index], format, argList);
-	va_end(argList);
+static int openWakePipe(void)
+{
+	int         i;
 
-	syslog(priority, temp1);
+	if (pipe(wakePipe) != 0)
+	{
+		wakePipe[0] = wakePipe[1] = -1;
+		return ERROR;
+	}
 
+	for (i = 0; i < 2; i++)
+	{
+		fcntl(wakePipe[i], F_SETFL, fcntl(wakePipe[i], F_GETFL, 0) | O_NONBLOCK);
+		fcntl(wakePipe[i], F_SETFD, FD_CLOEXEC);
+	}
 	return OK;
 }
 
-void MsgLogData(void *data, int length)
+static void publishSlot(LOG_SLOT *slot, uint32_t pos)
+{
+	__atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+	wakeDrainer();
+}
+
+static void writeData(int priority, unsigned char *ptr, int length)
 {
 	char        msg[256], temp[16], temp1[16], ascii[128];
 	int         i, j;
-	UCHAR       *ptr = (UCHAR *)data;
 	int         dataPresent = 1;
 
-	MsgLog(PRI_STATUS, "DBG: Dumping %p, %d bytes:", data, length);
 	memset(msg, 0, sizeof(msg));
 	memset(ascii, 0, sizeof(ascii));
 
@@ -117,7 +205,7 @@ void MsgLogData(void *data, int length)
 			// we need to dump a line
 			strcat(msg, "    ");
 			strcat(msg, ascii);
-			MsgLog(PRI_STATUS, msg);
+			syslog(priority, "%s", msg);
 			memset(msg, 0, sizeof(msg));
 			memset(ascii, 0, sizeof(ascii));
 			dataPresent = 0;
@@ -138,7 +226,419 @@ void MsgLogData(void *data, int length)
 		}
 		strcat(msg, "    ");
 		strcat(msg, ascii);
-		MsgLog(PRI_STATUS, msg);
+		syslog(priority, "%s", msg);
+	}
+
+	return;
+}
+
+/*  ... returns TRUE if this call site is over its rate
+*/
+static int rateLimited(LOG_SLOT *slot)
+{
+	LOG_SITE        *site;
+	time_t          now;
+	int             i, index = -1, oldest = 0;
+
+	if (slot->site == NULL || slot->priority == PRI_CATASTROPHIC)
+	{
+		return 0;
+	}
+
+	for (i = 0; i < MSGLOG_RATE_SITES; i++)
+	{
+		if (logSites[i].site == slot->site || logSites[i].site == NULL)
+		{
+			index = i;
+			break;
+		}
+		if (logSites[i].windowStart < logSites[oldest].windowStart)
+		{
+			oldest = i;
+		}
+	}
+	if (index < 0)
+	{
+		index = oldest;
+		memset(&logSites[index], 0, sizeof(LOG_SITE));
+	}
+
+	site = &logSites[index];
+	now = time(NULL);
+	if (site->site != slot->site || (now - site->windowStart) >= MSGLOG_RATE_WINDOW)
+	{
+		if (site->site == slot->site && site->suppressed > 0)
+		{
+			syslog(LOG_WARNING, "MsgLog: suppressed %d messages like \"%.64s\"",
+				   site->suppressed, site->site);
+		}
+		site->site = slot->site;
+		site->windowStart = now;
+		site->count = 0;
+		site->suppressed = 0;
+	}
+
+	if (++site->count > MSGLOG_RATE_MAX)
+	{
+		site->suppressed ++;
+		return 1;
+	}
+
+	return 0;
+}
+
+/*  ... hand every published slot to syslog (single consumer);
+    ... returns the number of slots written
+*/
+static int drainRing(void)
+{
+	LOG_SLOT        *slot;
+	uint32_t        pos, seq, drops;
+	int             count = 0;
+
+	drops = __atomic_exchange_n(&dropCount, 0, __ATOMIC_RELAXED);
+	if (drops > 0)
+	{
+		syslog(LOG_WARNING, "MsgLog: log ring overflow, %u messages dropped", drops);
+	}
+
+	for (;;)
+	{
+		pos = __atomic_load_n(&dequeuePos, __ATOMIC_RELAXED);
+		slot = &logRing[pos & (MSGLOG_RING_SLOTS - 1)];
+		seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+		if ((int32_t)(seq - (pos + 1)) < 0)
+		{
+			return count;
+		}
+
+		if (slot->dataLength > 0)
+		{
+			writeData(slot->priority, (unsigned char *)slot->text, slot->dataLength);
+		}
+		else if (!rateLimited(slot))
+		{
+			syslog(slot->priority, "%s", slot->text);
+		}
+
+		__atomic_store_n(&slot->sequence, pos + MSGLOG_RING_SLOTS, __ATOMIC_RELEASE);
+		__atomic_store_n(&dequeuePos, pos + 1, __ATOMIC_RELEASE);
+		count ++;
+	}
+}
+
+static void *drainMain(void *arg)
+{
+	struct pollfd       wake;
+	char                bytes[64];
+
+	wake.fd = wakePipe[0];
+	wake.events = POLLIN;
+
+	for (;;)
+	{
+		if (drainRing() > 0)
+		{
+			continue;
+		}
+		if (__atomic_load_n(&asyncStop, __ATOMIC_ACQUIRE))
+		{
+			break;
+		}
+
+		if (poll(&wake, 1, MSGLOG_IDLE_WAIT_MS) > 0)
+		{
+			while (read(wakePipe[0], bytes, sizeof(bytes)) > 0)
+			{
+			}
+		}
+	}
+
+	drainRing();
+	return NULL;
+}
+
+/*  ... the drain thread does not survive fork (radlib daemonizes after
+    ... MsgLogInit) - the child starts its own on its first message
+*/
+static void atForkChild(void)
+{
+	asyncRunning = 0;
+	asyncStarting = 0;
+	asyncStop = 0;
+	resetRing();
+
+	/*  ... the pipe is shared with the parent's drainer, get our own
+	*/
+	closeWakePipe();
+}
+
+/*  ... only the caller that wins asyncStarting creates the thread, the
+    ... rest log synchronously until it is up
+*/
+static int startDrainer(void)
+{
+	sigset_t    allSignals, oldSignals;
+	int         expected = 0, retVal;
+
+	if (!__atomic_compare_exchange_n(&asyncStarting, &expected, 1, 0,
+									 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+	{
+		return OK;
+	}
+
+	asyncStop = 0;
+	if (openWakePipe() == ERROR)
+	{
+		asyncWanted = 0;
+		return ERROR;
+	}
+
+	/*  ... the thread inherits our mask: keep signals on the main thread
+	    ... so handlers never run on (and log from) the drainer
+	*/
+	sigfillset(&allSignals);
+	pthread_sigmask(SIG_SETMASK, &allSignals, &oldSignals);
+	retVal = pthread_create(&drainThread, NULL, drainMain, NULL);
+	pthread_sigmask(SIG_SETMASK, &oldSignals, NULL);
+
+	if (retVal != 0)
+	{
+		/*  ... stay synchronous
+		*/
+		closeWakePipe();
+		asyncWanted = 0;
+		return ERROR;
+	}
+
+	__atomic_store_n(&asyncRunning, 1, __ATOMIC_RELEASE);
+	return OK;
+}
+
+static void flushAtExit(void)
+{
+	MsgLogFlush();
+}
+
+/*  ... wait (bounded) until everything queued before the call is written
+*/
+static void waitForDrain(uint32_t pos)
+{
+	struct timespec     delay = { 0, 1000000L };
+	int                 retries = 500;
+
+	while (retries-- > 0 &&
+		   (int32_t)(__atomic_load_n(&dequeuePos, __ATOMIC_ACQUIRE) - pos) <= 0)
+	{
+		wakeDrainer();
+		nanosleep(&delay, NULL);
+	}
+}
+
+/*  ... format into a slot, or straight to syslog when not running async
+*/
+static int logMessage(int priority, const char *site, const char *format, va_list argList)
+{
+	LOG_SLOT        *slot;
+	uint32_t        pos;
+	char            temp1[MSGLOG_TEXT_MAX];
+	char            *dest;
+	int             index;
+
+	if (asyncWanted && !__atomic_load_n(&asyncRunning, __ATOMIC_ACQUIRE))
+	{
+		startDrainer();
+	}
+
+	slot = NULL;
+	if (__atomic_load_n(&asyncRunning, __ATOMIC_ACQUIRE))
+	{
+		slot = claimSlot(&pos);
+		if (slot == NULL)
+		{
+			return ERROR;
+		}
+		dest = slot->text;
+	}
+	else
+	{
+		dest = temp1;
+	}
+
+	if (msTimestamp)
+	{
+		index = sprintf(dest, "<%llu> : ", radTimeGetMSSinceEpoch());
+	}
+	else
+	{
+		index = 0;
+	}
+
+	/*  ... print the var arg stuff to the message
+	*/
+	vsnprintf(&dest[index], MSGLOG_TEXT_MAX - index, format, argList);
+
+	if (slot == NULL)
+	{
+		syslog(priority, "%s", dest);
+		return OK;
+	}
+
+	slot->priority = priority;
+	slot->site = site;
+	slot->dataLength = 0;
+	publishSlot(slot, pos);
+
+	/*  ... a catastrophic message is usually followed by exit or abort
+	*/
+	if (priority == PRI_CATASTROPHIC)
+	{
+		waitForDrain(pos);
+	}
+
+	return OK;
+}
+
+
+/*  ... for use in system wide initialization ONLY
+*/
+int MsgLogInit
+(
+	char        *procName,
+	int         useStderr,      /* T/F: also write to stderr */
+	int         timeStamp       /* T/F: include millisecond timestamps */
+)
+{
+	int         options;
+
+	msTimestamp = timeStamp;
+
+	options = LOG_NDELAY | LOG_PID;
+	if (useStderr)
+	{
+		options |= LOG_PERROR;
+	}
+
+	openlog(procName, options, LOG_USER);
+
+	if (!atForkDone)
+	{
+		resetRing();
+		pthread_atfork(NULL, NULL, atForkChild);
+		atexit(flushAtExit);
+		atForkDone = 1;
+	}
+
+	/*  ... the drain thread starts with the first message
+	*/
+	asyncWanted = 1;
+
+	return OK;
+}
+
+
+int MsgLogExit
+(
+	void
+)
+{
+	if (asyncRunning)
+	{
+		__atomic_store_n(&asyncStop, 1, __ATOMIC_RELEASE);
+		wakeDrainer();
+		pthread_join(drainThread, NULL);
+		asyncRunning = 0;
+		closeWakePipe();
+	}
+	asyncStarting = 0;
+	asyncWanted = 0;
+
+	closelog();
+
+	return OK;
+}
+
+/*  ... write out everything queued so far
+*/
+void MsgLogFlush
+(
+	void
+)
+{
+	if (asyncRunning)
+	{
+		waitForDrain(__atomic_load_n(&enqueuePos, __ATOMIC_ACQUIRE) - 1);
+	}
+	else if (atForkDone)
+	{
+		drainRing();
+	}
+}
+
+/*  ... log a message - allow variable length parameter list
+*/
+int MsgLog
+(
+	int         priority,
+	char        *format,
+	...
+)
+{
+	va_list     argList;
+	int         retVal;
+
+	va_start(argList, format);
+	retVal = logMessage(priority, format, format, argList);
+	va_end(argList);
+
+	return retVal;
+}
+
+int MsgLogV
+(
+	int         priority,
+	const char  *format,
+	va_list     argList
+)
+{
+	return logMessage(priority, format, format, argList);
+}
+
+void MsgLogData(void *data, int length)
+{
+	LOG_SLOT    *slot;
+	uint32_t    pos;
+	int         offset, chunk;
+
+	MsgLog(PRI_STATUS, "DBG: Dumping %p, %d bytes:", data, length);
+
+	if (!asyncRunning)
+	{
+		writeData(PRI_STATUS, (unsigned char *)data, length);
+		return;
+	}
+
+	/*  ... queue the raw bytes, the drainer formats the lines
+	*/
+	for (offset = 0; offset < length; offset += chunk)
+	{
+		chunk = length - offset;
+		if (chunk > MSGLOG_DATA_CHUNK)
+		{
+			chunk = MSGLOG_DATA_CHUNK;
+		}
+
+		slot = claimSlot(&pos);
+		if (slot == NULL)
+		{
+			return;
+		}
+
+		memcpy(slot->text, (unsigned char *)data + offset, chunk);
+		slot->priority = PRI_STATUS;
+		slot->site = NULL;
+		slot->dataLength = chunk;
+		publishSlot(slot, pos);
 	}
 
 	return;
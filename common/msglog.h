@@ -47,6 +47,7 @@ extern "C" {
 	----------------------------------------------------------------------------*/
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <syslog.h>
 
 #include <radsysdefs.h>
@@ -85,6 +86,23 @@ extern "C" {
 		...
 	);
 
+	/*  ... va_list flavor for wrappers (the format is the rate limit key)
+	*/
+	extern int MsgLogV
+	(
+		int         priority,
+		const char  *format,
+		va_list     argList
+	);
+
+	/*  ... MsgLog queues to a background writer; wait (bounded) for what
+	    ... is queued to reach syslog
+	*/
+	extern void MsgLogFlush
+	(
+		void
+	);
+
 	extern void MsgLogData
 	(
 		void        *data,
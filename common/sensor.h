@@ -109,6 +109,10 @@ extern void sensorAddSample(WV_SENSOR* sensor, WV_SENSOR* sample, int doDebug);
 // -- operations on sets of sensors --
 // propogate a new data sample to the current interval
 // assumes input of type "set[SENSOR_MAX]"
+// Sets stay in WV_SENSOR (array of structs) form: SENSOR_STORE is read
+// field by field throughout wviewd and htmlgend and is the HILOW message
+// payload, so transposing to per-field arrays for the fold costs as much
+// as it saves.
 extern void sensorPropogateSample(WV_SENSOR* set, WV_SENSOR* sample);
 
 // clear sensors for a SENSOR_MAX array
@@ -29,13 +29,19 @@
 //  ... Local memory:
 
 static STATUS_INFO          ProcessStatus;
+static int                  StatusDirty;
+static time_t               StatusLastWrite;
 
+//  ... write the whole file to a temp name and rename it into place so
+//  ... readers never see a partial file
 static int WriteStatusFile(void)
 {
 	FILE*       statfile;
 	int         index;
+	char        tempPath[_MAX_PATH + 8];
 
-	statfile = fopen(ProcessStatus.filePath, "w");
+	sprintf(tempPath, "%s.tmp", ProcessStatus.filePath);
+	statfile = fopen(tempPath, "w");
 	if (statfile == NULL)
 	{
 		MsgLog(PRI_HIGH, "status file create failed!");
@@ -60,10 +66,35 @@ static int WriteStatusFile(void)
 		fprintf(statfile, "stat%d = %d\n", index, ProcessStatus.stat[index]);
 	}
 
-	fclose(statfile);
+	latencyWriteStatus(statfile);
+
+	if (fclose(statfile) != 0 || rename(tempPath, ProcessStatus.filePath) != 0)
+	{
+		MsgLog(PRI_HIGH, "status file write failed!");
+		unlink(tempPath);
+		return ERROR;
+	}
+
+	StatusDirty = FALSE;
+	StatusLastWrite = time(NULL);
 	return OK;
 }
 
+//  ... stat counters only mark the status dirty; the file is rewritten at
+//  ... most once per STATUS_FLUSH_INTERVAL (or by statusFlush)
+static int CoalesceStatusFile(void)
+{
+	time_t      now = time(NULL);
+
+	StatusDirty = TRUE;
+	if (now >= StatusLastWrite && (now - StatusLastWrite) < STATUS_FLUSH_INTERVAL)
+	{
+		return OK;
+	}
+
+	return WriteStatusFile();
+}
+
 //  ... API methods:
 
 //  ... initialize the status log:
@@ -98,6 +129,8 @@ int statusInit(const char* filePath, char* statLabel[4])
 	}
 
 	memset(&ProcessStatus, 0, sizeof(ProcessStatus));
+	StatusDirty = FALSE;
+	StatusLastWrite = 0;
 	wvstrncpy(ProcessStatus.filePath, filePath, _MAX_PATH);
 
 	for (index = 0; index < STATUS_STATS_MAX; index++)
@@ -144,7 +177,7 @@ int statusUpdateStat(int index, int value)
 	}
 
 	ProcessStatus.stat[index] = value;
-	WriteStatusFile();
+	CoalesceStatusFile();
 	return OK;
 }
 
@@ -158,7 +191,7 @@ int statusIncrementStat(int index)
 	}
 
 	ProcessStatus.stat[index] ++;
-	WriteStatusFile();
+	CoalesceStatusFile();
 	return OK;
 }
 
@@ -173,6 +206,17 @@ int statusDecrementStat(int index)
 	}
 
 	ProcessStatus.stat[index] --;
-	WriteStatusFile();
+	CoalesceStatusFile();
 	return OK;
-}
\ No newline at end of file
+}
+
+//  ... write out any coalesced stat changes:
+int statusFlush(void)
+{
+	if (!StatusDirty)
+	{
+		return OK;
+	}
+
+	return WriteStatusFile();
+}
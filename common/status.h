@@ -36,11 +36,16 @@
 
 #include <sysdefs.h>
 #include <services.h>
+#include <latency.h>
 
 //  ... definitions
 
 #define STATUS_STATS_MAX        4
 
+// stat changes reach the status file at most this often (secs); status
+// and message changes are always written at once:
+#define STATUS_FLUSH_INTERVAL   10
+
 typedef enum
 {
 	STATUS_NOT_STARTED = 0,
@@ -79,4 +84,7 @@ extern int statusIncrementStat(int index);
 // Does not allow the value to be negative:
 extern int statusDecrementStat(int index);
 
+//  ... write out stat changes still held back by the flush interval:
+extern int statusFlush(void);
+
 #endif
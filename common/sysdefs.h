@@ -29,6 +29,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "config.h"
 #ifdef HAVE_STDINT_H
@@ -72,7 +73,8 @@
 
 #define WVIEW_HILOW_DATABASE        "wview-hilow.sdb"
 #define WVIEW_HILOW_META_TABLE      "metainfo"
-#define WVIEW_HILOW_WINDDIR_TABLE   "windDir"
+#define WVIEW_HILOW_WINDDIR_TABLE   "windDir"           // pre-hilowHour layout
+#define WVIEW_HILOW_HOUR_TABLE      "hilowHour"
 #define WVIEW_HILOW_MARKER_FILE     "hilow_marker"
 
 #define WVIEW_NOAA_DATABASE         "wview-noaa.sdb"
@@ -349,6 +351,18 @@ extern int wvutilsGetHour(time_t ntime);
 extern int wvutilsGetMin(time_t ntime);
 extern int wvutilsGetSec(time_t ntime);
 
+// Cached local time: civil time and bucket boundaries for the few local days
+// in use are computed from the day's midnight without localtime/mktime;
+// days with a DST/offset change fall back to the libc calls.
+// The cache is dropped by wvutilsDetectDSTChange when it sees a change.
+extern void   wvutilsLocalTime(time_t ntime, struct tm* locTime);
+extern time_t wvutilsHourStart(time_t ntime);
+extern time_t wvutilsDayStart(time_t ntime);
+extern time_t wvutilsDayEnd(time_t ntime);          // start of the next day
+extern time_t wvutilsMonthStart(time_t ntime);
+extern time_t wvutilsRainSeasonStart(time_t ntime, int startMonth);
+extern void   wvutilsTimeInvalidate(void);
+
 extern int wvutilsTimeIsToday(time_t checkTime);
 
 //  Determine if it is day or night
@@ -22,95 +22,257 @@
 
 //  ... System header files
 #include <errno.h>
+#include <fcntl.h>
 #include <msglog.h>
 
 //  ... Local header files
 #include <wvconfig.h>
 
 //  ... Local memory:
-static SQLITE_DATABASE_ID   sqliteID;
+
+//  ... The config table is read once into an open-addressed hash table and
+//  ... served from memory; each wvconfigInit compares the database file
+//  ... signature and reloads only when it has changed.
+typedef struct
+{
+	char*       name;
+	char*       value;
+} CONFIG_ENTRY;
+
+typedef struct
+{
+	time_t      mtime;
+	off_t       size;
+	ino_t       inode;
+	uint32_t    changeCounter;                      // sqlite header offset 24
+	time_t      walMtime;
+	off_t       walSize;
+} CONFIG_SIGNATURE;
+
+static CONFIG_ENTRY*        configTable;
+static int                  configTableSize;            // power of 2
+static CONFIG_SIGNATURE     configSignature;
+static char                 configPath[_MAX_PATH];
 
 //  ... Define a semaphore for access control:
 static SEM_ID               wvconfigMutex;
 
 //  ... Local methods
 
-// Query for a parameter value - it is converted to the proper format later:
-static int queryParmValue(const char* configItem, char* valueStore)
+static unsigned int hashName(const char* name)
 {
-	char                    query[DB_SQLITE_QUERY_LENGTH_MAX];
-	SQLITE_RESULT_SET_ID    result;
-	SQLITE_ROW_ID           rowDescr;
-	SQLITE_FIELD_ID         field;
+	unsigned int            hash = 2166136261U;
 
-	if (sqliteID == NULL)
+	while (*name)
 	{
-		MsgLog(PRI_HIGH, "queryParmValue: sqliteID is NULL!");
-		return ERROR;
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619U;
 	}
 
-	sprintf(query, "SELECT value FROM config WHERE name = '%s'", configItem);
+	return hash;
+}
 
-	if (radsqliteQuery(sqliteID, query, TRUE) == ERROR)
+static void getSignature(CONFIG_SIGNATURE* sig)
+{
+	char                    walPath[_MAX_PATH + 8];
+	struct stat             fileData;
+	unsigned char           counter[4];
+	int                     fd;
+
+	memset(sig, 0, sizeof(*sig));
+	if (stat(configPath, &fileData) == 0)
 	{
-		MsgLog(PRI_MEDIUM,
-			"queryParmValue: radsqliteQuery %s failed!", configItem);
-		return ERROR;
+		sig->mtime = fileData.st_mtime;
+		sig->size  = fileData.st_size;
+		sig->inode = fileData.st_ino;
+	}
+
+	// mtime has 1 second resolution and updates rarely change the size;
+	// every rollback-journal commit bumps the header change counter:
+	fd = open(configPath, O_RDONLY);
+	if (fd >= 0)
+	{
+		if (pread(fd, counter, sizeof(counter), 24) == sizeof(counter))
+		{
+			sig->changeCounter = ((uint32_t)counter[0] << 24) | ((uint32_t)counter[1] << 16) |
+				((uint32_t)counter[2] << 8) | (uint32_t)counter[3];
+		}
+		close(fd);
+	}
+
+	// a writer in WAL mode doesn't touch the main file until checkpoint:
+	sprintf(walPath, "%s-wal", configPath);
+	if (stat(walPath, &fileData) == 0)
+	{
+		sig->walMtime = fileData.st_mtime;
+		sig->walSize  = fileData.st_size;
+	}
+}
+
+static void freeSnapshot(CONFIG_ENTRY* table, int size)
+{
+	int                     i;
+
+	for (i = 0; i < size; i++)
+	{
+		free(table[i].name);
+		free(table[i].value);
 	}
+	free(table);
+}
+
+static CONFIG_ENTRY* findEntry(CONFIG_ENTRY* table, int size, const char* name)
+{
+	unsigned int            slot;
+
+	slot = hashName(name) & (size - 1);
+	while (table[slot].name != NULL)
+	{
+		if (!strcmp(table[slot].name, name))
+		{
+			break;
+		}
+		slot = (slot + 1) & (size - 1);
+	}
+
+	return &table[slot];
+}
 
-	result = radsqliteGetResults(sqliteID);
-	if (result == NULL)
+// Read the whole config table into a new snapshot:
+static int loadSnapshot(void)
+{
+	SQLITE_DATABASE_ID      sqliteID;
+	SQLITE_DIRECT_ROW       rowDescr;
+	SQLITE_FIELD_ID         nameField, valueField;
+	CONFIG_ENTRY*           table;
+	CONFIG_ENTRY*           entry;
+	int                     size = 256, count = 0;
+
+	sqliteID = radsqliteOpen((const char*)configPath);
+	if (sqliteID == NULL)
 	{
-		MsgLog(PRI_MEDIUM,
-			"queryParmValue: radsqliteGetResults failed!");
+		MsgLog(PRI_CATASTROPHIC, "wvconfigInit: radsqliteOpen %s failed!",
+			configPath);
 		return ERROR;
 	}
 
-	// We have a result, return it to the caller:
-	rowDescr = radsqliteResultsGetFirst(result);
-	if (rowDescr == NULL)
+	if (radsqlitedirectQuery(sqliteID, "SELECT name,value FROM config", TRUE) == ERROR)
 	{
-		MsgLog(PRI_MEDIUM,
-			"queryParmValue: radsqliteResultsGetFirst failed!");
-		radsqliteReleaseResults(sqliteID, result);
+		MsgLog(PRI_HIGH, "wvconfigInit: config query failed!");
+		radsqliteClose(sqliteID);
 		return ERROR;
 	}
 
-	field = radsqliteFieldGet(rowDescr, configCOLUMN_VALUE);
-	if (field == NULL)
+	table = (CONFIG_ENTRY*)calloc(size, sizeof(CONFIG_ENTRY));
+	if (table == NULL)
 	{
-		MsgLog(PRI_MEDIUM,
-			"queryParmValue: radsqliteFieldGet failed!");
-		radsqliteReleaseResults(sqliteID, result);
+		radsqlitedirectReleaseResults(sqliteID);
+		radsqliteClose(sqliteID);
 		return ERROR;
 	}
 
-	memcpy(valueStore,
-		radsqliteFieldGetCharValue(field),
-		radsqliteFieldGetCharLength(field));
-	valueStore[radsqliteFieldGetCharLength(field)] = 0;
+	for (rowDescr = radsqlitedirectGetRow(sqliteID);
+		rowDescr != NULL;
+		rowDescr = radsqlitedirectGetRow(sqliteID))
+	{
+		nameField = radsqlitedirectFieldGet(rowDescr, configCOLUMN_NAME);
+		valueField = radsqlitedirectFieldGet(rowDescr, configCOLUMN_VALUE);
+		if (nameField == NULL || valueField == NULL ||
+			FIELD_IS_NULL(nameField) || FIELD_IS_NULL(valueField))
+		{
+			continue;
+		}
+
+		// keep the load factor under 1/2 - the table is sized for a
+		// stock config so this is rare:
+		if ((count + 1) * 2 > size)
+		{
+			CONFIG_ENTRY*   bigger = (CONFIG_ENTRY*)calloc(size * 2, sizeof(CONFIG_ENTRY));
+			int             i;
+
+			if (bigger == NULL)
+			{
+				break;
+			}
+			for (i = 0; i < size; i++)
+			{
+				if (table[i].name != NULL)
+				{
+					*findEntry(bigger, size * 2, table[i].name) = table[i];
+				}
+			}
+			free(table);
+			table = bigger;
+			size *= 2;
+		}
+
+		entry = findEntry(table, size, radsqliteFieldGetCharValue(nameField));
+		if (entry->name != NULL)
+		{
+			// duplicate name, the first row wins as with the old lookup:
+			continue;
+		}
+		entry->name = strdup(radsqliteFieldGetCharValue(nameField));
+		entry->value = strdup(radsqliteFieldGetCharValue(valueField));
+		if (entry->name == NULL || entry->value == NULL)
+		{
+			free(entry->name);
+			free(entry->value);
+			entry->name = entry->value = NULL;
+			continue;
+		}
+		count ++;
+	}
 
-	// Clean up:
-	radsqliteReleaseResults(sqliteID, result);
+	radsqlitedirectReleaseResults(sqliteID);
+	radsqliteClose(sqliteID);
 
+	if (configTable != NULL)
+	{
+		freeSnapshot(configTable, configTableSize);
+	}
+	configTable = table;
+	configTableSize = size;
 	return OK;
 }
 
+// Look up a parameter value - it is converted to the proper format later:
+static const char* queryParmValue(const char* configItem)
+{
+	CONFIG_ENTRY*           entry;
+
+	if (configTable == NULL)
+	{
+		MsgLog(PRI_HIGH, "queryParmValue: config is not loaded!");
+		return NULL;
+	}
+
+	entry = findEntry(configTable, configTableSize, configItem);
+	if (entry->name == NULL)
+	{
+		MsgLog(PRI_MEDIUM, "queryParmValue: %s not found!", configItem);
+		return NULL;
+	}
+
+	return entry->value;
+}
+
 //  ... API (public) methods
 
-//  wvconfigInit: Open the configuration database for this process:
+//  wvconfigInit: Attach to the wview configuration API and make sure the
+//  snapshot matches the database (the semaphore is held only while checking):
 int wvconfigInit(int firstProcess)
 {
-	char            buffer[_MAX_PATH];
-	struct stat     fileData;
+	CONFIG_SIGNATURE    signature;
+	struct stat         fileData;
 
 	// Make sure our config db is there:
-	sprintf(buffer, "%s/%s", WVIEW_CONFIG_DIR, WVIEW_CONFIG_DATABASE);
-	if (stat(buffer, &fileData) != 0)
+	sprintf(configPath, "%s/%s", WVIEW_CONFIG_DIR, WVIEW_CONFIG_DATABASE);
+	if (stat(configPath, &fileData) != 0)
 	{
 		MsgLog(PRI_CATASTROPHIC,
 			"Cannot locate config database %s - aborting!",
-			buffer);
+			configPath);
 		return ERROR;
 	}
 
@@ -133,29 +295,26 @@ int wvconfigInit(int firstProcess)
 	// Lock for serial access:
 	radSemTake(wvconfigMutex);
 
-	sqliteID = radsqliteOpen((const char*)buffer);
-	if (sqliteID == NULL)
+	getSignature(&signature);
+	if (configTable == NULL || memcmp(&signature, &configSignature, sizeof(signature)))
 	{
-		MsgLog(PRI_CATASTROPHIC, "wvconfigInit: radsqliteOpen %s failed!",
-			buffer);
-		radSemGive(wvconfigMutex);
-		radSemDelete(wvconfigMutex);
-		return ERROR;
+		if (loadSnapshot() == ERROR)
+		{
+			radSemGive(wvconfigMutex);
+			radSemDelete(wvconfigMutex);
+			return ERROR;
+		}
+		memcpy(&configSignature, &signature, sizeof(signature));
 	}
 
+	radSemGive(wvconfigMutex);
 	return OK;
 }
 
-//  wvconfigExit: clean up and detach from the wview configuration API
+//  wvconfigExit: detach from the wview configuration API (the snapshot is
+//  kept for the next session)
 void wvconfigExit(void)
 {
-	if (sqliteID != NULL)
-	{
-		radsqliteClose(sqliteID);
-		sqliteID = NULL;
-	}
-
-	radSemGive(wvconfigMutex);
 	radSemDelete(wvconfigMutex);
 }
 
@@ -163,28 +322,28 @@ void wvconfigExit(void)
 //  Returns: integer value or 0
 int wvconfigGetINTValue(const char* configItem)
 {
-	char        buffer[_MAX_PATH];
+	const char* value = queryParmValue(configItem);
 
-	if (queryParmValue(configItem, buffer) == ERROR)
+	if (value == NULL)
 	{
 		return 0;
 	}
 
-	return (atoi(buffer));
+	return (atoi(value));
 }
 
 //  wvconfigGetDOUBLEValue: retrieve the double value for this parameter;
 //  Returns: double value
 double wvconfigGetDOUBLEValue(const char* configItem)
 {
-	char        buffer[_MAX_PATH];
+	const char* value = queryParmValue(configItem);
 
-	if (queryParmValue(configItem, buffer) == ERROR)
+	if (value == NULL)
 	{
 		return 0.0;
 	}
 
-	return ((double)atof(buffer));
+	return ((double)atof(value));
 }
 
 //  wvconfigGetStringValue: retrieve the string value for this parameter
@@ -192,12 +351,15 @@ double wvconfigGetDOUBLEValue(const char* configItem)
 const char* wvconfigGetStringValue(const char* configItem)
 {
 	static char     buffer[_MAX_PATH];
+	const char*     value = queryParmValue(configItem);
 
-	if (queryParmValue(configItem, buffer) == ERROR)
+	if (value == NULL)
 	{
 		return NULL;
 	}
 
+	// callers copy from here, and a later wvconfigInit may reload:
+	wvstrncpy(buffer, value, _MAX_PATH);
 	return buffer;
 }
 
@@ -205,9 +367,9 @@ const char* wvconfigGetStringValue(const char* configItem)
 //  Returns: TRUE or FALSE
 int wvconfigGetBooleanValue(const char* configItem)
 {
-	char        buffer[_MAX_PATH];
+	const char* buffer = queryParmValue(configItem);
 
-	if (queryParmValue(configItem, buffer) == ERROR)
+	if (buffer == NULL)
 	{
 		return ERROR;
 	}
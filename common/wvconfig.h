@@ -52,6 +52,13 @@
 #define configItem_ENABLE_HTMLGEN                               "ENABLE_HTMLGEN"
 
 #define configItem_ENABLE_EMAIL                                 "ENABLE_EMAIL_ALERTS"
+#define configItem_ENABLE_LATENCY_STATS                         "ENABLE_LATENCY_STATS"
+#define configItem_WVIEWD_METRICS_PORT                          "WVIEWD_METRICS_PORT"
+#define configItem_HTMLGEN_METRICS_PORT                         "HTMLGEN_METRICS_PORT"
+#define configItem_WVIEWD_REALTIME_PORT                         "WVIEWD_REALTIME_PORT"
+#define configItem_WVIEWD_REALTIME_KEYFRAME                     "WVIEWD_REALTIME_KEYFRAME_INTERVAL"
+#define configItem_WVIEWD_REALTIME_CBOR                         "WVIEWD_REALTIME_CBOR"
+#define configItem_WVIEWD_REALTIME_CLIENTS                      "WVIEWD_REALTIME_MAX_CLIENTS"
 #define configItem_TO_EMAIL_ADDRESS                             "EMAIL_ADDRESS"
 #define configItem_FROM_EMAIL_ADDRESS                           "FROM_EMAIL_ADDRESS"
 #define configItem_SEND_TEST_EMAIL                              "SEND_TEST_EMAIL"
@@ -79,7 +86,10 @@
 #define configItem_STATION_PUSH_INTERVAL                        "STATION_PUSH_INTERVAL"
 #define configItem_STATION_VERBOSE_MSGS                         "STATION_VERBOSE_MSGS"
 #define configItem_STATION_DO_RXCHECK                           "STATION_DO_RCHECK"
+#define configItem_STATION_LOOP_STREAM                         "STATION_LOOP_STREAM"
 #define configItem_STATION_OUTSIDE_CHANNEL                      "STATION_OUTSIDE_CHANNEL"
+#define configItem_STATION_CAPTURE_FILE                         "STATION_CAPTURE_FILE"
+#define configItem_STATION_REPLAY_SPEED                         "STATION_REPLAY_SPEED"
 
 #define configItem_HTMLGEN_STATION_NAME                         "HTMLGEN_STATION_NAME"
 #define configItem_HTMLGEN_STATION_CITY                         "HTMLGEN_STATION_CITY"
@@ -101,6 +111,7 @@
 #define configItem_HTMLGEN_LOCAL_RADAR_URL                      "HTMLGEN_LOCAL_RADAR_URL"
 #define configItem_HTMLGEN_LOCAL_FORECAST_URL                   "HTMLGEN_LOCAL_FORECAST_URL"
 #define configItem_HTMLGEN_DATE_FORMAT                          "HTMLGEN_DATE_FORMAT"
+#define configItem_HTMLGEN_PRECOMPRESS                          "HTMLGEN_PRECOMPRESS"
 
 #define configItemCAL_MULT_BAROMETER                            "CAL_MULT_BAROMETER"
 #define configItemCAL_CONST_BAROMETER                           "CAL_CONST_BAROMETER"
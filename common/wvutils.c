@@ -122,7 +122,6 @@ int wvutilsToggleVerbosity(void)
 void wvutilsLogEvent(int priority, char* format, ...)
 {
 	va_list     argList;
-	char        temp1[RADMSGLOG_MAX_LENGTH + 64];
 
 	if ((DaemonMask & VerboseMask) == 0)
 	{
@@ -130,12 +129,10 @@ void wvutilsLogEvent(int priority, char* format, ...)
 	}
 	else
 	{
-		// print the var arg stuff to the buffer
+		// formatted by MsgLog (keyed on the caller's format):
 		va_start(argList, format);
-		vsprintf(temp1, format, argList);
+		MsgLogV(priority, format, argList);
 		va_end(argList);
-
-		MsgLog(priority, temp1);
 	}
 
 	return;
@@ -1121,45 +1118,248 @@ time_t wvutilsGetYearStartTime(int archiveInterval)
 	return ntime;
 }
 
+//  ... Local day cache: every timestamp the daemons handle lands in one of a
+//  ... few local days (today, yesterday, the day being backfilled). For a
+//  ... day without a DST/offset change the civil time is pure arithmetic off
+//  ... its midnight; transition days go through localtime_r/mktime as before.
+//  ... Not thread safe - the wview processes are single threaded.
+#define WV_TIME_CACHE_DAYS      4
+
+typedef struct
+{
+	time_t          dayStart;
+	time_t          dayEnd;                 // start of the next local day
+	time_t          monthStart;             // 0 until first asked for
+	struct tm       midnight;               // broken down dayStart
+	int             isTransition;           // offset changes during the day
+	int             valid;
+} WV_TIME_DAY;
+
+static WV_TIME_DAY  timeDays[WV_TIME_CACHE_DAYS];
+static int          timeDayNext;
+static struct
+{
+	int             startMonth;
+	int             year;
+	time_t          start;
+} timeSeason;
+
+static WV_TIME_DAY* timeGetDay(time_t ntime)
+{
+	WV_TIME_DAY*    day;
+	struct tm       bknTime, endTime;
+	int             i;
+
+	for (i = 0; i < WV_TIME_CACHE_DAYS; i++)
+	{
+		if (timeDays[i].valid &&
+			timeDays[i].dayStart <= ntime && ntime < timeDays[i].dayEnd)
+		{
+			return &timeDays[i];
+		}
+	}
+
+	day = &timeDays[timeDayNext];
+	timeDayNext = (timeDayNext + 1) % WV_TIME_CACHE_DAYS;
+
+	localtime_r(&ntime, &bknTime);
+	bknTime.tm_hour = 0;
+	bknTime.tm_min = 0;
+	bknTime.tm_sec = 0;
+	bknTime.tm_isdst = -1;
+	endTime = bknTime;
+	day->dayStart = mktime(&bknTime);
+	endTime.tm_mday++;
+	day->dayEnd = mktime(&endTime);
+	localtime_r(&day->dayStart, &day->midnight);
+
+	// a midnight that doesn't exist (offset change at 00:00) normalizes past
+	// ntime, so don't cache that day at all
+	if (day->dayStart > ntime || day->dayEnd <= ntime)
+	{
+		day->valid = FALSE;
+		return NULL;
+	}
+
+	day->isTransition = ((day->dayEnd - day->dayStart) != WV_SECONDS_IN_DAY ||
+						 endTime.tm_gmtoff != day->midnight.tm_gmtoff);
+	day->monthStart = 0;
+	day->valid = TRUE;
+	return day;
+}
+
+void wvutilsTimeInvalidate(void)
+{
+	memset(timeDays, 0, sizeof(timeDays));
+	timeDayNext = 0;
+	timeSeason.startMonth = 0;
+}
+
+void wvutilsLocalTime(time_t ntime, struct tm* locTime)
+{
+	WV_TIME_DAY*    day = timeGetDay(ntime);
+	int             secs;
+
+	if (day == NULL || day->isTransition)
+	{
+		localtime_r(&ntime, locTime);
+		return;
+	}
+
+	secs = (int)(ntime - day->dayStart);
+	*locTime = day->midnight;
+	locTime->tm_hour = secs / WV_SECONDS_IN_HOUR;
+	locTime->tm_min = (secs % WV_SECONDS_IN_HOUR) / 60;
+	locTime->tm_sec = secs % 60;
+}
+
+time_t wvutilsHourStart(time_t ntime)
+{
+	WV_TIME_DAY*    day = timeGetDay(ntime);
+	struct tm       bknTime;
+
+	if (day == NULL || day->isTransition)
+	{
+		localtime_r(&ntime, &bknTime);
+		bknTime.tm_min = 0;
+		bknTime.tm_sec = 0;
+		bknTime.tm_isdst = -1;
+		return mktime(&bknTime);
+	}
+
+	return (ntime - ((ntime - day->dayStart) % WV_SECONDS_IN_HOUR));
+}
+
+time_t wvutilsDayStart(time_t ntime)
+{
+	WV_TIME_DAY*    day = timeGetDay(ntime);
+	struct tm       bknTime;
+
+	if (day == NULL)
+	{
+		localtime_r(&ntime, &bknTime);
+		bknTime.tm_hour = 0;
+		bknTime.tm_min = 0;
+		bknTime.tm_sec = 0;
+		bknTime.tm_isdst = -1;
+		return mktime(&bknTime);
+	}
+
+	return day->dayStart;
+}
+
+time_t wvutilsDayEnd(time_t ntime)
+{
+	WV_TIME_DAY*    day = timeGetDay(ntime);
+	struct tm       bknTime;
+
+	if (day == NULL)
+	{
+		localtime_r(&ntime, &bknTime);
+		bknTime.tm_mday++;
+		bknTime.tm_hour = 0;
+		bknTime.tm_min = 0;
+		bknTime.tm_sec = 0;
+		bknTime.tm_isdst = -1;
+		return mktime(&bknTime);
+	}
+
+	return day->dayEnd;
+}
+
+time_t wvutilsMonthStart(time_t ntime)
+{
+	WV_TIME_DAY*    day = timeGetDay(ntime);
+	struct tm       bknTime;
+
+	if (day != NULL && day->monthStart != 0)
+	{
+		return day->monthStart;
+	}
+
+	localtime_r(&ntime, &bknTime);
+	bknTime.tm_mday = 1;
+	bknTime.tm_hour = 0;
+	bknTime.tm_min = 0;
+	bknTime.tm_sec = 0;
+	bknTime.tm_isdst = -1;
+	if (day == NULL)
+	{
+		return mktime(&bknTime);
+	}
+
+	day->monthStart = mktime(&bknTime);
+	return day->monthStart;
+}
+
+time_t wvutilsRainSeasonStart(time_t ntime, int startMonth)
+{
+	struct tm       bknTime;
+	int             year;
+
+	wvutilsLocalTime(ntime, &bknTime);
+	year = bknTime.tm_year + 1900;
+	if (startMonth > (bknTime.tm_mon + 1))
+	{
+		// we need to go back a year...
+		year--;
+	}
+
+	if (timeSeason.startMonth == startMonth && timeSeason.year == year)
+	{
+		return timeSeason.start;
+	}
+
+	memset(&bknTime, 0, sizeof(bknTime));
+	bknTime.tm_year = year - 1900;
+	bknTime.tm_mon = startMonth - 1;
+	bknTime.tm_mday = 1;
+	bknTime.tm_isdst = -1;
+	timeSeason.start = mktime(&bknTime);
+	timeSeason.startMonth = startMonth;
+	timeSeason.year = year;
+	return timeSeason.start;
+}
+
 int wvutilsGetYear(time_t ntime)
 {
 	struct tm       locTime;
-	localtime_r(&ntime, &locTime);
+	wvutilsLocalTime(ntime, &locTime);
 	return (locTime.tm_year + 1900);
 }
 
 int wvutilsGetMonth(time_t ntime)
 {
 	struct tm       locTime;
-	localtime_r(&ntime, &locTime);
+	wvutilsLocalTime(ntime, &locTime);
 	return (locTime.tm_mon + 1);
 }
 
 int wvutilsGetDay(time_t ntime)
 {
 	struct tm       locTime;
-	localtime_r(&ntime, &locTime);
+	wvutilsLocalTime(ntime, &locTime);
 	return (locTime.tm_mday);
 }
 
 int wvutilsGetHour(time_t ntime)
 {
 	struct tm       locTime;
-	localtime_r(&ntime, &locTime);
+	wvutilsLocalTime(ntime, &locTime);
 	return (locTime.tm_hour);
 }
 
 int wvutilsGetMin(time_t ntime)
 {
 	struct tm       locTime;
-	localtime_r(&ntime, &locTime);
+	wvutilsLocalTime(ntime, &locTime);
 	return (locTime.tm_min);
 }
 
 int wvutilsGetSec(time_t ntime)
 {
 	struct tm       locTime;
-	localtime_r(&ntime, &locTime);
+	wvutilsLocalTime(ntime, &locTime);
 	return (locTime.tm_sec);
 }
 
@@ -1327,6 +1527,7 @@ int wvutilsDetectDSTChange(void)
 		}
 
 		lastDSTState = tmtime.tm_isdst;
+		wvutilsTimeInvalidate();
 		return retVal;
 	}
 	else
@@ -138,6 +138,8 @@ static int htmlSysExit(HTML_WORK* work)
 {
 	struct stat     fileData;
 
+	metricsExit();
+
 	/*  ... delete our pid file
 	*/
 	if (stat(work->pidFile, &fileData) == 0)
@@ -168,6 +170,12 @@ static void defaultSigHandler(int signum)
 		radProcessSignalCatch(signum, defaultSigHandler);
 		break;
 
+	case SIGUSR2:
+		// dump the template latency histogram:
+		latencyDump();
+		radProcessSignalCatch(signum, defaultSigHandler);
+		break;
+
 	case SIGBUS:
 	case SIGFPE:
 	case SIGSEGV:
@@ -282,6 +290,10 @@ static void timerHandler(void* parm)
 
 	radStatesProcess(htmlWork.stateMachine, &stim);
 
+	// generation is done - fold the WALs back in:
+	dbsqliteSessionCheckpoint();
+	statusFlush();
+
 	return;
 }
 
@@ -304,6 +316,7 @@ modificado, chamar diretamente db update
 static void noaaTimerHandler(void* parm)
 {
 	dbsqliteNOAAUpdate();
+	dbsqliteSessionCheckpoint();
 	return;
 }
 
@@ -407,6 +420,20 @@ int main(int argc, char* argv[])
 		exit(1);
 	}
 
+	// latency histograms stay on unless turned off:
+	iValue = wvconfigGetBooleanValue(configItem_ENABLE_LATENCY_STATS);
+	if (iValue >= 0)
+	{
+		latencySetEnabled(iValue);
+	}
+
+	// local Prometheus endpoint, off unless a port is given:
+	iValue = wvconfigGetINTValue(configItem_HTMLGEN_METRICS_PORT);
+	if (iValue > 0)
+	{
+		metricsInit(PROC_NAME_HTML, iValue);
+	}
+
 	// get the wview verbosity setting
 	if (wvutilsSetVerbosity(WV_VERBOSE_HTMLGEND) == ERROR)
 	{
@@ -690,6 +717,10 @@ int main(int argc, char* argv[])
 		MsgLog(PRI_STATUS, "DB value not recognized: using mph as default wind units");
 	}
 
+	// Write .gz (1) or .gz and .br (2) siblings for nginx gzip_static?
+	iValue = wvconfigGetINTValue(configItem_HTMLGEN_PRECOMPRESS);
+	htmlWork.precompress = ((iValue > 0) ? iValue : HTML_PRECOMPRESS_NONE);
+
 	wvconfigExit();
 
 	if (statusInit(htmlWork.statusFile, htmlStatusLabels) == ERROR)
@@ -704,6 +735,7 @@ int main(int argc, char* argv[])
 
 	// ... Initialize the generator:
 	htmlGenerateInit();
+	htmlGenerateSetPrecompress(htmlWork.precompress);
 
 	// ... Initialize the state machine:
 	htmlWork.stateMachine = radStatesInit(&htmlWork);
@@ -889,6 +921,7 @@ int main(int argc, char* argv[])
 
 	dbsqliteHiLowExit();
 	dbsqliteNOAAExit();
+	dbsqliteHistoryExit();
 	dbsqliteArchiveExit();
 	htmlSysExit(&htmlWork);
 
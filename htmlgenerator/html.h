@@ -55,6 +55,8 @@
 #include <datadefs.h>
 #include <services.h>
 #include <status.h>
+#include <latency.h>
+#include <metrics.h>
 #include <htmlMgr.h>
 
 /*  !!!!!!!!!!!!!!!!!!  HIDDEN, NOT FOR API USE  !!!!!!!!!!!!!!!!!!
@@ -113,6 +115,7 @@ typedef struct
 	int             exiting;
 	char            dateFormat[WVIEW_STRING1_SIZE];
 	int             isDualUnits;
+	int             precompress;
 } HTML_WORK;
 
 typedef enum
@@ -32,6 +32,7 @@
 /*  ... System include files
 */
 #include <termios.h>
+#include <zlib.h>
 
 
 /*  ... Local include files
@@ -40,6 +41,11 @@
 #include <html.h>
 #include <radtextsearch.h>
 
+// HAVE_BROTLI_ENCODE_H comes from config.h (through sysdefs.h):
+#ifdef HAVE_BROTLI_ENCODE_H
+#include <brotli/encode.h>
+#endif
+
 /*  ... global memory declarations
 */
 
@@ -48,10 +54,20 @@
 
 /*  ... static (local) memory declarations
 */
-#define _DEBUG_GENERATION                   FALSE
 
 static TEXT_SEARCH_ID   tagSearchEngine;
 
+// precompressed siblings: one deflate context reset per file, and a
+// scratch buffer that only ever grows
+static int              precompressMode = HTML_PRECOMPRESS_NONE;
+static int              gzipReady;
+static z_stream         gzipStream;
+static unsigned char*   compressBuffer;
+static size_t           compressBufferSize;
+
+// createOutFile: the output matched the last generation and was left alone
+#define OUTFILE_UNCHANGED       1
+
 // Note: sample width cannot be less than 10 degrees!
 #define WR_SAMPLE_WIDTH_DAY             20
 #define WR_SAMPLE_WIDTH_WEEK            30
@@ -2553,19 +2569,233 @@ static int replaceDataTags(HTML_MGR_ID id, char* oldline, char* newline)
 	return FALSE;
 }
 
-static int createOutFile(HTML_MGR_ID id, char* templatefile, uint64_t startTime)
+//  ... write 'data' to 'path' via a temp file so readers never see a
+//  ... partial file
+static int replaceFile(const char* path, const void* data, size_t length)
+{
+	char        tempName[WVIEW_STRING2_SIZE + 8];
+	FILE*       file;
+
+	sprintf(tempName, "%s.tmp", path);
+	file = fopen(tempName, "w");
+	if (file == NULL)
+	{
+		MsgLog(PRI_MEDIUM, "createOutFile: cannot open %s for writing!", tempName);
+		return ERROR;
+	}
+
+	if (length > 0 && fwrite(data, 1, length, file) != length)
+	{
+		MsgLog(PRI_MEDIUM, "createOutFile: write to %s failed!", tempName);
+		fclose(file);
+		unlink(tempName);
+		return ERROR;
+	}
+	fclose(file);
+
+	if (rename(tempName, path) != 0)
+	{
+		unlink(tempName);
+		return ERROR;
+	}
+	return OK;
+}
+
+static int growCompressBuffer(size_t size)
+{
+	unsigned char*  newBuffer;
+
+	if (size <= compressBufferSize)
+	{
+		return OK;
+	}
+
+	newBuffer = (unsigned char*)realloc(compressBuffer, size);
+	if (newBuffer == NULL)
+	{
+		return ERROR;
+	}
+	compressBuffer = newBuffer;
+	compressBufferSize = size;
+	return OK;
+}
+
+static int writeGzipFile(const char* path, const char* data, size_t length)
+{
+	if (!gzipReady)
+	{
+		// windowBits 15 + 16: gzip header and trailer
+		if (deflateInit2(&gzipStream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16,
+						 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			MsgLog(PRI_HIGH, "createOutFile: deflateInit2 failed!");
+			return ERROR;
+		}
+		gzipReady = TRUE;
+	}
+	else
+	{
+		deflateReset(&gzipStream);
+	}
+
+	if (growCompressBuffer(deflateBound(&gzipStream, length)) == ERROR)
+	{
+		return ERROR;
+	}
+
+	gzipStream.next_in = (Bytef*)data;
+	gzipStream.avail_in = (uInt)length;
+	gzipStream.next_out = compressBuffer;
+	gzipStream.avail_out = (uInt)compressBufferSize;
+	if (deflate(&gzipStream, Z_FINISH) != Z_STREAM_END)
+	{
+		MsgLog(PRI_MEDIUM, "createOutFile: deflate failed for %s", path);
+		return ERROR;
+	}
+
+	return replaceFile(path, compressBuffer, gzipStream.total_out);
+}
+
+#ifdef HAVE_BROTLI_ENCODE_H
+static int writeBrotliFile(const char* path, const char* data, size_t length)
+{
+	size_t      outLength = BrotliEncoderMaxCompressedSize(length);
+
+	if (outLength == 0 || growCompressBuffer(outLength) == ERROR)
+	{
+		return ERROR;
+	}
+
+	if (!BrotliEncoderCompress(9, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+							   length, (const uint8_t*)data,
+							   &outLength, compressBuffer))
+	{
+		MsgLog(PRI_MEDIUM, "createOutFile: brotli failed for %s", path);
+		return ERROR;
+	}
+
+	return replaceFile(path, compressBuffer, outLength);
+}
+
+static int brotliEnabled(void)
+{
+	return (precompressMode >= HTML_PRECOMPRESS_BROTLI);
+}
+#else
+static int writeBrotliFile(const char* path, const char* data, size_t length)
+{
+	return ERROR;
+}
+
+static int brotliEnabled(void)
+{
+	return FALSE;
+}
+#endif
+
+//  ... FNV-1a, to tell whether the output changed since last time
+static uint64_t contentHash(const char* data, size_t length)
+{
+	uint64_t    hash = 0xCBF29CE484222325ULL;
+	size_t      i;
+
+	for (i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)data[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+//  ... the output and the siblings it should have are all on disk
+static int outputsPresent(const char* fname)
+{
+	char            compressedName[WVIEW_STRING2_SIZE + 4];
+	struct stat     fileStatus;
+
+	if (stat(fname, &fileStatus) != 0)
+	{
+		return FALSE;
+	}
+
+	if (precompressMode != HTML_PRECOMPRESS_NONE)
+	{
+		sprintf(compressedName, "%s.gz", fname);
+		if (stat(compressedName, &fileStatus) != 0)
+		{
+			return FALSE;
+		}
+	}
+
+	if (brotliEnabled())
+	{
+		sprintf(compressedName, "%s.br", fname);
+		if (stat(compressedName, &fileStatus) != 0)
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+//  ... bring the siblings in line with the output just written: a sibling
+//  ... that fails to compress is removed rather than left behind with old
+//  ... content, and with 'removeStale' so is one the mode no longer writes
+//  ... (precompression turned off or lowered since it was made)
+static int writeCompressedFiles(const char* fname, const char* data, size_t length, int removeStale)
+{
+	char            compressedName[WVIEW_STRING2_SIZE + 4];
+	int             retVal = OK;
+
+	sprintf(compressedName, "%s.gz", fname);
+	if (precompressMode != HTML_PRECOMPRESS_NONE)
+	{
+		if (writeGzipFile(compressedName, data, length) == ERROR)
+		{
+			unlink(compressedName);
+			retVal = ERROR;
+		}
+	}
+	else if (removeStale)
+	{
+		unlink(compressedName);
+	}
+
+	sprintf(compressedName, "%s.br", fname);
+	if (brotliEnabled())
+	{
+		if (writeBrotliFile(compressedName, data, length) == ERROR)
+		{
+			unlink(compressedName);
+			retVal = ERROR;
+		}
+	}
+	else if (removeStale)
+	{
+		unlink(compressedName);
+	}
+
+	return retVal;
+}
+
+static int createOutFile(HTML_MGR_ID id, HTML_TMPL* tmpl, uint64_t startTime)
 {
 	FILE*        infile, *outfile, *incfile;
 	char*        ptr;
+	char*        buffer = NULL;
+	size_t      bufferSize = 0;
 	char        oldfname[WVIEW_STRING2_SIZE];
 	char        newfname[WVIEW_STRING2_SIZE];
 	char        includefname[WVIEW_STRING2_SIZE];
 	char        line[HTML_MAX_LINE_LENGTH], newline[HTML_MAX_LINE_LENGTH];
+	uint64_t    hash;
+	int         removeStale;
 
-	sprintf(oldfname, "%s/%s", id->htmlPath, templatefile);
+	sprintf(oldfname, "%s/%s", id->htmlPath, tmpl->fname);
 
 	// non-home page template
-	sprintf(newfname, "%s/%s", id->imagePath, templatefile);
+	sprintf(newfname, "%s/%s", id->imagePath, tmpl->fname);
 
 	// fix the extension
 	ptr = strrchr(newfname, '.');
@@ -2580,10 +2810,11 @@ static int createOutFile(HTML_MGR_ID id, char* templatefile, uint64_t startTime)
 		return ERROR;
 	}
 
-	outfile = fopen(newfname, "w");
+	//  ... render into memory, the file (and any siblings) are written at once
+	outfile = open_memstream(&buffer, &bufferSize);
 	if (outfile == NULL)
 	{
-		MsgLog(PRI_MEDIUM, "createOutFile: cannot open %s for writing!",
+		MsgLog(PRI_MEDIUM, "createOutFile: open_memstream failed for %s!",
 			newfname);
 		fclose(infile);
 		return ERROR;
@@ -2591,7 +2822,7 @@ static int createOutFile(HTML_MGR_ID id, char* templatefile, uint64_t startTime)
 
 	//  ... now read each line of the template -
 	//  ... replacing any data tags
-	//  ... then writing to the output file
+	//  ... then writing to the output buffer
 	while (fgets(line, HTML_MAX_LINE_LENGTH, infile) != NULL)
 	{
 		if (replaceDataTags(id, line, newline) == TRUE)
@@ -2606,6 +2837,7 @@ static int createOutFile(HTML_MGR_ID id, char* templatefile, uint64_t startTime)
 					includefname);
 				fclose(infile);
 				fclose(outfile);
+				free(buffer);
 				return ERROR;
 			}
 			while (fgets(line, HTML_MAX_LINE_LENGTH, incfile) != NULL)
@@ -2615,6 +2847,7 @@ static int createOutFile(HTML_MGR_ID id, char* templatefile, uint64_t startTime)
 					fclose(incfile);
 					fclose(infile);
 					fclose(outfile);
+					free(buffer);
 					return ERROR;
 				}
 			}
@@ -2628,6 +2861,7 @@ static int createOutFile(HTML_MGR_ID id, char* templatefile, uint64_t startTime)
 			{
 				fclose(infile);
 				fclose(outfile);
+				free(buffer);
 				return ERROR;
 			}
 		}
@@ -2635,6 +2869,33 @@ static int createOutFile(HTML_MGR_ID id, char* templatefile, uint64_t startTime)
 
 	fclose(infile);
 	fclose(outfile);
+
+	// same output as last time and still on disk - leave it alone:
+	hash = contentHash(buffer, bufferSize);
+	if (hash == tmpl->contentHash && outputsPresent(newfname))
+	{
+		free(buffer);
+		return OUTFILE_UNCHANGED;
+	}
+
+	// first write since startup (or since a failure): clear out siblings
+	// a different precompress mode left behind
+	removeStale = (tmpl->contentHash == 0);
+	tmpl->contentHash = 0;
+
+	if (replaceFile(newfname, buffer, bufferSize) == ERROR)
+	{
+		free(buffer);
+		return ERROR;
+	}
+
+	// a sibling that didn't make it is retried next time:
+	if (writeCompressedFiles(newfname, buffer, bufferSize, removeStale) == OK)
+	{
+		tmpl->contentHash = hash;
+	}
+
+	free(buffer);
 	return OK;
 }
 
@@ -2670,28 +2931,67 @@ int htmlGenerateInit(void)
 	return OK;
 }
 
+void htmlGenerateSetPrecompress(int mode)
+{
+	precompressMode = mode;
+
+#ifndef HAVE_BROTLI_ENCODE_H
+	if (precompressMode >= HTML_PRECOMPRESS_BROTLI)
+	{
+		MsgLog(PRI_MEDIUM, "htmlgend: built without brotli, writing .gz only");
+		precompressMode = HTML_PRECOMPRESS_GZIP;
+	}
+#endif
+
+	if (precompressMode != HTML_PRECOMPRESS_NONE)
+	{
+		MsgLog(PRI_STATUS, "Writing precompressed %s siblings of generated files",
+			((precompressMode >= HTML_PRECOMPRESS_BROTLI) ? ".gz/.br" : ".gz"));
+	}
+}
+
 int htmlgenOutputFiles(HTML_MGR_ID id, uint64_t startTime)
 {
 	register HTML_TMPL*  tmpl;
-	int                 count = 0;
+	HTML_TMPL*          slowest = NULL;
+	int                 count = 0, retVal;
+	uint64_t            tmplStart;
+	uint32_t            usecs, slowestUsecs = 0;
 
 	for (tmpl = (HTML_TMPL*)radListGetFirst(&id->templateList);
 		tmpl != NULL;
 		tmpl = (HTML_TMPL*)radListGetNext(&id->templateList, (NODE_PTR)tmpl))
 	{
-#if _DEBUG_GENERATION
-		wvutilsLogEvent(PRI_HIGH, "GENERATION: TEMPLATE: %s: %u ms",
-			tmpl->fname, (uint32_t)(radTimeGetMSSinceEpoch() - startTime));
-#endif
-
-		if (createOutFile(id, tmpl->fname, startTime) == ERROR)
+		tmplStart = latencyStart();
+		retVal = createOutFile(id, tmpl, startTime);
+		if (retVal == ERROR)
 		{
 			MsgLog(PRI_MEDIUM, "htmlgenOutputFiles: %s failed!", tmpl->fname);
+			metricsAdd(METRIC_TEMPLATES_FAILED, 1);
+		}
+		else if (retVal == OUTFILE_UNCHANGED)
+		{
+			count++;
+			metricsAdd(METRIC_TEMPLATES_SKIPPED, 1);
 		}
 		else
 		{
 			count++;
+			metricsAdd(METRIC_TEMPLATES_GENERATED, 1);
 		}
+		usecs = latencyStop(LATENCY_TEMPLATE, tmplStart);
+		if (usecs > slowestUsecs)
+		{
+			slowestUsecs = usecs;
+			slowest = tmpl;
+		}
+	}
+
+	// the template histogram can't say which one it was:
+	if (slowest != NULL)
+	{
+		wvutilsLogEvent(PRI_STATUS, "Slowest template: %s: %u.%3.3u ms",
+			slowest->fname, slowestUsecs / 1000, slowestUsecs % 1000);
 	}
 
 	return count;
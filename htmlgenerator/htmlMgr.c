@@ -97,6 +97,7 @@ static int readHtmlTemplateFile(HTML_MGR* mgr, char* filename)
 			continue;
 		}
 		wvstrncpy(html->fname, token, sizeof(html->fname));
+		html->contentHash = 0;
 
 		radListAddToEnd(&mgr->templateList, (NODE_PTR)html);
 	}
@@ -569,10 +570,10 @@ int htmlmgrGenerate
 // read archive database to initialize our historical arrays:
 int htmlmgrHistoryInit(HTML_MGR_ID id)
 {
-	HISTORY_DATA    data;
-	time_t          ntime, baseTime, arcTime;
+	HISTORY_DATA*   data;
+	time_t          baseTime, arcTime;
 	struct tm       locTime;
-	int             i, retVal, saveHour;
+	int             i;
 
 	// Compute when last archive record should have been:
 	arcTime = time(NULL);
@@ -591,42 +592,44 @@ int htmlmgrHistoryInit(HTML_MGR_ID id)
 	htmlmgrSetSampleLabels(id);
 
 	baseTime = arcTime;
-	saveHour = -1;
 
-	for (i = 0; i < DAILY_NUM_VALUES(id); i++)
+	// one pass over the last day, one bucket per archive interval:
+	data = (HISTORY_DATA*)malloc(DAILY_NUM_VALUES(id) * sizeof(HISTORY_DATA));
+	if (data == NULL)
 	{
-		ntime = baseTime;
-		ntime -= (WV_SECONDS_IN_DAY - (i * SECONDS_IN_INTERVAL(id->archiveInterval)));
+		MsgLog(PRI_HIGH, "htmlmgrHistoryInit: cannot allocate day history");
+		return ERROR;
+	}
 
-		retVal = dbsqliteArchiveGetAverages(id->isMetricUnits,
-			id->archiveInterval,
-			&data,
-			ntime,
-			1);
+	if (dbsqliteArchiveGetAveragesRange(id->isMetricUnits,
+		data,
+		baseTime - WV_SECONDS_IN_DAY,
+		SECONDS_IN_INTERVAL(id->archiveInterval),
+		DAILY_NUM_VALUES(id))
+		== ERROR)
+	{
+		for (i = 0; i < DAILY_NUM_VALUES(id); i++)
+		{
+			data[i].samples[DATA_INDEX_windDir] = 0;
+		}
+	}
 
-		if (retVal <= 0)
+	for (i = 0; i < DAILY_NUM_VALUES(id); i++)
+	{
+		if (data[i].samples[DATA_INDEX_windDir] == 0 ||
+			data[i].values[DATA_INDEX_windDir] <= ARCHIVE_VALUE_NULL)
 		{
 			id->windDayValues[i] = ARCHIVE_VALUE_NULL;
 		}
 		else
 		{
-			if (data.values[DATA_INDEX_windDir] <= ARCHIVE_VALUE_NULL)
-			{
-				id->windDayValues[i] = ARCHIVE_VALUE_NULL;
-			}
-			else
-			{
-				id->windDayValues[i] = data.values[DATA_INDEX_windDir] / data.samples[DATA_INDEX_windDir];
-			}
-		}
-
-		if (((i % 50) == 0) || ((i + 1) == DAILY_NUM_VALUES(id)))
-		{
-			MsgLog(PRI_STATUS, "Wind : DAY: samples=%d", i);
+			id->windDayValues[i] = data[i].values[DATA_INDEX_windDir] / data[i].samples[DATA_INDEX_windDir];
 		}
 	}
 
-	dbsqliteHistoryPragmaSet("synchronous", "normal");
+	MsgLog(PRI_STATUS, "Wind : DAY: samples=%d", DAILY_NUM_VALUES(id));
+
+	free(data);
 	return OK;
 }
 
@@ -142,6 +142,7 @@ typedef struct htmlTemplateTag
 {
 	NODE                node;
 	char                fname[128];
+	uint64_t            contentHash;        // of the last output written
 } HTML_TMPL;
 
 /*  !!!!!!!!!!!!!!!!!!!!  END HIDDEN SECTION  !!!!!!!!!!!!!!!!!!!!!
@@ -189,6 +190,14 @@ extern int htmlmgrGenerate
 	HTML_MGR_ID     id
 );
 
+//  ... precompressed siblings of each generated file
+#define HTML_PRECOMPRESS_NONE       0
+#define HTML_PRECOMPRESS_GZIP       1
+#define HTML_PRECOMPRESS_BROTLI     2   // .gz and .br
+
+extern int htmlGenerateInit(void);
+extern void htmlGenerateSetPrecompress(int mode);
+
 extern int htmlmgrHistoryInit(HTML_MGR_ID id);
 extern int htmlmgrAddSampleValue(HTML_MGR_ID id, HISTORY_DATA* data, int numIntervals);
 extern void htmlmgrSetSampleLabels(HTML_MGR_ID id);
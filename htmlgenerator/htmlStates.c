@@ -49,7 +49,7 @@ static void processNewArchiveRecord(HTML_WORK* work, WVIEW_MSG_ARCHIVE_NOTIFY* a
 	int                 currHour, currDay, currMonth, currYear;
 	float               gmtOffsetHours;
 	int                 startmin, starthour, startday, startmonth, startyear;
-	int                 i, DSTFlag;
+	int                 i, DSTFlag, retVal;
 	int16_t             tempShort;
 	time_t              ntime, baseTime;
 	struct tm           locTime;
@@ -242,12 +242,24 @@ static void processNewArchiveRecord(HTML_WORK* work, WVIEW_MSG_ARCHIVE_NOTIFY* a
 		ntime -= WV_SECONDS_IN_DAY;
 		localtime_r(&ntime, &locTime);
 
-		if (dbsqliteArchiveGetAverages(work->mgrId->isMetricUnits,
-			work->archiveInterval,
-			&data,
-			ntime,
-			WV_SECONDS_IN_DAY / SECONDS_IN_INTERVAL(work->archiveInterval))
-			<= 0)
+		// the day tier row holds the same (00:00, 24:00] window - read the
+		// archive itself only while the tier is still being built:
+		retVal = dbsqliteArchiveGetTierAverages(work->mgrId->isMetricUnits,
+			DBSQLITE_TIER_DAY,
+			wvutilsDayStart(ntime),
+			wvutilsDayStart(ntime) + 1,
+			&data);
+		if (retVal == ERROR)
+		{
+			retVal = dbsqliteArchiveGetAverages(work->mgrId->isMetricUnits,
+				work->archiveInterval,
+				&data,
+				ntime,
+				WV_SECONDS_IN_DAY / SECONDS_IN_INTERVAL(work->archiveInterval));
+		}
+		data.startTime = ntime;
+
+		if (retVal <= 0)
 		{
 			// populate history data with ARCHIVE_VALUE_NULL
 			for (i = 0; i < DATA_INDEX_MAX(work->isExtendedData); i++)
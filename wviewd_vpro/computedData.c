@@ -322,17 +322,13 @@ static int computeDataHour(WVIEWD_WORK* work, time_t lastTime)
 {
 	int                 numrecs = 0;
 	time_t              timenow = time(NULL);
-	struct tm           bkntimenow;
 	SENSOR_STORE*        store = &work->sensors;
 
 	// do this so we pick up the proper hour/day when mins < archiveInterval
 	timenow -= (work->archiveInterval * 60);
 
 	// build time for this hour:
-	localtime_r(&timenow, &bkntimenow);
-	bkntimenow.tm_min = 0;
-	bkntimenow.tm_sec = 0;
-	timenow = mktime(&bkntimenow);
+	timenow = wvutilsHourStart(timenow);
 
 	if (lastTime > timenow)
 	{
@@ -387,13 +383,8 @@ static int computeDataDay(WVIEWD_WORK* work, time_t lastTime)
 	timenow -= (work->archiveInterval * 60);
 
 	// build time for this day:
-	localtime_r(&timenow, &bkntimenow);
-	bkntimenow.tm_hour = 0;
-	bkntimenow.tm_min = 0;
-	bkntimenow.tm_sec = 0;
-	bkntimenow.tm_isdst = -1;
-	timenow = mktime(&bkntimenow);
-	localtime_r(&timenow, &bkntimenow);
+	timenow = wvutilsDayStart(timenow);
+	wvutilsLocalTime(timenow, &bkntimenow);
 
 	if (lastTime > timenow)
 	{
@@ -430,13 +421,8 @@ static int computeDataWeek(WVIEWD_WORK* work, time_t lastTime)
 	timenow -= (WV_SECONDS_IN_DAY * 7);
 
 	// build time:
-	localtime_r(&timenow, &bkntimenow);
-	bkntimenow.tm_hour = 0;
-	bkntimenow.tm_min = 0;
-	bkntimenow.tm_sec = 0;
-	bkntimenow.tm_isdst = -1;
-	timenow = mktime(&bkntimenow);
-	localtime_r(&timenow, &bkntimenow);
+	timenow = wvutilsDayStart(timenow);
+	wvutilsLocalTime(timenow, &bkntimenow);
 
 	if (lastTime > timenow)
 	{
@@ -459,13 +445,8 @@ static int computeDataWeek(WVIEWD_WORK* work, time_t lastTime)
 		}
 
 		timenow += WV_SECONDS_IN_DAY;
-		localtime_r(&timenow, &bkntimenow);
-		bkntimenow.tm_hour = 0;
-		bkntimenow.tm_min = 0;
-		bkntimenow.tm_sec = 0;
-		bkntimenow.tm_isdst = -1;
-		timenow = mktime(&bkntimenow);
-		localtime_r(&timenow, &bkntimenow);
+		timenow = wvutilsDayStart(timenow);
+		wvutilsLocalTime(timenow, &bkntimenow);
 	}
 
 	// were there any recs for this week?
@@ -620,15 +601,7 @@ static int computeDataYear(WVIEWD_WORK* work, time_t lastTime)
 			rainyear--;
 		}
 
-		localtime_r(&timenow, &bkntimenow);
-		bkntimenow.tm_year = rainyear - 1900;
-		bkntimenow.tm_mon = rainmonth - 1;
-		bkntimenow.tm_mday = 1;
-		bkntimenow.tm_hour = 0;
-		bkntimenow.tm_min = 0;
-		bkntimenow.tm_sec = 0;
-		bkntimenow.tm_isdst = -1;
-		startTime = mktime(&bkntimenow);
+		startTime = wvutilsRainSeasonStart(timenow, rainmonth);
 
 		// now loop till we get to this month:
 		while ((rainyear < nowyear) || ((rainmonth <= nowmonth) && (rainyear == nowyear)))
@@ -665,15 +638,8 @@ static int computeDataAllTime(WVIEWD_WORK* work, time_t firstTime)
 	nowmonth = bkntimenow.tm_mon + 1;
 	nowyear = bkntimenow.tm_year + 1900;
 
-	localtime_r(&firstTime, &bkntimenow);
-	bkntimenow.tm_mday = 1;
-	bkntimenow.tm_hour = 0;
-	bkntimenow.tm_min = 0;
-	bkntimenow.tm_sec = 0;
-	bkntimenow.tm_isdst = -1;
-	startTime = mktime(&bkntimenow);
-
-	localtime_r(&startTime, &startMonth);
+	startTime = wvutilsMonthStart(firstTime);
+	wvutilsLocalTime(startTime, &startMonth);
 
 	// loop through each month until we reach now:
 	for (i = startMonth.tm_mon + 1, j = startMonth.tm_year + 1900;
@@ -865,6 +831,7 @@ static void intervalHousekeeping(WVIEWD_WORK* work)
 int computedDataStoreSample(WVIEWD_WORK* work)
 {
 	WV_SENSOR       sample[SENSOR_MAX];
+	uint64_t        startTime;
 
 	sensorClearSet(sample);
 
@@ -921,7 +888,9 @@ int computedDataStoreSample(WVIEWD_WORK* work)
 	windAverageAddValue(&work->sensors.wind[STF_INTERVAL], work->loopPkt.windDir);
 
 	// Store to the HILOW database:
+	startTime = latencyStart();
 	dbsqliteHiLowStoreSample(time(NULL), &work->loopPkt);
+	latencyStop(LATENCY_HILOW_SAMPLE, startTime);
 
 	return OK;
 }
@@ -1047,13 +1016,9 @@ int computedDataInit(WVIEWD_WORK* work)
 	int             rainyear;
 	ARCHIVE_PKT     recordStore;
 
-	localtime_r(&nowtime, &bknnowtime);
+	wvutilsLocalTime(wvutilsRainSeasonStart(nowtime, work->stationRainSeasonStart),
+					 &bknnowtime);
 	rainyear = bknnowtime.tm_year + 1900;
-	if (work->stationRainSeasonStart > (bknnowtime.tm_mon + 1))
-	{
-		// we need to go back a year...
-		rainyear--;
-	}
 
 	MsgLog(PRI_STATUS, "initializing computed data values...");
 
@@ -1117,18 +1082,6 @@ int computedDataInit(WVIEWD_WORK* work)
 
 void computedDataExit(WVIEWD_WORK* work)
 {
-	int         rainyear;
-	time_t      nowtime = time(NULL);
-	struct tm   bkntimenow;
-
-	localtime_r(&nowtime, &bkntimenow);
-	rainyear = bkntimenow.tm_year + 1900;
-	if (work->stationRainSeasonStart > (bkntimenow.tm_mon + 1))
-	{
-		// we need to go back a year...
-		rainyear--;
-	}
-
 	return;
 }
 
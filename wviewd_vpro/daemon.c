@@ -50,6 +50,17 @@
 */
 static WVIEWD_WORK      wviewdWork;
 
+// records indicated by the station are parked here until the end of their
+// batch (a NULL archive indication), then stored with one
+// dbsqliteArchiveStoreRecords call and announced in order
+static struct
+{
+	ARCHIVE_PKT     record;
+	int             valid;
+} pendingArchive[WVD_PENDING_ARCHIVE_MAX];
+static int              pendingArchiveCount;
+static ARCHIVE_PKT      pendingStore[WVD_PENDING_ARCHIVE_MAX];
+
 static char*            wviewStatusLabels[STATUS_STATS_MAX] =
 {
 	"LOOP packets received",
@@ -64,6 +75,7 @@ static char*            wviewStatusLabels[STATUS_STATS_MAX] =
 static int daemonStationLoopComplete(void)
 {
 	float           tempf, sampleRain, sampleET;
+	uint64_t        startTime;
 
 	if (!wviewdWork.runningFlag)
 	{
@@ -110,7 +122,9 @@ static int daemonStationLoopComplete(void)
 	wviewdWork.loopPkt.rainRate += wviewdWork.calCRainRate;
 
 	// store the results:
+	startTime = latencyStart();
 	computedDataStoreSample(&wviewdWork);
+	latencyStop(LATENCY_COMPUTED_SAMPLE, startTime);
 
 	sampleRain = sensorGetCumulative(&wviewdWork.sensors.sensor[STF_INTERVAL][SENSOR_RAIN]);
 	sampleET = sensorGetCumulative(&wviewdWork.sensors.sensor[STF_INTERVAL][SENSOR_ET]);
@@ -152,12 +166,14 @@ static int daemonStationLoopComplete(void)
 	wviewdWork.loopPkt.yearRainMonth = wviewdWork.stationRainSeasonStart;
 
 	statusIncrementStat(WVIEW_STATS_LOOP_PKTS_RX);
+	metricsAdd(METRIC_LOOP_PACKETS, 1);
 	return OK;
 }
 
 static int daemonStationInitComplete(void* eventData)
 {
 	ARCHIVE_PKT         newestRecord;
+	uint64_t            startTime;
 
 	if (eventData != 0)
 	{
@@ -196,7 +212,9 @@ static int daemonStationInitComplete(void* eventData)
 
 		// do an initial update to propogate the initial readings
 		// (so we have some data to start with)
+		startTime = latencyStart();
 		computedDataUpdate(&wviewdWork);
+		latencyStop(LATENCY_COMPUTED_UPDATE, startTime);
 
 		// start the timers...
 		stationStartArchiveTimerUniform(&wviewdWork);
@@ -261,15 +279,16 @@ static void daemonCheckArchiveRecord(ARCHIVE_PKT* newRecord)
 	LastPacket = *newRecord;
 }
 
-static void daemonStoreArchiveRecord(ARCHIVE_PKT* newRecord)
+// check a new record against the last one stored and add the LOOP2-only
+// sensors; returns OK if it should be stored
+static int daemonPrepareArchiveRecord(ARCHIVE_PKT* newRecord)
 {
-	float           sampleRain;
 	int             deltaTime;
 
 	if (newRecord == NULL)
 	{
 		MsgLog(PRI_MEDIUM, "daemonStoreArchiveRecord: record is NULL!");
-		return;
+		return ERROR;
 	}
 
 	deltaTime = newRecord->dateTime - wviewdWork.archiveDateTime;
@@ -278,14 +297,14 @@ static void daemonStoreArchiveRecord(ARCHIVE_PKT* newRecord)
 		// discard it, same as previous record
 		MsgLog(PRI_MEDIUM,
 			"daemonStoreArchiveRecord: record has same timestamp as previous!");
-		return;
+		return ERROR;
 	}
 	else if (deltaTime < 0)
 	{
 		// chunk it, it is just wrong
 		MsgLog(PRI_MEDIUM,
 			"StoreArchiveRecord: record has earlier timestamp than previous (DST change?)");
-		return;
+		return ERROR;
 	}
 
 	wviewdWork.archiveDateTime = newRecord->dateTime;
@@ -311,12 +330,12 @@ static void daemonStoreArchiveRecord(ARCHIVE_PKT* newRecord)
 	if (wviewdWork.loopPkt.dewpoint < 122 && wviewdWork.loopPkt.dewpoint >14)
 		newRecord->value[DATA_INDEX_dewpoint] = wviewdWork.loopPkt.dewpoint;
 
-	if (dbsqliteArchiveStoreRecord(newRecord) == ERROR)
-	{
-		MsgLog(PRI_MEDIUM, "daemonStoreArchiveRecord: dbsqliteArchiveStoreRecord failed!!!");
-		return;
-	}
+	return OK;
+}
 
+// bookkeeping once 'newRecord' is in the archive database
+static void daemonArchiveRecordStored(ARCHIVE_PKT* newRecord)
+{
 	// Check for flatline values:
 	daemonCheckArchiveRecord(newRecord);
 
@@ -355,25 +374,115 @@ static void daemonStoreArchiveRecord(ARCHIVE_PKT* newRecord)
 		wviewdWork.loopPkt.dayET = sensorGetCumulative(&wviewdWork.sensors.sensor[STF_DAY][SENSOR_ET]);
 		wviewdWork.loopPkt.monthET = sensorGetCumulative(&wviewdWork.sensors.sensor[STF_MONTH][SENSOR_ET]);
 		wviewdWork.loopPkt.yearET = sensorGetCumulative(&wviewdWork.sensors.sensor[STF_YEAR][SENSOR_ET]);
+	}
+
+	statusIncrementStat(WVIEW_STATS_ARCHIVE_PKTS_RX);
+	metricsAdd(METRIC_ARCHIVE_RECORDS, 1);
+	return;
+}
+
+static int daemonStoreArchiveRecord(ARCHIVE_PKT* newRecord)
+{
+	if (daemonPrepareArchiveRecord(newRecord) == ERROR)
+	{
+		return ERROR;
+	}
+
+	if (dbsqliteArchiveStoreRecord(newRecord) == ERROR)
+	{
+		MsgLog(PRI_MEDIUM, "daemonStoreArchiveRecord: dbsqliteArchiveStoreRecord failed!!!");
+		return ERROR;
+	}
+
+	daemonArchiveRecordStored(newRecord);
+	return OK;
+}
 
-		// send archive notification:
+static void daemonAnnounceArchiveRecord(ARCHIVE_PKT* newRecord, int stored)
+{
+	// send archive notification:
+	if (stored && wviewdWork.runningFlag)
+	{
 		stationSendArchiveNotifications(&wviewdWork, (float)newRecord->value[DATA_INDEX_rain]);
 	}
 
-	statusIncrementStat(WVIEW_STATS_ARCHIVE_PKTS_RX);
+	// Push to internal clients:
+	stationPushArchiveToClients(&wviewdWork, newRecord);
+	return;
+}
+
+// store the parked records in one transaction, then announce them - readers
+// on other connections only see the batch once it has committed
+static void daemonStorePendingArchive(void)
+{
+	uint64_t        startTime;
+	int             i, count = 0, result = ERROR;
+
+	if (pendingArchiveCount == 0)
+	{
+		return;
+	}
+
+	for (i = 0; i < pendingArchiveCount; i++)
+	{
+		if (pendingArchive[i].valid)
+		{
+			pendingStore[count++] = pendingArchive[i].record;
+		}
+	}
+
+	if (count > 0)
+	{
+		startTime = latencyStart();
+		result = dbsqliteArchiveStoreRecords(pendingStore, count);
+		latencyStop(LATENCY_ARCHIVE_STORE, startTime);
+
+		if (result == ERROR)
+		{
+			MsgLog(PRI_MEDIUM, "daemonStorePendingArchive: storing %d records failed!!!", count);
+		}
+		else if (result < count)
+		{
+			MsgLog(PRI_MEDIUM, "daemonStorePendingArchive: only %d of %d records stored",
+				result, count);
+		}
+	}
+
+	for (i = 0; i < pendingArchiveCount; i++)
+	{
+		if (pendingArchive[i].valid && result != ERROR)
+		{
+			daemonArchiveRecordStored(&pendingArchive[i].record);
+			daemonAnnounceArchiveRecord(&pendingArchive[i].record, TRUE);
+		}
+		else
+		{
+			daemonAnnounceArchiveRecord(&pendingArchive[i].record, FALSE);
+		}
+	}
+
+	pendingArchiveCount = 0;
 	return;
 }
 
 static void daemonArchiveIndication(ARCHIVE_PKT* newRecord)
 {
-	if (newRecord != NULL)
+	if (newRecord == NULL)
 	{
-		daemonStoreArchiveRecord(newRecord);
+		// end of a batch (or no record) - store what it brought
+		daemonStorePendingArchive();
+		return;
+	}
 
-		// Push to internal clients:
-		stationPushArchiveToClients(&wviewdWork, newRecord);
+	if (pendingArchiveCount >= WVD_PENDING_ARCHIVE_MAX)
+	{
+		daemonStorePendingArchive();
 	}
 
+	pendingArchive[pendingArchiveCount].record = *newRecord;
+	pendingArchive[pendingArchiveCount].valid =
+		(daemonPrepareArchiveRecord(&pendingArchive[pendingArchiveCount].record) == OK);
+	pendingArchiveCount ++;
 	return;
 }
 
@@ -443,6 +552,9 @@ static int daemonSysExit(WVIEWD_WORK* work)
 {
 	struct stat     fileData;
 
+	metricsExit();
+	rtserverExit();
+
 	/*  ... delete our pid file
 	*/
 	if (stat(work->pidFile, &fileData) == 0)
@@ -468,6 +580,12 @@ static void defaultSigHandler(int signum)
 		radProcessSignalCatch(signum, defaultSigHandler);
 		return;
 
+	case SIGUSR2:
+		// dump the pipeline latency histograms:
+		latencyDump();
+		radProcessSignalCatch(signum, defaultSigHandler);
+		return;
+
 	case SIGPIPE:
 		// we have a far end socket disconnection, we'll handle it in the
 		// "read/write" code
@@ -564,6 +682,8 @@ static void archiveTimerHandler(void* parm)
 {
 	ARCHIVE_PKT*    newRec;
 	time_t          ntime;
+	uint64_t        startTime;
+	int             stored;
 
 	// get the current time
 	ntime = time(NULL);
@@ -589,10 +709,11 @@ static void archiveTimerHandler(void* parm)
 		newRec = computedDataGenerateArchive(&wviewdWork);
 		if (newRec != NULL)
 		{
-			daemonStoreArchiveRecord(newRec);
+			startTime = latencyStart();
+			stored = (daemonStoreArchiveRecord(newRec) == OK);
+			latencyStop(LATENCY_ARCHIVE_STORE, startTime);
 
-			// Push to internal clients:
-			stationPushArchiveToClients(&wviewdWork, newRec);
+			daemonAnnounceArchiveRecord(newRec, stored);
 		}
 		else
 		{
@@ -602,11 +723,17 @@ static void archiveTimerHandler(void* parm)
 	}
 
 	// Update computed values:
+	startTime = latencyStart();
 	computedDataUpdate(&wviewdWork);
+	latencyStop(LATENCY_COMPUTED_UPDATE, startTime);
 
 	// clear for the next archive period:
 	computedDataClearInterval(&wviewdWork);
 
+	// quiet until the next LOOP - good time to fold the WALs back in:
+	dbsqliteSessionCheckpoint();
+	statusFlush();
+
 	// restart the timer
 	stationStartArchiveTimerUniform(&wviewdWork);
 	return;
@@ -640,6 +767,17 @@ static void syncTimerHandler(void* parm)
 	return;
 }
 
+static void tierTimerHandler(void* parm)
+{
+	// fold the next slice of the existing archive into the average tiers:
+	if (dbsqliteArchiveTierRebuildStep(WVD_TIER_REBUILD_RECORDS) == TRUE)
+	{
+		radTimerStart(wviewdWork.tierTimer, WVD_TIER_REBUILD_MSECS);
+	}
+
+	return;
+}
+
 static void ifTimerHandler(void* parm)
 {
 	// we just pass through the IF timer to the station-specific indication
@@ -890,6 +1028,31 @@ int main(int argc, char* argv[])
 				}
 			}
 		}
+		else if (!strcmp(wviewdWork.stationInterface, "replay"))
+		{
+			MsgLog(PRI_MEDIUM,
+				"station interface: capture replay ...");
+
+			// the device is the capture file to play back
+			sValue = wvconfigGetStringValue(configItem_STATION_STATION_DEV);
+			if (sValue == NULL)
+			{
+				wvconfigExit();
+				MsgLog(PRI_CATASTROPHIC,
+					"no capture file given, aborting...");
+				daemonSysExit(&wviewdWork);
+				radProcessExit();
+				radSystemExit(WVIEW_SYSTEM_ID);
+				exit(1);
+			}
+			else
+			{
+				wvstrncpy(wviewdWork.stationDevice, sValue, sizeof(wviewdWork.stationDevice));
+			}
+
+			// 0 (or not set) replays as fast as possible
+			wviewdWork.replaySpeed = wvconfigGetINTValue(configItem_STATION_REPLAY_SPEED);
+		}
 		else
 		{
 			// invalid type specified - abort
@@ -902,6 +1065,14 @@ int main(int argc, char* argv[])
 			radSystemExit(WVIEW_SYSTEM_ID);
 			exit(1);
 		}
+
+		// optionally record the station traffic for later replay:
+		sValue = wvconfigGetStringValue(configItem_STATION_CAPTURE_FILE);
+		if (sValue != NULL && sValue[0] != 0 &&
+			strcmp(wviewdWork.stationInterface, "replay"))
+		{
+			wvstrncpy(wviewdWork.captureFile, sValue, sizeof(wviewdWork.captureFile));
+		}
 	}
 	///// STATION_INTERFACE PROCESSING END /////
 
@@ -1187,6 +1358,41 @@ int main(int argc, char* argv[])
 	dValue = wvconfigGetDOUBLEValue(configItemCAL_CONST_RAINRATE);
 	wviewdWork.calCRainRate = dValue;
 
+	// latency histograms stay on unless turned off:
+	iValue = wvconfigGetBooleanValue(configItem_ENABLE_LATENCY_STATS);
+	if (iValue >= 0)
+	{
+		latencySetEnabled(iValue);
+	}
+
+	// local Prometheus endpoint, off unless a port is given:
+	iValue = wvconfigGetINTValue(configItem_WVIEWD_METRICS_PORT);
+	if (iValue > 0)
+	{
+		metricsInit(PROC_NAME_DAEMON, iValue);
+	}
+
+	// WebSocket/SSE push of the realtime data, off unless a port is given:
+	iValue = wvconfigGetINTValue(configItem_WVIEWD_REALTIME_PORT);
+	if (iValue > 0)
+	{
+		rtserverInit(iValue, wvconfigGetINTValue(configItem_WVIEWD_REALTIME_CLIENTS));
+	}
+
+	// between keyframes the push channel only carries changed fields:
+	iValue = wvconfigGetINTValue(configItem_WVIEWD_REALTIME_KEYFRAME);
+	if (iValue > 0)
+	{
+		rtdataSetKeyframeInterval(iValue);
+	}
+
+	// compact binary snapshots for machine consumers:
+	iValue = wvconfigGetBooleanValue(configItem_WVIEWD_REALTIME_CBOR);
+	if (iValue >= 0)
+	{
+		rtdataSetBinaryEnabled(iValue);
+	}
+
 	iValue = wvconfigGetBooleanValue(configItem_ENABLE_EMAIL);
 	if (iValue >= 0)
 	{
@@ -1423,6 +1629,17 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	// build the average tiers in the background (not fatal if we can't):
+	wviewdWork.tierTimer = radTimerCreate(NULL, tierTimerHandler, NULL);
+	if (wviewdWork.tierTimer == NULL)
+	{
+		MsgLog(PRI_MEDIUM, "cannot create tier rebuild timer - tiers may be incomplete");
+	}
+	else
+	{
+		radTimerStart(wviewdWork.tierTimer, WVD_TIER_REBUILD_MSECS);
+	}
+
 	statusUpdate(STATUS_RUNNING);
 	statusUpdateMessage("Normal operation");
 	MsgLog(PRI_STATUS, "running...");
@@ -1447,6 +1664,10 @@ int main(int argc, char* argv[])
 	radTimerDelete(wviewdWork.pushTimer);
 	radTimerDelete(wviewdWork.cdataTimer);
 	radTimerDelete(wviewdWork.archiveTimer);
+	if (wviewdWork.tierTimer != NULL)
+	{
+		radTimerDelete(wviewdWork.tierTimer);
+	}
 	stationExit(&wviewdWork);
 	dbsqliteHiLowExit();
 	dbsqliteArchiveExit();
@@ -55,6 +55,8 @@
 #include <services.h>
 #include <wvconfig.h>
 #include <status.h>
+#include <latency.h>
+#include <metrics.h>
 #include <hidapi.h>
 
 /*  !!!!!!!!!!!!!!!!!!  HIDDEN, NOT FOR API USE  !!!!!!!!!!!!!!!!!!
@@ -91,6 +93,7 @@ typedef struct _wview_medium
 	void(*exit)(struct _wview_medium* medium);
 	int(*restart)(struct _wview_medium* medium);
 	int(*read)(struct _wview_medium* medium, void* bfr, int len, int timeout);
+	int(*readAvail)(struct _wview_medium* medium, void* bfr, int maxlen);
 	int(*write)(struct _wview_medium* medium, void* buffer, int length);
 	void(*flush)(struct _wview_medium* medium, int queue);
 	void(*txdrain)(struct _wview_medium* medium);
@@ -119,6 +122,13 @@ typedef struct _wview_medium
 // Number of archive intervals in 4 hours (flat line base values will trigger an alert):
 #define WVD_FLATLINE_THRESHOLD(archiveInterval) (240/archiveInterval)
 
+// archive records parked until the end of their batch (VP_ARCHIVE_QUEUE_MAX)
+#define WVD_PENDING_ARCHIVE_MAX         100
+
+// archive records folded into the average tiers per rebuild timer tick
+#define WVD_TIER_REBUILD_RECORDS        1000
+#define WVD_TIER_REBUILD_MSECS          1000
+
 // the wview daemon work area
 typedef struct
 {
@@ -136,6 +146,8 @@ typedef struct
 	char            stationInterface[16];
 	char            stationDevice[WVIEW_MAX_PATH];
 	char            stationHost[256];
+	char            captureFile[WVIEW_MAX_PATH];  // record station traffic if set
+	int             replaySpeed;                // "replay" interface only
 	int             stationPort;
 	int             stationIsWLIP;
 	int             stationToggleDTR;
@@ -156,6 +168,7 @@ typedef struct
 	TIMER_ID        pushTimer;
 	TIMER_ID        syncTimer;
 	TIMER_ID        ifTimer;
+	TIMER_ID        tierTimer;
 	uint32_t        cdataInterval;
 	uint32_t        pushInterval;
 	SENSOR_STORE    sensors;
@@ -0,0 +1,415 @@
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		realtimeData.c
+
+  PURPOSE:
+		Build the realtime snapshot and its JSON keyframe/delta encodings.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		Deltas are decided on the formatted text, not the raw value, so a
+		temperature that wobbles in the third decimal doesn't resend a
+		field that reads the same.
+
+		The CBOR encoder only knows what it needs: unsigned/negative
+		integers and definite-length maps, always in the shortest form.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+/*  ... System include files
+*/
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+/*  ... Library include files
+*/
+
+/*  ... Local include files
+*/
+#include <realtimeData.h>
+#include <realtimeServer.h>
+#include <daemon.h>
+
+/*  ... global memory declarations
+*/
+
+/*  ... local memory
+*/
+#define REALTIME_FILE_DIR       "/var/lib/wview/img/ramdisk/json"
+#define REALTIME_JSON_FILE      REALTIME_FILE_DIR "/realtimeparameterlist.txt"
+#define REALTIME_CBOR_FILE      REALTIME_FILE_DIR "/realtimeparameterlist.cbor"
+#define REALTIME_SCHEMA_FILE    REALTIME_FILE_DIR "/realtimeschema.json"
+#define REALTIME_JSON_MAX       4096
+#define REALTIME_CBOR_MAX       (32 + (RTF_MAX * 10))
+
+// CBOR major types
+#define CBOR_UNSIGNED           0
+#define CBOR_NEGATIVE           1
+#define CBOR_MAP                5
+
+typedef struct
+{
+	const char*     name;
+	int             decimals;
+} REALTIME_FIELD_DEF;
+
+static const REALTIME_FIELD_DEF     FieldDefs[RTF_MAX] =
+{
+	{ "dummy",                      0 },
+	{ "outsideTemp",                1 },
+	{ "hiOutsideTemp",              1 },
+	{ "lowOutsideTemp",             1 },
+	{ "outsideDewPt",               1 },
+	{ "hiDewpoint",                 1 },
+	{ "lowDewpoint",                1 },
+	{ "extraTemp1",                 1 },
+	{ "hiOutsideATemp",             1 },
+	{ "lowOutsideATemp",            1 },
+	{ "dailyRain",                  1 },
+	{ "rainRate",                   1 },
+	{ "hiRainRate",                 1 },
+	{ "stormRain",                  1 },
+	{ "stormStart",                 0 },
+	{ "outsideHumidity",            0 },
+	{ "hiHumidity",                 0 },
+	{ "lowHumidity",                0 },
+	{ "barometer",                  1 },
+	{ "hiBarometer",                1 },
+	{ "lowBarometer",               1 },
+	{ "windSpeed",                  1 },
+	{ "windGustSpeed",              1 },
+	{ "tenMinuteWindGust",          1 },
+	{ "hiWindSpeed",                1 },
+	{ "windDirectionDegrees",       0 },
+	{ "windGustDirectionDegrees",   0 },
+	{ "WinddirtenMinuteWindGust",   0 },
+	{ "ET",                         1 },
+	{ "UV",                         1 },
+	{ "hiUV",                       1 },
+	{ "solarRad",                   0 },
+	{ "hiRadiation",                1 },
+	{ "tenMinuteAvgWindSpeed",      1 },
+	{ "twoMinuteAvgWindSpeed",      1 }
+};
+
+static int                  KeyframeInterval;
+static int                  BinaryEnabled;
+static int                  SchemaWritten;
+static time_t               LastKeyframe;
+static uint32_t             Sequence;
+static int                  HavePrevious;
+static REALTIME_SNAPSHOT    Previous;
+
+static char                 FileText[REALTIME_JSON_MAX];
+static char                 KeyText[REALTIME_JSON_MAX];
+static char                 UpdateText[REALTIME_JSON_MAX];
+static unsigned char        Binary[REALTIME_CBOR_MAX];
+
+
+static int append(char* store, int length, const char* format, ...)
+{
+	va_list     argList;
+	int         retVal;
+
+	if (length >= REALTIME_JSON_MAX)
+	{
+		return length;
+	}
+
+	va_start(argList, format);
+	retVal = vsnprintf(&store[length], REALTIME_JSON_MAX - length, format, argList);
+	va_end(argList);
+
+	if (retVal < 0)
+	{
+		return length;
+	}
+	return (((length + retVal) < REALTIME_JSON_MAX) ? (length + retVal) : (REALTIME_JSON_MAX - 1));
+}
+
+// replace the file in one step so pollers never see a partial update
+static void writeRealTimeFile(const char* path, const void* data, int length)
+{
+	char        tempName[WVIEW_MAX_PATH];
+	FILE*       file;
+
+	sprintf(tempName, "%s.tmp", path);
+	file = fopen(tempName, "w");
+	if (file == NULL)
+	{
+		return;
+	}
+
+	if (fwrite(data, 1, length, file) != (size_t)length)
+	{
+		fclose(file);
+		unlink(tempName);
+		return;
+	}
+	fclose(file);
+
+	rename(tempName, path);
+}
+
+//  ... the id table for binary consumers, from the same field list
+static void writeSchemaFile(void)
+{
+	REALTIME_FIELD_ID   id;
+	int                 length = 0;
+
+	length = append(FileText, length, "{\n\"schema\":%d,\n\"fields\":[",
+		REALTIME_SCHEMA_VERSION);
+	for (id = RTF_OUTSIDE_TEMP; id < RTF_MAX; id++)
+	{
+		length = append(FileText, length,
+			"%s\n{\"id\":%d,\"name\":\"%s\",\"decimals\":%d}",
+			((id == RTF_OUTSIDE_TEMP) ? "" : ","),
+			(int)id, FieldDefs[id].name, FieldDefs[id].decimals);
+	}
+	length = append(FileText, length, "\n]\n}\n");
+
+	writeRealTimeFile(REALTIME_SCHEMA_FILE, FileText, length);
+}
+
+static int cborHead(unsigned char* store, int major, uint64_t value)
+{
+	int         bytes, i;
+
+	if (value < 24)
+	{
+		store[0] = (unsigned char)((major << 5) | value);
+		return 1;
+	}
+	else if (value <= 0xFF)
+	{
+		store[0] = (unsigned char)((major << 5) | 24);
+		bytes = 1;
+	}
+	else if (value <= 0xFFFF)
+	{
+		store[0] = (unsigned char)((major << 5) | 25);
+		bytes = 2;
+	}
+	else if (value <= 0xFFFFFFFFULL)
+	{
+		store[0] = (unsigned char)((major << 5) | 26);
+		bytes = 4;
+	}
+	else
+	{
+		store[0] = (unsigned char)((major << 5) | 27);
+		bytes = 8;
+	}
+
+	// big-endian argument:
+	for (i = 0; i < bytes; i++)
+	{
+		store[1 + i] = (unsigned char)(value >> ((bytes - 1 - i) * 8));
+	}
+	return 1 + bytes;
+}
+
+static int cborInt(unsigned char* store, int64_t value)
+{
+	if (value < 0)
+	{
+		return cborHead(store, CBOR_NEGATIVE, (uint64_t)(-1 - value));
+	}
+	return cborHead(store, CBOR_UNSIGNED, (uint64_t)value);
+}
+
+static int formatBinary(REALTIME_SNAPSHOT* snapshot, time_t now, unsigned char* store)
+{
+	REALTIME_FIELD_ID   id;
+	int                 length = 0, count = 0, i;
+	double              scale;
+
+	for (id = RTF_OUTSIDE_TEMP; id < RTF_MAX; id++)
+	{
+		count += (snapshot->present[id] ? 1 : 0);
+	}
+
+	length += cborHead(&store[length], CBOR_MAP, 4);
+	length += cborInt(&store[length], 0);
+	length += cborInt(&store[length], REALTIME_SCHEMA_VERSION);
+	length += cborInt(&store[length], 1);
+	length += cborInt(&store[length], Sequence);
+	length += cborInt(&store[length], 2);
+	length += cborInt(&store[length], (int64_t)now);
+	length += cborInt(&store[length], 3);
+	length += cborHead(&store[length], CBOR_MAP, count);
+
+	for (id = RTF_OUTSIDE_TEMP; id < RTF_MAX; id++)
+	{
+		if (!snapshot->present[id])
+		{
+			continue;
+		}
+
+		for (i = 0, scale = 1.0; i < FieldDefs[id].decimals; i++)
+		{
+			scale *= 10.0;
+		}
+
+		// from the formatted text, so it rounds exactly like the JSON:
+		length += cborInt(&store[length], id);
+		length += cborInt(&store[length], (int64_t)llround(atof(snapshot->text[id]) * scale));
+	}
+
+	return length;
+}
+
+//  ... the realtimeparameterlist.txt layout: one member per line
+static int formatFile(REALTIME_SNAPSHOT* snapshot, char* store)
+{
+	REALTIME_FIELD_ID   id;
+	int                 length = 0;
+
+	length = append(store, length, "{");
+	for (id = RTF_DUMMY; id < RTF_MAX; id++)
+	{
+		if (!snapshot->present[id])
+		{
+			continue;
+		}
+
+		length = append(store, length, "%s\n\"%s\":%s",
+			((length > 1) ? "," : ""), FieldDefs[id].name, snapshot->text[id]);
+	}
+	return append(store, length, "\n}");
+}
+
+//  ... the push layout: one line, "seq" first; 'previous' NULL for a keyframe
+static int formatUpdate
+(
+	REALTIME_SNAPSHOT*  snapshot,
+	REALTIME_SNAPSHOT*  previous,
+	char*               store
+)
+{
+	REALTIME_FIELD_ID   id;
+	int                 length = 0;
+
+	length = append(store, length, "{\"seq\":%u%s", Sequence,
+		((previous == NULL) ? ",\"keyframe\":1" : ""));
+
+	for (id = RTF_DUMMY; id < RTF_MAX; id++)
+	{
+		if (previous == NULL)
+		{
+			if (snapshot->present[id])
+			{
+				length = append(store, length, ",\"%s\":%s",
+					FieldDefs[id].name, snapshot->text[id]);
+			}
+		}
+		else if (snapshot->present[id])
+		{
+			if (!previous->present[id] || strcmp(snapshot->text[id], previous->text[id]))
+			{
+				length = append(store, length, ",\"%s\":%s",
+					FieldDefs[id].name, snapshot->text[id]);
+			}
+		}
+		else if (previous->present[id])
+		{
+			length = append(store, length, ",\"%s\":null", FieldDefs[id].name);
+		}
+	}
+
+	return append(store, length, "}");
+}
+
+
+/*  ... API methods
+*/
+
+void rtdataSetKeyframeInterval(int seconds)
+{
+	KeyframeInterval = seconds;
+}
+
+void rtdataSetBinaryEnabled(int enabled)
+{
+	BinaryEnabled = enabled;
+}
+
+void rtdataClear(REALTIME_SNAPSHOT* snapshot)
+{
+	memset(snapshot->present, 0, sizeof(snapshot->present));
+}
+
+void rtdataSet(REALTIME_SNAPSHOT* snapshot, REALTIME_FIELD_ID id, double value)
+{
+	if (id >= RTF_MAX)
+	{
+		return;
+	}
+
+	snapshot->present[id] = TRUE;
+	snapshot->value[id] = value;
+	if (FieldDefs[id].decimals == 0)
+	{
+		snprintf(snapshot->text[id], REALTIME_TEXT_MAX, "%d", (int)value);
+	}
+	else
+	{
+		snprintf(snapshot->text[id], REALTIME_TEXT_MAX, "%.*f", FieldDefs[id].decimals, value);
+	}
+}
+
+void rtdataPublish(REALTIME_SNAPSHOT* snapshot)
+{
+	time_t      now = time(NULL);
+	int         fileLength, keyLength, updateLength, binaryLength;
+
+	fileLength = formatFile(snapshot, FileText);
+	writeRealTimeFile(REALTIME_JSON_FILE, FileText, fileLength);
+
+	Sequence ++;
+
+	if (BinaryEnabled)
+	{
+		if (!SchemaWritten)
+		{
+			writeSchemaFile();
+			SchemaWritten = TRUE;
+		}
+
+		binaryLength = formatBinary(snapshot, now, Binary);
+		writeRealTimeFile(REALTIME_CBOR_FILE, Binary, binaryLength);
+		rtserverPublishBinary(Binary, binaryLength);
+	}
+	keyLength = formatUpdate(snapshot, NULL, KeyText);
+
+	if (KeyframeInterval <= 0 || !HavePrevious ||
+		(now - LastKeyframe) >= KeyframeInterval || now < LastKeyframe)
+	{
+		LastKeyframe = now;
+		rtserverPublish(KeyText, keyLength, KeyText, keyLength);
+	}
+	else
+	{
+		updateLength = formatUpdate(snapshot, &Previous, UpdateText);
+		rtserverPublish(KeyText, keyLength, UpdateText, updateLength);
+	}
+
+	memcpy(&Previous, snapshot, sizeof(Previous));
+	HavePrevious = TRUE;
+}
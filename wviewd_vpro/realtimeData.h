@@ -0,0 +1,122 @@
+#ifndef INC_realtimeDatah
+#define INC_realtimeDatah
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		realtimeData.h
+
+  PURPOSE:
+		Build the realtime snapshot and its JSON keyframe/delta encodings.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		processRealTimeData fills a REALTIME_SNAPSHOT one field at a time;
+		rtdataPublish then writes realtimeparameterlist.txt (always the full
+		set) and hands the push server a keyframe plus the update for this
+		LOOP. With a keyframe interval set, the update between keyframes is
+		a delta: only the fields whose formatted value changed since the
+		previous LOOP, a field that went away is sent as null. Every update
+		carries "seq" (+1 per LOOP) and keyframes carry "keyframe":1, so a
+		client that sees a gap in seq waits for the next keyframe.
+
+		With CBOR enabled every LOOP is also encoded as (RFC 8949):
+			{ 0: REALTIME_SCHEMA_VERSION, 1: seq, 2: time (epoch secs),
+			  3: { field id: value * 10^decimals, ... } }
+		Values are integers scaled by the field's decimals so they round
+		trip exactly; realtimeschema.json lists id, name and decimals.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+/*  ... System include files
+*/
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*  ... Library include files
+*/
+#include <sysdefs.h>
+
+/*  ... some definitions
+*/
+#define REALTIME_TEXT_MAX           24
+#define REALTIME_SCHEMA_VERSION     1
+
+// the realtime fields, in output order; the value is the field id in the
+// binary encoding: add new fields at the end, never reorder or reuse
+typedef enum
+{
+	RTF_DUMMY = 0,                      // only when outsideTemp is missing
+	RTF_OUTSIDE_TEMP,
+	RTF_HI_OUTSIDE_TEMP,
+	RTF_LOW_OUTSIDE_TEMP,
+	RTF_OUTSIDE_DEWPT,
+	RTF_HI_DEWPOINT,
+	RTF_LOW_DEWPOINT,
+	RTF_EXTRA_TEMP1,
+	RTF_HI_EXTRA_TEMP1,
+	RTF_LOW_EXTRA_TEMP1,
+	RTF_DAILY_RAIN,
+	RTF_RAIN_RATE,
+	RTF_HI_RAIN_RATE,
+	RTF_STORM_RAIN,
+	RTF_STORM_START,
+	RTF_OUTSIDE_HUMIDITY,
+	RTF_HI_HUMIDITY,
+	RTF_LOW_HUMIDITY,
+	RTF_BAROMETER,
+	RTF_HI_BAROMETER,
+	RTF_LOW_BAROMETER,
+	RTF_WIND_SPEED,
+	RTF_WIND_GUST_SPEED,
+	RTF_TEN_MIN_WIND_GUST,
+	RTF_HI_WIND_SPEED,
+	RTF_WIND_DIR,
+	RTF_WIND_GUST_DIR,
+	RTF_TEN_MIN_WIND_GUST_DIR,
+	RTF_ET,
+	RTF_UV,
+	RTF_HI_UV,
+	RTF_SOLAR_RAD,
+	RTF_HI_RADIATION,
+	RTF_TEN_MIN_AVG_WIND_SPEED,
+	RTF_TWO_MIN_AVG_WIND_SPEED,
+	RTF_MAX
+} REALTIME_FIELD_ID;
+
+typedef struct
+{
+	int         present[RTF_MAX];
+	double      value[RTF_MAX];
+	char        text[RTF_MAX][REALTIME_TEXT_MAX];   // as formatted for JSON
+} REALTIME_SNAPSHOT;
+
+/* ... function prototypes
+*/
+
+// Seconds between keyframes on the push channel; 0 sends every update
+// as a keyframe (no deltas)
+extern void rtdataSetKeyframeInterval(int seconds);
+
+extern void rtdataClear(REALTIME_SNAPSHOT* snapshot);
+
+extern void rtdataSet(REALTIME_SNAPSHOT* snapshot, REALTIME_FIELD_ID id, double value);
+
+// Also write realtimeparameterlist.cbor and feed binary push clients
+extern void rtdataSetBinaryEnabled(int enabled);
+
+// Write the realtime file and publish this LOOP's update
+extern void rtdataPublish(REALTIME_SNAPSHOT* snapshot);
+
+#endif
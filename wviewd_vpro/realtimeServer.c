@@ -0,0 +1,859 @@
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		realtimeServer.c
+
+  PURPOSE:
+		Push realtime LOOP data to browsers over WebSocket and Server-Sent
+		Events.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		radProcess only gives us read callbacks, so sockets are non-blocking
+		and backpressure is handled at publish time: whatever part of an
+		update the kernel won't take is parked with the client and flushed
+		ahead of anything sent to it later (a handshake the kernel only
+		took part of is completed before the keyframe behind it). A client
+		that still has bytes parked simply misses updates and is sent the
+		keyframe once it has caught up, or is dropped after
+		RTSERVER_SKIP_MAX misses in a row.
+
+		radProcessWait watches descriptors with select(), so no client can
+		have a descriptor at or above FD_SETSIZE (usually 1024): the client
+		limit is capped below that, leaving RTSERVER_FD_RESERVE for the rest
+		of wviewd, and a connection that still lands above it is refused.
+		Refused connections are counted in wview_realtime_rejected_total.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+/*  ... System include files
+*/
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/*  ... Library include files
+*/
+#include <radprocess.h>
+
+/*  ... Local include files
+*/
+#include <realtimeServer.h>
+#include <metrics.h>
+#include <msglog.h>
+
+/*  ... global memory declarations
+*/
+
+/*  ... local memory
+*/
+#define RTSERVER_CLIENTS_DEFAULT    64
+#define RTSERVER_FD_RESERVE         64              // station, IPC, logs, sqlite
+#define RTSERVER_REQUEST_MAX        2048
+#define RTSERVER_FRAME_MAX          4096
+#define RTSERVER_PENDING_MAX        (2 * (RTSERVER_FRAME_MAX + 16)) // handshake + keyframe
+#define RTSERVER_REQUEST_TIMEOUT    10              // secs to send the request
+#define RTSERVER_SKIP_MAX           15              // updates missed in a row
+
+#define WEBSOCKET_GUID              "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+typedef enum
+{
+	CLIENT_FREE = 0,
+	CLIENT_REQUEST,
+	CLIENT_SSE,
+	CLIENT_WEBSOCKET,
+	CLIENT_WEBSOCKET_BINARY                         // GET /cbor: CBOR snapshots
+} CLIENT_STATE;
+
+typedef struct
+{
+	int             fd;
+	CLIENT_STATE    state;
+	time_t          opened;
+	int             length;
+	char            request[RTSERVER_REQUEST_MAX];
+	char*           pending;                        // unsent tail of an update
+	int             pendingLength;
+	int             skipped;
+} RTSERVER_CLIENT;
+
+static int                  ListenFd = -1;
+static RTSERVER_CLIENT*     Clients;
+static int                  ClientsMax;
+static time_t               LastRejectLog;
+
+// the latest keyframe and update, each encoded once per protocol:
+typedef struct
+{
+	char            sse[RTSERVER_FRAME_MAX + 16];
+	int             sseLength;
+	unsigned char   ws[RTSERVER_FRAME_MAX + 16];
+	int             wsLength;
+} RTSERVER_FRAMES;
+
+static RTSERVER_FRAMES      KeyFrames;
+static RTSERVER_FRAMES      UpdateFrames;
+static RTSERVER_FRAMES      BinaryFrames;                   // ws only
+
+
+//  ... SHA-1 and base64, just enough for Sec-WebSocket-Accept
+#define ROL32(x, n)         (((x) << (n)) | ((x) >> (32 - (n))))
+
+static void sha1Block(uint32_t state[5], const unsigned char* block)
+{
+	uint32_t    w[80], a, b, c, d, e, f, k, temp;
+	int         i;
+
+	for (i = 0; i < 16; i++)
+	{
+		w[i] = ((uint32_t)block[i*4] << 24) | ((uint32_t)block[i*4+1] << 16) |
+			((uint32_t)block[i*4+2] << 8) | (uint32_t)block[i*4+3];
+	}
+	for (i = 16; i < 80; i++)
+	{
+		w[i] = ROL32(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+	}
+
+	a = state[0]; b = state[1]; c = state[2]; d = state[3]; e = state[4];
+	for (i = 0; i < 80; i++)
+	{
+		if (i < 20)
+		{
+			f = (b & c) | ((~b) & d);
+			k = 0x5A827999;
+		}
+		else if (i < 40)
+		{
+			f = b ^ c ^ d;
+			k = 0x6ED9EBA1;
+		}
+		else if (i < 60)
+		{
+			f = (b & c) | (b & d) | (c & d);
+			k = 0x8F1BBCDC;
+		}
+		else
+		{
+			f = b ^ c ^ d;
+			k = 0xCA62C1D6;
+		}
+
+		temp = ROL32(a, 5) + f + e + k + w[i];
+		e = d;
+		d = c;
+		c = ROL32(b, 30);
+		b = a;
+		a = temp;
+	}
+
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d; state[4] += e;
+}
+
+static void sha1(const char* data, int length, unsigned char digest[20])
+{
+	uint32_t        state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+	unsigned char   block[64];
+	uint64_t        bits = (uint64_t)length * 8;
+	int             i, done;
+
+	for (done = 0; length - done >= 64; done += 64)
+	{
+		sha1Block(state, (const unsigned char*)data + done);
+	}
+
+	// pad: 0x80, zeros, then the 64-bit bit count
+	memset(block, 0, sizeof(block));
+	memcpy(block, data + done, length - done);
+	block[length - done] = 0x80;
+	if (length - done >= 56)
+	{
+		sha1Block(state, block);
+		memset(block, 0, sizeof(block));
+	}
+	for (i = 0; i < 8; i++)
+	{
+		block[63 - i] = (unsigned char)(bits >> (i * 8));
+	}
+	sha1Block(state, block);
+
+	for (i = 0; i < 20; i++)
+	{
+		digest[i] = (unsigned char)(state[i / 4] >> ((3 - (i % 4)) * 8));
+	}
+}
+
+static void base64Encode(const unsigned char* data, int length, char* store)
+{
+	static const char   alphabet[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	uint32_t            triple;
+	int                 i, out = 0;
+
+	for (i = 0; i < length; i += 3)
+	{
+		triple = (uint32_t)data[i] << 16;
+		if (i + 1 < length) triple |= (uint32_t)data[i+1] << 8;
+		if (i + 2 < length) triple |= (uint32_t)data[i+2];
+
+		store[out++] = alphabet[(triple >> 18) & 0x3F];
+		store[out++] = alphabet[(triple >> 12) & 0x3F];
+		store[out++] = ((i + 1 < length) ? alphabet[(triple >> 6) & 0x3F] : '=');
+		store[out++] = ((i + 2 < length) ? alphabet[triple & 0x3F] : '=');
+	}
+	store[out] = 0;
+}
+
+
+static int setNonBlocking(int fd)
+{
+	int         flags = fcntl(fd, F_GETFL, 0);
+
+	if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+	{
+		return ERROR;
+	}
+
+	return OK;
+}
+
+static void closeClient(RTSERVER_CLIENT* client)
+{
+	radProcessIODeRegisterDescriptor(client->fd);
+	close(client->fd);
+	client->fd = -1;
+	client->state = CLIENT_FREE;
+	client->length = 0;
+	client->pendingLength = 0;
+	client->skipped = 0;
+}
+
+static int flushPending(RTSERVER_CLIENT* client)
+{
+	int         retVal;
+
+	retVal = send(client->fd, client->pending, client->pendingLength, MSG_NOSIGNAL);
+	if (retVal < 0)
+	{
+		return ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? OK : ERROR);
+	}
+
+	client->pendingLength -= retVal;
+	if (client->pendingLength > 0)
+	{
+		memmove(client->pending, client->pending + retVal, client->pendingLength);
+	}
+	return OK;
+}
+
+//  ... send what the socket will take and park the rest; anything already
+//  ... parked goes first, so bytes always leave in the order queued;
+//  ... returns OK or ERROR if the client is gone (or too far behind)
+static int sendToClient(RTSERVER_CLIENT* client, const void* data, int length)
+{
+	int         retVal = 0;
+
+	if (client->pendingLength > 0)
+	{
+		if (flushPending(client) == ERROR)
+		{
+			return ERROR;
+		}
+	}
+
+	if (client->pendingLength == 0)
+	{
+		retVal = send(client->fd, data, length, MSG_NOSIGNAL);
+		if (retVal < 0)
+		{
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			{
+				return ERROR;
+			}
+			retVal = 0;
+		}
+	}
+
+	if (retVal < length)
+	{
+		if (client->pendingLength + length - retVal > RTSERVER_PENDING_MAX)
+		{
+			return ERROR;
+		}
+		if (client->pending == NULL)
+		{
+			client->pending = malloc(RTSERVER_PENDING_MAX);
+			if (client->pending == NULL)
+			{
+				return ERROR;
+			}
+		}
+		memcpy(client->pending + client->pendingLength,
+			(const char*)data + retVal, length - retVal);
+		client->pendingLength += length - retVal;
+	}
+
+	return OK;
+}
+
+static void sendFrames(RTSERVER_CLIENT* client, RTSERVER_FRAMES* frames)
+{
+	int         retVal = OK;
+
+	if (client->state == CLIENT_SSE && frames->sseLength > 0)
+	{
+		retVal = sendToClient(client, frames->sse, frames->sseLength);
+	}
+	else if (client->state != CLIENT_SSE && frames->wsLength > 0)
+	{
+		retVal = sendToClient(client, frames->ws, frames->wsLength);
+	}
+
+	if (retVal == ERROR)
+	{
+		closeClient(client);
+	}
+}
+
+static void sendUpdate
+(
+	RTSERVER_CLIENT*    client,
+	RTSERVER_FRAMES*    update,
+	RTSERVER_FRAMES*    keyframe
+)
+{
+	if (client->pendingLength > 0)
+	{
+		if (flushPending(client) == ERROR)
+		{
+			closeClient(client);
+			return;
+		}
+		if (client->pendingLength > 0)
+		{
+			// still backed up, this update is superseded before it's sent:
+			if (++client->skipped > RTSERVER_SKIP_MAX)
+			{
+				MsgLog(PRI_MEDIUM, "realtimeServer: dropping stalled client %d", client->fd);
+				closeClient(client);
+			}
+			return;
+		}
+	}
+
+	if (client->skipped > 0)
+	{
+		// it missed updates, resync it:
+		client->skipped = 0;
+		sendFrames(client, keyframe);
+		return;
+	}
+
+	sendFrames(client, update);
+}
+
+static void startWebSocket(RTSERVER_CLIENT* client, const char* keyHeader)
+{
+	char            key[128], accept[32], response[256];
+	unsigned char   digest[20];
+	int             length;
+
+	// Sec-WebSocket-Key: <key>\r\n
+	keyHeader += strlen("Sec-WebSocket-Key:");
+	while (*keyHeader == ' ')
+	{
+		keyHeader++;
+	}
+	for (length = 0;
+		 keyHeader[length] && keyHeader[length] != '\r' && keyHeader[length] != '\n' &&
+		 length < (int)(sizeof(key) - sizeof(WEBSOCKET_GUID));
+		 length++)
+	{
+		key[length] = keyHeader[length];
+	}
+	strcpy(&key[length], WEBSOCKET_GUID);
+
+	sha1(key, strlen(key), digest);
+	base64Encode(digest, sizeof(digest), accept);
+
+	length = sprintf(response, "HTTP/1.1 101 Switching Protocols\r\n"
+		"Upgrade: websocket\r\nConnection: Upgrade\r\n"
+		"Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+	if (sendToClient(client, response, length) == ERROR)
+	{
+		closeClient(client);
+		return;
+	}
+
+	if (!strncmp(client->request, "GET /cbor", 9))
+	{
+		client->state = CLIENT_WEBSOCKET_BINARY;
+		sendFrames(client, &BinaryFrames);
+	}
+	else
+	{
+		client->state = CLIENT_WEBSOCKET;
+		sendFrames(client, &KeyFrames);
+	}
+}
+
+static void startEventStream(RTSERVER_CLIENT* client)
+{
+	static const char   response[] = "HTTP/1.1 200 OK\r\n"
+		"Content-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+		"Connection: keep-alive\r\nAccess-Control-Allow-Origin: *\r\n\r\n";
+
+	if (sendToClient(client, response, sizeof(response) - 1) == ERROR)
+	{
+		closeClient(client);
+		return;
+	}
+
+	client->state = CLIENT_SSE;
+	sendFrames(client, &KeyFrames);
+}
+
+static void processRequest(RTSERVER_CLIENT* client)
+{
+	static const char   notFound[] = "HTTP/1.1 404 Not Found\r\n"
+		"Content-Length: 0\r\nConnection: close\r\n\r\n";
+	char*               keyHeader;
+
+	if (strncmp(client->request, "GET ", 4))
+	{
+		send(client->fd, notFound, sizeof(notFound) - 1, MSG_NOSIGNAL);
+		closeClient(client);
+		return;
+	}
+
+	keyHeader = strcasestr(client->request, "\nSec-WebSocket-Key:");
+	if (keyHeader != NULL && strcasestr(client->request, "websocket") != NULL)
+	{
+		startWebSocket(client, keyHeader + 1);
+	}
+	else if (!strncmp(client->request, "GET /events", 11) ||
+			 strcasestr(client->request, "text/event-stream") != NULL)
+	{
+		startEventStream(client);
+	}
+	else
+	{
+		send(client->fd, notFound, sizeof(notFound) - 1, MSG_NOSIGNAL);
+		closeClient(client);
+	}
+}
+
+//  ... handle what a WebSocket client sends us: close and ping, the rest
+//  ... (there shouldn't be any) is ignored
+static void processWebSocketInput(RTSERVER_CLIENT* client, unsigned char* data, int length)
+{
+	unsigned char   pong[2 + 125];
+	int             opcode, payload, i;
+
+	while (length >= 6)
+	{
+		opcode = data[0] & 0x0F;
+		payload = data[1] & 0x7F;
+		if (payload > 125 || length < 6 + payload)
+		{
+			// control frames are small; anything else we don't care about
+			return;
+		}
+
+		if (opcode == 0x8)
+		{
+			send(client->fd, "\x88\x00", 2, MSG_NOSIGNAL);
+			closeClient(client);
+			return;
+		}
+		if (opcode == 0x9)
+		{
+			pong[0] = 0x8A;
+			pong[1] = (unsigned char)payload;
+			for (i = 0; i < payload; i++)
+			{
+				pong[2 + i] = data[6 + i] ^ data[2 + (i % 4)];
+			}
+			if (sendToClient(client, pong, 2 + payload) == ERROR)
+			{
+				closeClient(client);
+				return;
+			}
+		}
+
+		data += 6 + payload;
+		length -= 6 + payload;
+	}
+}
+
+static void clientCallback(int fd, void* userData)
+{
+	RTSERVER_CLIENT*    client = (RTSERVER_CLIENT*)userData;
+	unsigned char       input[512];
+	int                 retVal;
+
+	if (client->state != CLIENT_REQUEST)
+	{
+		retVal = recv(fd, input, sizeof(input), 0);
+		if (retVal < 0 && (errno == EAGAIN || errno == EINTR))
+		{
+			return;
+		}
+		if (retVal <= 0)
+		{
+			closeClient(client);
+			return;
+		}
+		if (client->state != CLIENT_SSE)
+		{
+			processWebSocketInput(client, input, retVal);
+		}
+		return;
+	}
+
+	retVal = recv(fd, &client->request[client->length],
+		RTSERVER_REQUEST_MAX - 1 - client->length, 0);
+	if (retVal < 0 && (errno == EAGAIN || errno == EINTR))
+	{
+		return;
+	}
+	if (retVal <= 0)
+	{
+		closeClient(client);
+		return;
+	}
+
+	client->length += retVal;
+	client->request[client->length] = 0;
+
+	if (strstr(client->request, "\r\n\r\n") == NULL)
+	{
+		if (client->length >= RTSERVER_REQUEST_MAX - 1)
+		{
+			closeClient(client);
+		}
+		return;
+	}
+
+	processRequest(client);
+}
+
+//  ... build the SSE event and WebSocket text frame for 'json'
+static int encodeFrames(const char* json, int length, RTSERVER_FRAMES* frames)
+{
+	char        payload[RTSERVER_FRAME_MAX];
+	int         i, payloadLength = 0;
+
+	// one line: SSE ends an event at a blank line, and the JSON newlines
+	// are only whitespace between members
+	for (i = 0; i < length; i++)
+	{
+		if (json[i] == '\n' || json[i] == '\r')
+		{
+			continue;
+		}
+		if (payloadLength >= RTSERVER_FRAME_MAX)
+		{
+			MsgLog(PRI_MEDIUM, "rtserverPublish: update larger than %d bytes dropped",
+				RTSERVER_FRAME_MAX);
+			return ERROR;
+		}
+		payload[payloadLength++] = json[i];
+	}
+
+	frames->sseLength = sprintf(frames->sse, "data: ");
+	memcpy(&frames->sse[frames->sseLength], payload, payloadLength);
+	frames->sseLength += payloadLength;
+	frames->sse[frames->sseLength++] = '\n';
+	frames->sse[frames->sseLength++] = '\n';
+
+	// unmasked text frame, FIN set:
+	frames->ws[0] = 0x81;
+	if (payloadLength < 126)
+	{
+		frames->ws[1] = (unsigned char)payloadLength;
+		frames->wsLength = 2;
+	}
+	else
+	{
+		frames->ws[1] = 126;
+		frames->ws[2] = (unsigned char)(payloadLength >> 8);
+		frames->ws[3] = (unsigned char)payloadLength;
+		frames->wsLength = 4;
+	}
+	memcpy(&frames->ws[frames->wsLength], payload, payloadLength);
+	frames->wsLength += payloadLength;
+
+	return OK;
+}
+
+static void acceptCallback(int fd, void* userData)
+{
+	RTSERVER_CLIENT*    client = NULL;
+	time_t              now = time(NULL);
+	int                 newFd, i;
+
+	newFd = accept(fd, NULL, NULL);
+	if (newFd < 0)
+	{
+		return;
+	}
+
+	for (i = 0; i < ClientsMax; i++)
+	{
+		if (Clients[i].state == CLIENT_REQUEST &&
+			(now - Clients[i].opened) > RTSERVER_REQUEST_TIMEOUT)
+		{
+			closeClient(&Clients[i]);
+		}
+		if (client == NULL && Clients[i].state == CLIENT_FREE)
+		{
+			client = &Clients[i];
+		}
+	}
+
+	if (client == NULL || newFd >= FD_SETSIZE)
+	{
+		// full, or a descriptor radProcessWait's select() can't watch:
+		metricsAdd(METRIC_REALTIME_REJECTED, 1);
+		if ((now - LastRejectLog) >= 60)
+		{
+			MsgLog(PRI_MEDIUM, "realtimeServer: rejecting client (%s)",
+				((client == NULL) ? "client limit reached" : "descriptor beyond FD_SETSIZE"));
+			LastRejectLog = now;
+		}
+		close(newFd);
+		return;
+	}
+	if (setNonBlocking(newFd) == ERROR)
+	{
+		close(newFd);
+		return;
+	}
+
+	client->fd = newFd;
+	client->state = CLIENT_REQUEST;
+	client->opened = now;
+	client->length = 0;
+	client->pendingLength = 0;
+	client->skipped = 0;
+	if (radProcessIORegisterDescriptor(newFd, clientCallback, client) == ERROR)
+	{
+		close(newFd);
+		client->fd = -1;
+		client->state = CLIENT_FREE;
+	}
+}
+
+
+static void rtserverFreeClients(void)
+{
+	int         i;
+
+	for (i = 0; i < ClientsMax; i++)
+	{
+		free(Clients[i].pending);
+	}
+	free(Clients);
+	Clients = NULL;
+	ClientsMax = 0;
+}
+
+
+/*  ... API methods
+*/
+
+int rtserverInit(int port, int maxClients)
+{
+	struct sockaddr_in  addr;
+	int                 i, on = 1;
+
+	if (port <= 0)
+	{
+		return OK;
+	}
+
+	if (maxClients <= 0)
+	{
+		maxClients = RTSERVER_CLIENTS_DEFAULT;
+	}
+	if (maxClients > FD_SETSIZE - RTSERVER_FD_RESERVE)
+	{
+		MsgLog(PRI_MEDIUM, "rtserverInit: %d clients exceeds what select() can watch, using %d",
+			maxClients, FD_SETSIZE - RTSERVER_FD_RESERVE);
+		maxClients = FD_SETSIZE - RTSERVER_FD_RESERVE;
+	}
+
+	Clients = (RTSERVER_CLIENT*)calloc(maxClients, sizeof(RTSERVER_CLIENT));
+	if (Clients == NULL)
+	{
+		MsgLog(PRI_HIGH, "rtserverInit: cannot allocate %d clients", maxClients);
+		return ERROR;
+	}
+	ClientsMax = maxClients;
+	for (i = 0; i < ClientsMax; i++)
+	{
+		Clients[i].fd = -1;
+		Clients[i].state = CLIENT_FREE;
+	}
+
+	ListenFd = socket(AF_INET, SOCK_STREAM, 0);
+	if (ListenFd < 0)
+	{
+		MsgLog(PRI_HIGH, "rtserverInit: socket failed: %s", strerror(errno));
+		rtserverFreeClients();
+		return ERROR;
+	}
+
+	setsockopt(ListenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((uint16_t)port);
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+	if (bind(ListenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+		listen(ListenFd, 16) < 0 ||
+		setNonBlocking(ListenFd) == ERROR)
+	{
+		MsgLog(PRI_HIGH, "rtserverInit: cannot listen on port %d: %s",
+			port, strerror(errno));
+		close(ListenFd);
+		ListenFd = -1;
+		rtserverFreeClients();
+		return ERROR;
+	}
+
+	if (radProcessIORegisterDescriptor(ListenFd, acceptCallback, NULL) == ERROR)
+	{
+		MsgLog(PRI_HIGH, "rtserverInit: radProcessIORegisterDescriptor failed");
+		close(ListenFd);
+		ListenFd = -1;
+		rtserverFreeClients();
+		return ERROR;
+	}
+
+	MsgLog(PRI_STATUS, "realtime push: WebSocket and /events on port %d (%d clients)",
+		port, ClientsMax);
+	return OK;
+}
+
+void rtserverExit(void)
+{
+	int         i;
+
+	if (ListenFd < 0)
+	{
+		return;
+	}
+
+	for (i = 0; i < ClientsMax; i++)
+	{
+		if (Clients[i].state != CLIENT_FREE)
+		{
+			closeClient(&Clients[i]);
+		}
+	}
+
+	radProcessIODeRegisterDescriptor(ListenFd);
+	close(ListenFd);
+	ListenFd = -1;
+	rtserverFreeClients();
+}
+
+void rtserverPublish
+(
+	const char*     keyframe,
+	int             keyLength,
+	const char*     update,
+	int             updateLength
+)
+{
+	int         i;
+
+	if (ListenFd < 0)
+	{
+		return;
+	}
+
+	if (encodeFrames(keyframe, keyLength, &KeyFrames) == ERROR)
+	{
+		return;
+	}
+	if (update == keyframe)
+	{
+		memcpy(&UpdateFrames, &KeyFrames, sizeof(UpdateFrames));
+	}
+	else if (encodeFrames(update, updateLength, &UpdateFrames) == ERROR)
+	{
+		return;
+	}
+
+	for (i = 0; i < ClientsMax; i++)
+	{
+		if (Clients[i].state == CLIENT_SSE || Clients[i].state == CLIENT_WEBSOCKET)
+		{
+			sendUpdate(&Clients[i], &UpdateFrames, &KeyFrames);
+		}
+	}
+}
+
+void rtserverPublishBinary(const unsigned char* data, int length)
+{
+	int         i;
+
+	if (ListenFd < 0)
+	{
+		return;
+	}
+	if (length > RTSERVER_FRAME_MAX)
+	{
+		MsgLog(PRI_MEDIUM, "rtserverPublishBinary: update larger than %d bytes dropped",
+			RTSERVER_FRAME_MAX);
+		return;
+	}
+
+	// unmasked binary frame, FIN set:
+	BinaryFrames.ws[0] = 0x82;
+	if (length < 126)
+	{
+		BinaryFrames.ws[1] = (unsigned char)length;
+		BinaryFrames.wsLength = 2;
+	}
+	else
+	{
+		BinaryFrames.ws[1] = 126;
+		BinaryFrames.ws[2] = (unsigned char)(length >> 8);
+		BinaryFrames.ws[3] = (unsigned char)length;
+		BinaryFrames.wsLength = 4;
+	}
+	memcpy(&BinaryFrames.ws[BinaryFrames.wsLength], data, length);
+	BinaryFrames.wsLength += length;
+
+	// every binary update is a full snapshot, so it's its own keyframe:
+	for (i = 0; i < ClientsMax; i++)
+	{
+		if (Clients[i].state == CLIENT_WEBSOCKET_BINARY)
+		{
+			sendUpdate(&Clients[i], &BinaryFrames, &BinaryFrames);
+		}
+	}
+}
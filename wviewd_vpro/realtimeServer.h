@@ -0,0 +1,68 @@
+#ifndef INC_realtimeServerh
+#define INC_realtimeServerh
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		realtimeServer.h
+
+  PURPOSE:
+		Push realtime LOOP data to browsers over WebSocket and Server-Sent
+		Events.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		One port serves both protocols from the radProcessWait loop:
+			GET /events                         -> text/event-stream
+			GET /cbor with Upgrade: websocket   -> WebSocket (binary frames)
+			GET <any> with Upgrade: websocket   -> WebSocket (text frames)
+		Every message is one line of realtime JSON (see realtimeData.h); a
+		new subscriber, or one that missed updates, gets the latest
+		keyframe first and the published updates after that.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+/*  ... System include files
+*/
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*  ... Library include files
+*/
+#include <sysdefs.h>
+
+/* ... function prototypes
+*/
+
+// Listen on 'port' (all interfaces) for up to 'maxClients' subscribers
+// (0 for the default, capped to what select() can watch); port 0 leaves
+// the server disabled
+extern int rtserverInit(int port, int maxClients);
+
+extern void rtserverExit(void);
+
+// Encode 'update' once and fan it out to every subscriber; clients that
+// are still draining an earlier update skip this one. 'keyframe' is the
+// complete state as of this update (may be the same buffer)
+extern void rtserverPublish
+(
+	const char*     keyframe,
+	int             keyLength,
+	const char*     update,
+	int             updateLength
+);
+
+// Fan a binary (CBOR) snapshot out to the /cbor WebSocket clients
+extern void rtserverPublishBinary(const unsigned char* data, int length);
+
+#endif
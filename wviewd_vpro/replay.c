@@ -0,0 +1,599 @@
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		replay.c
+
+  PURPOSE:
+		Provide the station traffic capture and capture replay medium.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		Capture taps the read/write methods of an already initialized
+		medium, so everything vpifReadMessage and friends see (wakeups,
+		ACKs, LOOP/LOOP2 frames, DMPAFT headers and pages) is recorded with
+		a millisecond timestamp, in order. Each session records to its own
+		file, STATION_CAPTURE_FILE suffixed with the local start time
+		(.YYYYMMDD-HHMMSS).
+
+		Replay is a MEDIUM_TYPE_DEVICE medium backed by a pipe: each write
+		by the daemon consumes the next TX record of the capture and queues
+		the RX records that followed it into the pipe, which makes the
+		medium fd readable and drives the state machine just like a tty.
+		At captured latency the RX records are released by a radlib timer
+		(or by a blocking read that is waiting for them), never by sleeping
+		in the write.
+		Requests are not compared byte-for-byte (SETTIME and DMPAFT carry
+		the current time); replay stays deterministic as long as the daemon
+		takes the same path it took during the capture.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+/*  ... System include files
+*/
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#include <poll.h>
+
+/*  ... Library include files
+*/
+#include <radmsgLog.h>
+#include <radsysutils.h>
+
+/*  ... Local include files
+*/
+#include <services.h>
+#include <replay.h>
+#include <daemon.h>
+#include <station.h>
+
+/*  ... global memory declarations
+*/
+
+/*  ... local memory
+*/
+static MEDIUM_REPLAY    mediumReplay;
+
+// capture tap state - the tapped medium's own methods are saved here
+static struct
+{
+	FILE*       file;
+	int(*read)(WVIEW_MEDIUM* medium, void* bfr, int len, int timeout);
+	int(*readAvail)(WVIEW_MEDIUM* medium, void* bfr, int maxlen);
+	int(*write)(WVIEW_MEDIUM* medium, void* buffer, int length);
+	void(*exit)(WVIEW_MEDIUM* medium);
+} captureWork;
+
+static void replayFeedTimerHandler(void* parm);
+
+//////////////////////////////////////////////////////////////////////////////
+//  ... capture file utilities
+//////////////////////////////////////////////////////////////////////////////
+
+static int captureWriteRecord(FILE* file, int direction, void* data, int length)
+{
+	CAPTURE_REC_HDR     hdr;
+
+	hdr.msTime = radTimeGetMSSinceEpoch();
+	hdr.direction = direction;
+	hdr.length = length;
+
+	if (fwrite(&hdr, sizeof(hdr), 1, file) != 1 ||
+		fwrite(data, 1, length, file) != (size_t)length)
+	{
+		return ERROR;
+	}
+
+	// keep the capture usable if we go down hard:
+	fflush(file);
+	return OK;
+}
+
+// Returns: record length, 0 at end of capture or ERROR
+static int captureReadRecord(FILE* file, CAPTURE_REC_HDR* hdr, void* data, int maxLength)
+{
+	if (fread(hdr, sizeof(*hdr), 1, file) != 1)
+	{
+		return 0;
+	}
+
+	if (hdr->length > (uint32_t)maxLength)
+	{
+		return ERROR;
+	}
+
+	if (fread(data, 1, hdr->length, file) != hdr->length)
+	{
+		return 0;
+	}
+
+	return (int)hdr->length;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//  ... capture tap methods
+//////////////////////////////////////////////////////////////////////////////
+
+static int captureRead(WVIEW_MEDIUM* med, void* bfr, int len, int msTimeout)
+{
+	int         retVal;
+
+	retVal = (*captureWork.read)(med, bfr, len, msTimeout);
+	if (retVal > 0 && captureWork.file != NULL)
+	{
+		if (captureWriteRecord(captureWork.file, CAPTURE_DIR_RX, bfr, retVal) == ERROR)
+		{
+			MsgLog(PRI_HIGH, "capture: write failed: %s - capture stopped", strerror(errno));
+			fclose(captureWork.file);
+			captureWork.file = NULL;
+		}
+	}
+
+	return retVal;
+}
+
+static int captureReadAvail(WVIEW_MEDIUM* med, void* bfr, int maxlen)
+{
+	int         retVal;
+
+	retVal = (*captureWork.readAvail)(med, bfr, maxlen);
+	if (retVal > 0 && captureWork.file != NULL)
+	{
+		if (captureWriteRecord(captureWork.file, CAPTURE_DIR_RX, bfr, retVal) == ERROR)
+		{
+			MsgLog(PRI_HIGH, "capture: write failed: %s - capture stopped", strerror(errno));
+			fclose(captureWork.file);
+			captureWork.file = NULL;
+		}
+	}
+
+	return retVal;
+}
+
+static int captureWrite(WVIEW_MEDIUM* med, void* buffer, int length)
+{
+	int         retVal;
+
+	retVal = (*captureWork.write)(med, buffer, length);
+	if (retVal > 0 && captureWork.file != NULL)
+	{
+		if (captureWriteRecord(captureWork.file, CAPTURE_DIR_TX, buffer, retVal) == ERROR)
+		{
+			MsgLog(PRI_HIGH, "capture: write failed: %s - capture stopped", strerror(errno));
+			fclose(captureWork.file);
+			captureWork.file = NULL;
+		}
+	}
+
+	return retVal;
+}
+
+static void captureExit(WVIEW_MEDIUM* med)
+{
+	if (captureWork.file != NULL)
+	{
+		fclose(captureWork.file);
+		captureWork.file = NULL;
+	}
+
+	(*captureWork.exit)(med);
+	return;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//  ... replay medium callback functions
+//////////////////////////////////////////////////////////////////////////////
+
+static int replayInit(WVIEW_MEDIUM* med, char* deviceName)
+{
+	MEDIUM_REPLAY*      work = (MEDIUM_REPLAY*)med->workData;
+	CAPTURE_FILE_HDR    hdr;
+
+	work->file = fopen(deviceName, "r");
+	if (work->file == NULL)
+	{
+		MsgLog(PRI_CATASTROPHIC, "replay: capture file %s failed to open: %s",
+			deviceName, strerror(errno));
+		return ERROR;
+	}
+
+	if (fread(&hdr, sizeof(hdr), 1, work->file) != 1 ||
+		hdr.magic != CAPTURE_FILE_MAGIC ||
+		hdr.version != CAPTURE_FILE_VERSION)
+	{
+		MsgLog(PRI_CATASTROPHIC, "replay: %s is not a wview capture file", deviceName);
+		fclose(work->file);
+		work->file = NULL;
+		return ERROR;
+	}
+
+	if (pipe(work->pipeFds) == -1)
+	{
+		MsgLog(PRI_CATASTROPHIC, "replay: pipe failed: %s", strerror(errno));
+		fclose(work->file);
+		work->file = NULL;
+		return ERROR;
+	}
+
+	fcntl(work->pipeFds[0], F_SETFL, fcntl(work->pipeFds[0], F_GETFL) | O_NONBLOCK);
+	fcntl(work->pipeFds[1], F_SETFL, fcntl(work->pipeFds[1], F_GETFL) | O_NONBLOCK);
+
+	work->feedTimer = radTimerCreate(NULL, replayFeedTimerHandler, NULL);
+	if (work->feedTimer == NULL)
+	{
+		MsgLog(PRI_CATASTROPHIC, "replay: radTimerCreate failed");
+		close(work->pipeFds[0]);
+		close(work->pipeFds[1]);
+		fclose(work->file);
+		work->file = NULL;
+		return ERROR;
+	}
+
+	med->fd = work->pipeFds[0];
+	work->exhausted = FALSE;
+	work->recCount = 0;
+	work->parkedLength = 0;
+
+	// Save the capture name:
+	wvstrncpy(work->path, deviceName, sizeof(work->path));
+
+	MsgLog(PRI_STATUS, "replay: playing %s at %s", deviceName,
+		((work->speed > 0) ? "captured latency" : "full speed"));
+	if (work->speed > 1)
+	{
+		MsgLog(PRI_STATUS, "replay: latency scaled by 1/%d", work->speed);
+	}
+
+	return OK;
+}
+
+static void replayExit(WVIEW_MEDIUM* med)
+{
+	MEDIUM_REPLAY*      work = (MEDIUM_REPLAY*)med->workData;
+
+	if (work->feedTimer != NULL)
+	{
+		radTimerDelete(work->feedTimer);
+		work->feedTimer = NULL;
+	}
+	if (work->file != NULL)
+	{
+		fclose(work->file);
+		work->file = NULL;
+	}
+	if (med->fd != -1)
+	{
+		close(work->pipeFds[0]);
+		close(work->pipeFds[1]);
+		med->fd = -1;
+	}
+
+	MsgLog(PRI_STATUS, "replay: %ld records replayed from %s",
+		work->recCount, work->path);
+	return;
+}
+
+static int replayRestart(WVIEW_MEDIUM* med)
+{
+	// nothing to reopen - the capture just keeps playing
+	MsgLog(PRI_MEDIUM, "replayRestart: ignored");
+	return OK;
+}
+
+// Park the next RX record of the current response, timed from the one
+// before it; leaves 'parkedLength' 0 when the response is complete
+static void replayParkNext(MEDIUM_REPLAY* work)
+{
+	CAPTURE_REC_HDR     hdr;
+	long                nextRec;
+	int                 retVal;
+
+	work->parkedLength = 0;
+
+	nextRec = ftell(work->file);
+	retVal = captureReadRecord(work->file, &hdr, work->parked, sizeof(work->parked));
+	if (retVal <= 0 || hdr.direction != CAPTURE_DIR_RX)
+	{
+		// leave the next request for the next write
+		fseek(work->file, nextRec, SEEK_SET);
+		return;
+	}
+	work->recCount ++;
+
+	if (work->speed > 0 && hdr.msTime > work->lastMsTime)
+	{
+		work->dueTime += (hdr.msTime - work->lastMsTime) / work->speed;
+	}
+	work->lastMsTime = hdr.msTime;
+	work->parkedLength = retVal;
+	return;
+}
+
+// Queue parked RX records into the pipe until one is not due yet (all of
+// them if 'flushAll'); returns the ms until that one is due or -1 when the
+// response is complete
+static int replayFeed(MEDIUM_REPLAY* work, int flushAll)
+{
+	uint64_t            now = radTimeGetMSSinceEpoch();
+
+	while (work->parkedLength > 0)
+	{
+		if (!flushAll && work->dueTime > now)
+		{
+			return (int)(work->dueTime - now);
+		}
+
+		if (write(work->pipeFds[1], work->parked, work->parkedLength) != work->parkedLength)
+		{
+			MsgLog(PRI_MEDIUM, "replay: response dropped (%d bytes): %s",
+				work->parkedLength, strerror(errno));
+		}
+
+		replayParkNext(work);
+	}
+
+	return -1;
+}
+
+static void replayFeedTimerHandler(void* parm)
+{
+	MEDIUM_REPLAY*      work = &mediumReplay;
+	int                 msDue;
+
+	msDue = replayFeed(work, FALSE);
+	if (msDue >= 0)
+	{
+		radTimerStart(work->feedTimer, ((msDue > 0) ? msDue : 1));
+	}
+}
+
+// Consume the next TX record, then park the RX records that answered it;
+// they are fed to the pipe from the feed timer at the captured latency so
+// the process event loop never sleeps on them
+static int replayWrite(WVIEW_MEDIUM* med, void* buffer, int length)
+{
+	MEDIUM_REPLAY*      work = (MEDIUM_REPLAY*)med->workData;
+	CAPTURE_REC_HDR     hdr;
+	int                 retVal, msDue;
+
+	if (work->exhausted)
+	{
+		return length;
+	}
+
+	// the daemon moved on before the last response was complete:
+	radTimerStop(work->feedTimer);
+	replayFeed(work, TRUE);
+
+	// skip to and past the next request:
+	do
+	{
+		retVal = captureReadRecord(work->file, &hdr, work->parked, sizeof(work->parked));
+		if (retVal == ERROR)
+		{
+			MsgLog(PRI_HIGH, "replay: corrupt record in %s", work->path);
+			work->exhausted = TRUE;
+			return length;
+		}
+		else if (retVal > 0)
+		{
+			work->recCount ++;
+		}
+	} while (retVal > 0 && hdr.direction != CAPTURE_DIR_TX);
+
+	if (retVal == 0)
+	{
+		MsgLog(PRI_STATUS, "replay: end of capture %s after %ld records",
+			work->path, work->recCount);
+		work->exhausted = TRUE;
+		return length;
+	}
+
+	// responses are timed from the request:
+	work->lastMsTime = hdr.msTime;
+	work->dueTime = radTimeGetMSSinceEpoch();
+	replayParkNext(work);
+
+	msDue = replayFeed(work, FALSE);
+	if (msDue >= 0)
+	{
+		radTimerStart(work->feedTimer, ((msDue > 0) ? msDue : 1));
+	}
+
+	return length;
+}
+
+// A blocking read cannot wait for the feed timer, so it feeds the parked
+// response itself as it comes due
+static int replayReadExact(WVIEW_MEDIUM* med, void* bfr, int len, int msTimeout)
+{
+	MEDIUM_REPLAY*  work = (MEDIUM_REPLAY*)med->workData;
+	int             rval, msLeft, msDue, index = 0;
+	int64_t         endTime = (int64_t)radTimeGetMSSinceEpoch() + msTimeout;
+	uint8_t*        ptr = (uint8_t*)bfr;
+	struct pollfd   pfd;
+
+	while (index < len)
+	{
+		msDue = replayFeed(work, FALSE);
+
+		rval = read(med->fd, &ptr[index], len - index);
+		if (rval < 0)
+		{
+			if (errno != EINTR && errno != EAGAIN)
+			{
+				return ERROR;
+			}
+		}
+		else
+		{
+			index += rval;
+		}
+
+		if (index == len)
+		{
+			break;
+		}
+
+		msLeft = (int)(endTime - (int64_t)radTimeGetMSSinceEpoch());
+		if (msLeft <= 0)
+		{
+			break;
+		}
+
+		if (msDue >= 0 && msDue < msLeft)
+		{
+			msLeft = msDue;
+		}
+
+		pfd.fd = med->fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, msLeft) < 0 && errno != EINTR)
+		{
+			return ERROR;
+		}
+	}
+
+	return ((index == len) ? len : ERROR);
+}
+
+static int replayReadAvail(WVIEW_MEDIUM* med, void* bfr, int maxlen)
+{
+	int         rval;
+
+	rval = read(med->fd, bfr, maxlen);
+	if (rval < 0)
+	{
+		if (errno != EINTR && errno != EAGAIN)
+		{
+			return ERROR;
+		}
+
+		return 0;
+	}
+
+	return rval;
+}
+
+static void replayFlush(WVIEW_MEDIUM* med, int queue)
+{
+	uint8_t     data[256];
+
+	if (queue == WV_QUEUE_INPUT)
+	{
+		while (read(med->fd, data, sizeof(data)) > 0)
+		{
+			// discard
+		}
+	}
+
+	return;
+}
+
+static void replayDrain(WVIEW_MEDIUM* med)
+{
+	return;
+}
+
+static RADSOCK_ID replayGetSocket(WVIEW_MEDIUM* med)
+{
+	return NULL;
+}
+
+// ... ----- API methods -----
+
+int replayMediumInit(WVIEW_MEDIUM* medium, int speed)
+{
+	MEDIUM_REPLAY*       work = &mediumReplay;
+
+	memset(medium, 0, sizeof(*medium));
+	memset(work, 0, sizeof(*work));
+
+	work->speed = speed;
+	work->pipeFds[0] = work->pipeFds[1] = -1;
+
+	medium->type = MEDIUM_TYPE_DEVICE;
+	medium->fd = -1;
+
+	// set our workData pointer for later use
+	medium->workData = (void*)work;
+
+	medium->init = replayInit;
+	medium->exit = replayExit;
+	medium->restart = replayRestart;
+	medium->read = replayReadExact;
+	medium->readAvail = replayReadAvail;
+	medium->write = replayWrite;
+	medium->flush = replayFlush;
+	medium->txdrain = replayDrain;
+	medium->getsocket = replayGetSocket;
+
+	return OK;
+}
+
+int replayCaptureStart(WVIEW_MEDIUM* medium, char* captureFile)
+{
+	CAPTURE_FILE_HDR    hdr;
+	time_t              now;
+	struct tm           locTime;
+	char                stamp[32];
+	char                path[WVIEW_MAX_PATH];
+
+	if (captureWork.file != NULL)
+	{
+		return OK;
+	}
+
+	// one file per session so a restart never clobbers the last capture
+	now = time(NULL);
+	localtime_r(&now, &locTime);
+	strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &locTime);
+	snprintf(path, sizeof(path), "%s.%s", captureFile, stamp);
+
+	captureWork.file = fopen(path, "w");
+	if (captureWork.file == NULL)
+	{
+		MsgLog(PRI_HIGH, "capture: %s failed to open: %s",
+			path, strerror(errno));
+		return ERROR;
+	}
+
+	hdr.magic = CAPTURE_FILE_MAGIC;
+	hdr.version = CAPTURE_FILE_VERSION;
+	if (fwrite(&hdr, sizeof(hdr), 1, captureWork.file) != 1)
+	{
+		MsgLog(PRI_HIGH, "capture: %s header write failed", path);
+		fclose(captureWork.file);
+		captureWork.file = NULL;
+		return ERROR;
+	}
+
+	captureWork.read = medium->read;
+	captureWork.readAvail = medium->readAvail;
+	captureWork.write = medium->write;
+	captureWork.exit = medium->exit;
+
+	medium->read = captureRead;
+	medium->readAvail = captureReadAvail;
+	medium->write = captureWrite;
+	medium->exit = captureExit;
+
+	MsgLog(PRI_STATUS, "capture: recording station traffic to %s", path);
+	return OK;
+}
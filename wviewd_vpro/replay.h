@@ -0,0 +1,103 @@
+#ifndef INC_replayh
+#define INC_replayh
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		replay.h
+
+  PURPOSE:
+		Provide the station traffic capture and capture replay medium.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		A capture file is a CAPTURE_FILE_HDR followed by CAPTURE_REC_HDR
+		records, each immediately followed by 'length' data bytes. All
+		fields are in host byte order; captures are not meant to be moved
+		between hosts of different endianness.
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+/*  ... System include files
+*/
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <string.h>
+
+/*  ... Library include files
+*/
+#include <sysdefs.h>
+#include <radtimeUtils.h>
+#include <radtimers.h>
+
+/*  ... Local include files
+*/
+#include <datadefs.h>
+#include <dbsqlite.h>
+#include <daemon.h>
+#include <station.h>
+
+/*  ... some definitions
+*/
+#define CAPTURE_FILE_MAGIC          0x50435657      // "WVCP"
+#define CAPTURE_FILE_VERSION        1
+
+typedef enum
+{
+	CAPTURE_DIR_TX = 1,                             // daemon -> station
+	CAPTURE_DIR_RX                                  // station -> daemon
+} CAPTURE_DIRECTION;
+
+typedef struct
+{
+	uint32_t    magic;
+	uint32_t    version;
+} CAPTURE_FILE_HDR;
+
+typedef struct
+{
+	uint64_t    msTime;                             // ms since epoch
+	uint32_t    direction;                          // CAPTURE_DIRECTION
+	uint32_t    length;                             // data bytes to follow
+} CAPTURE_REC_HDR;
+
+// define our work area
+typedef struct
+{
+	FILE*       file;
+	int         pipeFds[2];                         // [0] is the medium fd
+	int         speed;                              // 0 = as fast as possible
+	int         exhausted;
+	long        recCount;
+	TIMER_ID    feedTimer;                          // feeds delayed responses
+	uint64_t    lastMsTime;                         // capture time of 'parked'
+	uint64_t    dueTime;                            // when 'parked' is due
+	int         parkedLength;                       // 0 = response complete
+	uint8_t     parked[SERIAL_BYTE_LENGTH_MAX];     // next RX record
+	char        path[WVIEW_MAX_PATH];
+} MEDIUM_REPLAY;
+
+/* ... function prototypes
+*/
+
+// Replay medium: the 'deviceName' passed to medium->init is the capture file;
+// 'speed' is the real-time multiplier for station response latency
+// (1 = as captured, 0 = as fast as possible)
+extern int replayMediumInit(WVIEW_MEDIUM* medium, int speed);
+
+// Tap an initialized medium so all traffic through it is recorded to
+// 'captureFile'.YYYYMMDD-HHMMSS; the capture is closed when the medium exits
+extern int replayCaptureStart(WVIEW_MEDIUM* medium, char* captureFile);
+
+#endif
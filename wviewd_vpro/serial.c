@@ -16,6 +16,7 @@
 		xxxMediumInit    - sets up function pointers and work area
 		xxxInit          - opens the interface and configures it
 		xxxRead          - blocking read until specified bytes are read
+		xxxReadAvail     - non-blocking read of whatever bytes are queued
 		xxxWrite         - write on medium
 		xxxExit          - cleanup and close interface
 
@@ -45,6 +46,7 @@
 #include <time.h>
 #include <errno.h>
 #include <math.h>
+#include <poll.h>
 
 /*  ... Library include files
 */
@@ -161,13 +163,13 @@ static int serialWrite(WVIEW_MEDIUM* med, void* buffer, int length)
 
 static int serialReadExact(WVIEW_MEDIUM* med, void* bfr, int len, int msTimeout)
 {
-	int         rval, cumTime = 0, index = 0;
-	uint64_t    readTime;
-	uint8_t*     ptr = (uint8_t*)bfr;
+	int             rval, msLeft, index = 0;
+	int64_t         endTime = (int64_t)radTimeGetMSSinceEpoch() + msTimeout;
+	uint8_t*        ptr = (uint8_t*)bfr;
+	struct pollfd   pfd;
 
-	while (index < len && cumTime < msTimeout)
+	while (index < len)
 	{
-		readTime = radTimeGetMSSinceEpoch();
 		rval = read(med->fd, &ptr[index], len - index);
 		if (rval < 0)
 		{
@@ -181,20 +183,48 @@ static int serialReadExact(WVIEW_MEDIUM* med, void* bfr, int len, int msTimeout)
 			index += rval;
 		}
 
-		readTime = radTimeGetMSSinceEpoch() - readTime;
-		cumTime += (int)readTime;
-		if (index < len && cumTime < msTimeout)
+		if (index == len)
 		{
-			readTime = radTimeGetMSSinceEpoch();
-			radUtilsSleep(9);
-			readTime = radTimeGetMSSinceEpoch() - readTime;
-			cumTime += (int)readTime;
+			break;
+		}
+
+		// block until more bytes arrive (or we time out)
+		msLeft = (int)(endTime - (int64_t)radTimeGetMSSinceEpoch());
+		if (msLeft <= 0)
+		{
+			break;
+		}
+
+		pfd.fd = med->fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, msLeft) < 0 && errno != EINTR)
+		{
+			return ERROR;
 		}
 	}
 
 	return ((index == len) ? len : ERROR);
 }
 
+static int serialReadAvail(WVIEW_MEDIUM* med, void* bfr, int maxlen)
+{
+	int         rval;
+
+	rval = read(med->fd, bfr, maxlen);
+	if (rval < 0)
+	{
+		if (errno != EINTR && errno != EAGAIN)
+		{
+			return ERROR;
+		}
+
+		return 0;
+	}
+
+	return rval;
+}
+
 static void serialFlush(WVIEW_MEDIUM* med, int queue)
 {
 	if (queue == WV_QUEUE_INPUT)
@@ -241,6 +271,7 @@ int serialMediumInit(WVIEW_MEDIUM* medium, void(*portInit)(int fd), int openFlag
 	medium->exit = serialExit;
 	medium->restart = serialRestart;
 	medium->read = serialReadExact;
+	medium->readAvail = serialReadAvail;
 	medium->write = serialWrite;
 	medium->flush = serialFlush;
 	medium->txdrain = serialDrain;
@@ -61,8 +61,8 @@ int stationSendShutdown(WVIEWD_WORK* work)
 int stationSendArchiveNotifications(WVIEWD_WORK* work, float sampleRain)
 {
 	WVIEW_MSG_ARCHIVE_NOTIFY    notify;
-	int                         retVal;
-	HISTORY_DATA                store;
+	int                         i, retVal;
+	HISTORY_DATA                store[24];
 
 	notify.dateTime = work->archiveDateTime;
 	notify.intemp = (int)floorf(work->loopPkt.inTemp * 10);
@@ -81,33 +81,30 @@ int stationSendArchiveNotifications(WVIEWD_WORK* work, float sampleRain)
 	notify.UV = work->loopPkt.UV;
 	notify.radiation = work->loopPkt.radiation;
 
-	// Grab last 60 minutes and last 24 hours from database:
-	retVal = dbsqliteArchiveGetAverages(FALSE,
-		work->archiveInterval,
-		&store,
-		time(NULL) - WV_SECONDS_IN_HOUR,
-		WV_SECONDS_IN_HOUR / SECONDS_IN_INTERVAL(work->archiveInterval));
-	if (retVal <= 0)
-	{
-		notify.rainHour = ARCHIVE_VALUE_NULL;
-	}
-	else
-	{
-		notify.rainHour = store.values[DATA_INDEX_rain];
-	}
-
-	retVal = dbsqliteArchiveGetAverages(FALSE,
-		work->archiveInterval,
-		&store,
+	// Grab the last 24 hours from database as hourly buckets - the last
+	// bucket is the last 60 minutes:
+	notify.rainHour = ARCHIVE_VALUE_NULL;
+	notify.rainDay = ARCHIVE_VALUE_NULL;
+	retVal = dbsqliteArchiveGetAveragesRange(FALSE,
+		store,
 		time(NULL) - WV_SECONDS_IN_DAY,
-		WV_SECONDS_IN_DAY / SECONDS_IN_INTERVAL(work->archiveInterval));
-	if (retVal <= 0)
-	{
-		notify.rainDay = ARCHIVE_VALUE_NULL;
-	}
-	else
+		WV_SECONDS_IN_HOUR,
+		24);
+	if (retVal > 0)
 	{
-		notify.rainDay = store.values[DATA_INDEX_rain];
+		for (i = 0; i < 24; i++)
+		{
+			if (store[i].samples[DATA_INDEX_rain] == 0)
+			{
+				continue;
+			}
+			if (notify.rainDay <= ARCHIVE_VALUE_NULL)
+			{
+				notify.rainDay = 0;
+			}
+			notify.rainDay += store[i].values[DATA_INDEX_rain];
+		}
+		notify.rainHour = store[23].values[DATA_INDEX_rain];
 	}
 
 	notify.rainToday = sensorGetCumulative(&work->sensors.sensor[STF_DAY][SENSOR_RAIN]);
@@ -177,187 +174,181 @@ int stationProcessInfoResponses(WVIEWD_WORK* work)
 void processRealTimeData(LOOP_PKT loopData, WV_SENSOR sensor[STF_MAX][SENSOR_MAX]);
 void processRealTimeData(LOOP_PKT loopData, WV_SENSOR sensor[STF_MAX][SENSOR_MAX])
 {
-	FILE *ficheiro3;
+	static REALTIME_SNAPSHOT snapshot;
 	float high;
 	float low;
 	int windSpeedF=FALSE;
 	int windGustF=FALSE;
 	int tenMinuteWindGust=FALSE;
 
-	ficheiro3 = fopen("/var/lib/wview/img/ramdisk/json/realtimeparameterlist.txt", "w");
-	if (ficheiro3 != NULL) {
-
+	rtdataClear(&snapshot);
 
-		if (loopData.outTemp != ARCHIVE_VALUE_NULL) {			
-			fprintf(ficheiro3, "{\n");
-			fprintf(ficheiro3, "\"outsideTemp\":%.1f", wvutilsConvertFToC(loopData.outTemp));
-			high = wvutilsConvertFToC(sensorGetDailyHigh(sensor, SENSOR_OUTTEMP));
-			low = wvutilsConvertFToC(sensorGetDailyLow(sensor, SENSOR_OUTTEMP));
-			if (high < wvutilsConvertFToC(loopData.outTemp)) {
-				high = wvutilsConvertFToC(loopData.outTemp);
-				sensorUpdate(&sensor[STF_DAY][SENSOR_OUTTEMP], loopData.outTemp);
-			}
-			if (low > wvutilsConvertFToC(loopData.outTemp)) {
-				low = wvutilsConvertFToC(loopData.outTemp);
-				sensorUpdate(&sensor[STF_DAY][SENSOR_OUTTEMP], loopData.outTemp);
-			}
-			fprintf(ficheiro3, ",\n\"hiOutsideTemp\":%.1f", high);
-			fprintf(ficheiro3, ",\n\"lowOutsideTemp\":%.1f", low);
-		} else {
-			fprintf(ficheiro3, "{\n\"dummy\":0");
+	if (loopData.outTemp != ARCHIVE_VALUE_NULL) {			
+		rtdataSet(&snapshot, RTF_OUTSIDE_TEMP, wvutilsConvertFToC(loopData.outTemp));
+		high = wvutilsConvertFToC(sensorGetDailyHigh(sensor, SENSOR_OUTTEMP));
+		low = wvutilsConvertFToC(sensorGetDailyLow(sensor, SENSOR_OUTTEMP));
+		if (high < wvutilsConvertFToC(loopData.outTemp)) {
+			high = wvutilsConvertFToC(loopData.outTemp);
+			sensorUpdate(&sensor[STF_DAY][SENSOR_OUTTEMP], loopData.outTemp);
 		}
-		
+		if (low > wvutilsConvertFToC(loopData.outTemp)) {
+			low = wvutilsConvertFToC(loopData.outTemp);
+			sensorUpdate(&sensor[STF_DAY][SENSOR_OUTTEMP], loopData.outTemp);
+		}
+		rtdataSet(&snapshot, RTF_HI_OUTSIDE_TEMP, high);
+		rtdataSet(&snapshot, RTF_LOW_OUTSIDE_TEMP, low);
+	} else {
+		rtdataSet(&snapshot, RTF_DUMMY, 0);
+	}
+	
 
-		if  (loopData.dewpoint != ARCHIVE_VALUE_NULL) {
-			fprintf(ficheiro3, ",\n\"outsideDewPt\":%.1f", wvutilsConvertFToC(loopData.dewpoint));
-			high = wvutilsConvertFToC(sensorGetDailyHigh(sensor, SENSOR_DEWPOINT));
-			low = wvutilsConvertFToC(sensorGetDailyLow(sensor, SENSOR_DEWPOINT));
-			if (high < wvutilsConvertFToC(loopData.dewpoint)) {
-				high = wvutilsConvertFToC(loopData.dewpoint);
-				sensorUpdate(&sensor[STF_DAY][SENSOR_DEWPOINT], loopData.dewpoint);
-			}
-			if (low > wvutilsConvertFToC(loopData.dewpoint)) {
-				low = wvutilsConvertFToC(loopData.dewpoint);
-				sensorUpdate(&sensor[STF_DAY][SENSOR_DEWPOINT], loopData.dewpoint);
-			}
-			fprintf(ficheiro3, ",\n\"hiDewpoint\":%.1f", high);
-			fprintf(ficheiro3, ",\n\"lowDewpoint\":%.1f", low);
+	if  (loopData.dewpoint != ARCHIVE_VALUE_NULL) {
+		rtdataSet(&snapshot, RTF_OUTSIDE_DEWPT, wvutilsConvertFToC(loopData.dewpoint));
+		high = wvutilsConvertFToC(sensorGetDailyHigh(sensor, SENSOR_DEWPOINT));
+		low = wvutilsConvertFToC(sensorGetDailyLow(sensor, SENSOR_DEWPOINT));
+		if (high < wvutilsConvertFToC(loopData.dewpoint)) {
+			high = wvutilsConvertFToC(loopData.dewpoint);
+			sensorUpdate(&sensor[STF_DAY][SENSOR_DEWPOINT], loopData.dewpoint);
+		}
+		if (low > wvutilsConvertFToC(loopData.dewpoint)) {
+			low = wvutilsConvertFToC(loopData.dewpoint);
+			sensorUpdate(&sensor[STF_DAY][SENSOR_DEWPOINT], loopData.dewpoint);
 		}
+		rtdataSet(&snapshot, RTF_HI_DEWPOINT, high);
+		rtdataSet(&snapshot, RTF_LOW_DEWPOINT, low);
+	}
 
-		if  (loopData.extraTemp[0] != ARCHIVE_VALUE_NULL) {
-			fprintf(ficheiro3, ",\n\"extraTemp1\":%.1f", wvutilsConvertFToC(loopData.extraTemp[0]));
-			high = wvutilsConvertFToC(sensorGetDailyHigh(sensor, SENSOR_EXTRATEMP1));
-			low = wvutilsConvertFToC(sensorGetDailyLow(sensor, SENSOR_EXTRATEMP1));
-			if (high < wvutilsConvertFToC(loopData.extraTemp[0])) {
-				high = wvutilsConvertFToC(loopData.extraTemp[0]);
-				sensorUpdate(&sensor[STF_DAY][SENSOR_EXTRATEMP1], loopData.extraTemp[0]);
-			}
-			if (low > wvutilsConvertFToC(loopData.extraTemp[0])) {
-				low = wvutilsConvertFToC(loopData.extraTemp[0]);
-				sensorUpdate(&sensor[STF_DAY][SENSOR_EXTRATEMP1], loopData.extraTemp[0]);
-			}
-			fprintf(ficheiro3, ",\n\"hiOutsideATemp\":%.1f", high);
-			fprintf(ficheiro3, ",\n\"lowOutsideATemp\":%.1f", low);
+	if  (loopData.extraTemp[0] != ARCHIVE_VALUE_NULL) {
+		rtdataSet(&snapshot, RTF_EXTRA_TEMP1, wvutilsConvertFToC(loopData.extraTemp[0]));
+		high = wvutilsConvertFToC(sensorGetDailyHigh(sensor, SENSOR_EXTRATEMP1));
+		low = wvutilsConvertFToC(sensorGetDailyLow(sensor, SENSOR_EXTRATEMP1));
+		if (high < wvutilsConvertFToC(loopData.extraTemp[0])) {
+			high = wvutilsConvertFToC(loopData.extraTemp[0]);
+			sensorUpdate(&sensor[STF_DAY][SENSOR_EXTRATEMP1], loopData.extraTemp[0]);
+		}
+		if (low > wvutilsConvertFToC(loopData.extraTemp[0])) {
+			low = wvutilsConvertFToC(loopData.extraTemp[0]);
+			sensorUpdate(&sensor[STF_DAY][SENSOR_EXTRATEMP1], loopData.extraTemp[0]);
 		}
+		rtdataSet(&snapshot, RTF_HI_EXTRA_TEMP1, high);
+		rtdataSet(&snapshot, RTF_LOW_EXTRA_TEMP1, low);
+	}
 
-		fprintf(ficheiro3, ",\n\"dailyRain\":%.1f", wvutilsConvertRainINToMetric(loopData.dayRain));
-		fprintf(ficheiro3, ",\n\"rainRate\":%.1f", wvutilsConvertRainINToMetric(loopData.rainRate));
-		high = wvutilsConvertRainINToMetric(sensorGetDailyHigh(sensor, SENSOR_RAINRATE));
-		if (high < wvutilsConvertRainINToMetric(loopData.rainRate)) {
-			high = wvutilsConvertRainINToMetric(loopData.rainRate);
-			sensorUpdate(&sensor[STF_DAY][SENSOR_RAINRATE], loopData.rainRate);
+	rtdataSet(&snapshot, RTF_DAILY_RAIN, wvutilsConvertRainINToMetric(loopData.dayRain));
+	rtdataSet(&snapshot, RTF_RAIN_RATE, wvutilsConvertRainINToMetric(loopData.rainRate));
+	high = wvutilsConvertRainINToMetric(sensorGetDailyHigh(sensor, SENSOR_RAINRATE));
+	if (high < wvutilsConvertRainINToMetric(loopData.rainRate)) {
+		high = wvutilsConvertRainINToMetric(loopData.rainRate);
+		sensorUpdate(&sensor[STF_DAY][SENSOR_RAINRATE], loopData.rainRate);
+	}
+	rtdataSet(&snapshot, RTF_HI_RAIN_RATE, high);
+	rtdataSet(&snapshot, RTF_STORM_RAIN, wvutilsConvertRainINToMetric(loopData.stormRain));
+	rtdataSet(&snapshot, RTF_STORM_START, (int32_t)loopData.stormStart);
+
+	if  (loopData.outHumidity != 101) {
+		rtdataSet(&snapshot, RTF_OUTSIDE_HUMIDITY, (uint16_t)loopData.outHumidity);
+		high = sensorGetDailyHigh(sensor, SENSOR_OUTHUMID);
+		low = sensorGetDailyLow(sensor, SENSOR_OUTHUMID);
+		if (high < (float)loopData.outHumidity) {
+			high = (float)loopData.outHumidity;
+			sensorUpdate(&sensor[STF_DAY][SENSOR_OUTHUMID], loopData.outHumidity);
 		}
-		fprintf(ficheiro3, ",\n\"hiRainRate\":%.1f", high);
-		fprintf(ficheiro3, ",\n\"stormRain\":%.1f", wvutilsConvertRainINToMetric(loopData.stormRain));
-		fprintf(ficheiro3, ",\n\"stormStart\":%d", (int32_t)loopData.stormStart);
-
-		if  (loopData.outHumidity != 101) {
-			fprintf(ficheiro3, ",\n\"outsideHumidity\":%d", (uint16_t)loopData.outHumidity);
-			high = sensorGetDailyHigh(sensor, SENSOR_OUTHUMID);
-			low = sensorGetDailyLow(sensor, SENSOR_OUTHUMID);
-			if (high < (float)loopData.outHumidity) {
-				high = (float)loopData.outHumidity;
-				sensorUpdate(&sensor[STF_DAY][SENSOR_OUTHUMID], loopData.outHumidity);
-			}
-			if (low > (float)loopData.outHumidity) {
-				low = (float)loopData.outHumidity;
-				sensorUpdate(&sensor[STF_DAY][SENSOR_OUTHUMID], loopData.outHumidity);
-			}
-			fprintf(ficheiro3, ",\n\"hiHumidity\":%d", (uint16_t)high);
-			fprintf(ficheiro3, ",\n\"lowHumidity\":%d", (uint16_t)low);
+		if (low > (float)loopData.outHumidity) {
+			low = (float)loopData.outHumidity;
+			sensorUpdate(&sensor[STF_DAY][SENSOR_OUTHUMID], loopData.outHumidity);
 		}
+		rtdataSet(&snapshot, RTF_HI_HUMIDITY, (uint16_t)high);
+		rtdataSet(&snapshot, RTF_LOW_HUMIDITY, (uint16_t)low);
+	}
 
-		if  (loopData.barometer != ARCHIVE_VALUE_NULL) {
-			fprintf(ficheiro3, ",\n\"barometer\":%.1f", wvutilsConvertINHGToHPA(loopData.barometer));
+	if  (loopData.barometer != ARCHIVE_VALUE_NULL) {
+		rtdataSet(&snapshot, RTF_BAROMETER, wvutilsConvertINHGToHPA(loopData.barometer));
 	
-			high = wvutilsConvertINHGToHPA(sensorGetDailyHigh(sensor, SENSOR_BP));
-			low = wvutilsConvertINHGToHPA(sensorGetDailyLow(sensor, SENSOR_BP));
-			if (high < wvutilsConvertINHGToHPA(loopData.barometer)) {
-				high = wvutilsConvertINHGToHPA(loopData.barometer);
-				sensorUpdate(&sensor[STF_DAY][SENSOR_BP], loopData.barometer);
-			}
-			if (low > wvutilsConvertINHGToHPA(loopData.barometer)) {
-				low = wvutilsConvertINHGToHPA(loopData.barometer);
-				sensorUpdate(&sensor[STF_DAY][SENSOR_BP], loopData.barometer);
-			}
-			
-			fprintf(ficheiro3, ",\n\"hiBarometer\":%.1f", high);
-			fprintf(ficheiro3, ",\n\"lowBarometer\":%.1f", low);
+		high = wvutilsConvertINHGToHPA(sensorGetDailyHigh(sensor, SENSOR_BP));
+		low = wvutilsConvertINHGToHPA(sensorGetDailyLow(sensor, SENSOR_BP));
+		if (high < wvutilsConvertINHGToHPA(loopData.barometer)) {
+			high = wvutilsConvertINHGToHPA(loopData.barometer);
+			sensorUpdate(&sensor[STF_DAY][SENSOR_BP], loopData.barometer);
 		}
-
-		if  (loopData.windSpeedF != ARCHIVE_VALUE_NULL) {
-			fprintf(ficheiro3, ",\n\"windSpeed\":%.1f", wvutilsConvertMPHToKPH(loopData.windSpeedF));
-			windSpeedF=TRUE;
+		if (low > wvutilsConvertINHGToHPA(loopData.barometer)) {
+			low = wvutilsConvertINHGToHPA(loopData.barometer);
+			sensorUpdate(&sensor[STF_DAY][SENSOR_BP], loopData.barometer);
 		}
+		
+		rtdataSet(&snapshot, RTF_HI_BAROMETER, high);
+		rtdataSet(&snapshot, RTF_LOW_BAROMETER, low);
+	}
 
-		if (loopData.windGustF != ARCHIVE_VALUE_NULL) {
-			fprintf(ficheiro3, ",\n\"windGustSpeed\":%.1f", wvutilsConvertMPHToKPH(loopData.windGustF));
-			windGustF=TRUE;
-		}
+	if  (loopData.windSpeedF != ARCHIVE_VALUE_NULL) {
+		rtdataSet(&snapshot, RTF_WIND_SPEED, wvutilsConvertMPHToKPH(loopData.windSpeedF));
+		windSpeedF=TRUE;
+	}
 
-		if  (loopData.tenMinuteWindGust != ARCHIVE_VALUE_NULL) {
-			fprintf(ficheiro3, ",\n\"tenMinuteWindGust\":%.1f", wvutilsConvertMPHToKPH(loopData.tenMinuteWindGust));
-			tenMinuteWindGust=TRUE;
-		}
+	if (loopData.windGustF != ARCHIVE_VALUE_NULL) {
+		rtdataSet(&snapshot, RTF_WIND_GUST_SPEED, wvutilsConvertMPHToKPH(loopData.windGustF));
+		windGustF=TRUE;
+	}
 
-		
-		high = wvutilsConvertMPHToKPH(sensorGetDailyHigh(sensor, SENSOR_WGUST));
-		if (tenMinuteWindGust==TRUE&&wvutilsConvertMPHToKPH(loopData.tenMinuteWindGust)>high) {
-			high = wvutilsConvertMPHToKPH(loopData.tenMinuteWindGust);
-			sensorUpdateWhen(&sensor[STF_DAY][SENSOR_WGUST],loopData.tenMinuteWindGust,(float)loopData.WinddirtenMinuteWindGust);
-		}
+	if  (loopData.tenMinuteWindGust != ARCHIVE_VALUE_NULL) {
+		rtdataSet(&snapshot, RTF_TEN_MIN_WIND_GUST, wvutilsConvertMPHToKPH(loopData.tenMinuteWindGust));
+		tenMinuteWindGust=TRUE;
+	}
 
-		if (windGustF==TRUE&&wvutilsConvertMPHToKPH(loopData.windGustF)>high) {
-			high = wvutilsConvertMPHToKPH(loopData.windGustF);
-			sensorUpdateWhen(&sensor[STF_DAY][SENSOR_WGUST],loopData.windGustF,(float)loopData.windGustDir);
-		}
-		if (windSpeedF==TRUE&&wvutilsConvertMPHToKPH(loopData.windSpeedF)>high) {
-			high = wvutilsConvertMPHToKPH(loopData.windSpeedF);
-			sensorUpdateWhen(&sensor[STF_DAY][SENSOR_WGUST],loopData.windSpeedF,(float)loopData.windDir);
-		}
-		if (high<200)
-			fprintf(ficheiro3, ",\n\"hiWindSpeed\":%.1f", high);
-		
-		
-		fprintf(ficheiro3, ",\n\"windDirectionDegrees\":%d", (uint16_t)loopData.windDir);
-		fprintf(ficheiro3, ",\n\"windGustDirectionDegrees\":%d", (uint16_t)loopData.windGustDir);
-		if  (loopData.tenMinuteWindGust != ARCHIVE_VALUE_NULL) {
-			fprintf(ficheiro3, ",\n\"WinddirtenMinuteWindGust\":%d", (uint16_t)loopData.WinddirtenMinuteWindGust);
-		}
-		fprintf(ficheiro3, ",\n\"ET\":%.1f", wvutilsConvertRainINToMetric(loopData.dayET));
+	
+	high = wvutilsConvertMPHToKPH(sensorGetDailyHigh(sensor, SENSOR_WGUST));
+	if (tenMinuteWindGust==TRUE&&wvutilsConvertMPHToKPH(loopData.tenMinuteWindGust)>high) {
+		high = wvutilsConvertMPHToKPH(loopData.tenMinuteWindGust);
+		sensorUpdateWhen(&sensor[STF_DAY][SENSOR_WGUST],loopData.tenMinuteWindGust,(float)loopData.WinddirtenMinuteWindGust);
+	}
 
-		if  (loopData.UV != ARCHIVE_VALUE_NULL) {
-			fprintf(ficheiro3, ",\n\"UV\":%.1f", loopData.UV);
+	if (windGustF==TRUE&&wvutilsConvertMPHToKPH(loopData.windGustF)>high) {
+		high = wvutilsConvertMPHToKPH(loopData.windGustF);
+		sensorUpdateWhen(&sensor[STF_DAY][SENSOR_WGUST],loopData.windGustF,(float)loopData.windGustDir);
+	}
+	if (windSpeedF==TRUE&&wvutilsConvertMPHToKPH(loopData.windSpeedF)>high) {
+		high = wvutilsConvertMPHToKPH(loopData.windSpeedF);
+		sensorUpdateWhen(&sensor[STF_DAY][SENSOR_WGUST],loopData.windSpeedF,(float)loopData.windDir);
+	}
+	if (high<200)
+		rtdataSet(&snapshot, RTF_HI_WIND_SPEED, high);
+	
+	
+	rtdataSet(&snapshot, RTF_WIND_DIR, (uint16_t)loopData.windDir);
+	rtdataSet(&snapshot, RTF_WIND_GUST_DIR, (uint16_t)loopData.windGustDir);
+	if  (loopData.tenMinuteWindGust != ARCHIVE_VALUE_NULL) {
+		rtdataSet(&snapshot, RTF_TEN_MIN_WIND_GUST_DIR, (uint16_t)loopData.WinddirtenMinuteWindGust);
+	}
+	rtdataSet(&snapshot, RTF_ET, wvutilsConvertRainINToMetric(loopData.dayET));
 
-			high = sensorGetDailyHigh(sensor, SENSOR_UV);
-			if (high < loopData.UV) {
-				high = loopData.UV;
-				sensorUpdate(&sensor[STF_DAY][SENSOR_UV], loopData.UV);
-			}
-			fprintf(ficheiro3, ",\n\"hiUV\":%.1f", high);
-		}
+	if  (loopData.UV != ARCHIVE_VALUE_NULL) {
+		rtdataSet(&snapshot, RTF_UV, loopData.UV);
 
-		if  (loopData.radiation != 4000) {
-			fprintf(ficheiro3, ",\n\"solarRad\":%d", (uint16_t)loopData.radiation);
-		
-			high = sensorGetDailyHigh(sensor, SENSOR_SOLRAD);
-			if (high < loopData.radiation) {
-				high = loopData.radiation;
-				sensorUpdate(&sensor[STF_DAY][SENSOR_SOLRAD], loopData.radiation);
-			}
-			fprintf(ficheiro3, ",\n\"hiRadiation\":%.1f", high);
+		high = sensorGetDailyHigh(sensor, SENSOR_UV);
+		if (high < loopData.UV) {
+			high = loopData.UV;
+			sensorUpdate(&sensor[STF_DAY][SENSOR_UV], loopData.UV);
 		}
+		rtdataSet(&snapshot, RTF_HI_UV, high);
+	}
 
-		if  (loopData.tenMinuteAvgWindSpeed != ARCHIVE_VALUE_NULL) 
-			fprintf(ficheiro3, ",\n\"tenMinuteAvgWindSpeed\":%.1f", wvutilsConvertMPHToKPH(loopData.tenMinuteAvgWindSpeed));
-		
-		if  (loopData.twoMinuteAvgWindSpeed != ARCHIVE_VALUE_NULL) 
-			fprintf(ficheiro3, ",\n\"twoMinuteAvgWindSpeed\":%.1f", wvutilsConvertMPHToKPH(loopData.twoMinuteAvgWindSpeed));
+	if  (loopData.radiation != 4000) {
+		rtdataSet(&snapshot, RTF_SOLAR_RAD, (uint16_t)loopData.radiation);
+	
+		high = sensorGetDailyHigh(sensor, SENSOR_SOLRAD);
+		if (high < loopData.radiation) {
+			high = loopData.radiation;
+			sensorUpdate(&sensor[STF_DAY][SENSOR_SOLRAD], loopData.radiation);
+		}
+		rtdataSet(&snapshot, RTF_HI_RADIATION, high);
+	}
 
-		fprintf(ficheiro3, "\n}");
+	if  (loopData.tenMinuteAvgWindSpeed != ARCHIVE_VALUE_NULL) 
+		rtdataSet(&snapshot, RTF_TEN_MIN_AVG_WIND_SPEED, wvutilsConvertMPHToKPH(loopData.tenMinuteAvgWindSpeed));
+	
+	if  (loopData.twoMinuteAvgWindSpeed != ARCHIVE_VALUE_NULL) 
+		rtdataSet(&snapshot, RTF_TWO_MIN_AVG_WIND_SPEED, wvutilsConvertMPHToKPH(loopData.twoMinuteAvgWindSpeed));
 
-		fclose(ficheiro3);
-	}
+	rtdataPublish(&snapshot);
 }
 
 WV_SENSOR           sensor[STF_MAX][SENSOR_MAX];
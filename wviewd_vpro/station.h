@@ -47,6 +47,8 @@
 #include <sensor.h>
 #include <dbsqlite.h>
 #include <daemon.h>
+#include <realtimeServer.h>
+#include <realtimeData.h>
 
 #define SERIAL_BYTE_LENGTH_MAX          1024
 
@@ -83,8 +85,9 @@
 //
 // 'archiveIndication' - indication callback used to pass back an archive record
 //   generated as a result of 'stationGetArchive' being called; should receive a
-//   NULL pointer for 'newRecord' if no record available; only used if
-//   'stationGeneratesArchives' flag is set to TRUE by the station interface
+//   NULL pointer for 'newRecord' if no record available and after the last
+//   record of a batch; only used if 'stationGeneratesArchives' flag is set
+//   to TRUE by the station interface
 //
 // Returns: OK or ERROR
 //
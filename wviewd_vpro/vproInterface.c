@@ -116,6 +116,14 @@ int stationInit(
 			return ERROR;
 		}
 	}
+	else if (!strcmp(work->stationInterface, "replay"))
+	{
+		if (replayMediumInit(&work->medium, work->replaySpeed) == ERROR)
+		{
+			MsgLog(PRI_HIGH, "stationInit: replay MediumInit failed");
+			return ERROR;
+		}
+	}
 
 	// initialize the VP interface using the media specific routine
 	if ((*(work->medium.init))(&work->medium, work->stationDevice) == ERROR)
@@ -124,6 +132,12 @@ int stationInit(
 		return ERROR;
 	}
 
+	if (work->captureFile[0] != 0)
+	{
+		// not fatal - just run without the capture
+		replayCaptureStart(&work->medium, work->captureFile);
+	}
+
 	vpifWakeupConsole(work);
 	vpifWakeupConsole(work);
 
@@ -138,6 +152,11 @@ int stationInit(
 		MsgLog(PRI_STATUS, "Vantage Pro on %s:%d opened ...",
 			   work->stationHost, work->stationPort);
 	}
+	else if (!strcmp(work->stationInterface, "replay"))
+	{
+		MsgLog(PRI_STATUS, "Vantage Pro capture %s opened ...",
+			   work->stationDevice);
+	}
 
 	// get VP-specific configuration
 	if (stationGetConfigValueBoolean(work,
@@ -154,6 +173,15 @@ int stationInit(
 			   ((vpWorkData.doRXCheck) ? "ENABLED" : "DISABLED"));
 	}
 
+	if (stationGetConfigValueBoolean(work,
+									 configItem_STATION_LOOP_STREAM,
+									 &vpWorkData.doLoopStream) == ERROR)
+	{
+		vpWorkData.doLoopStream = 0;
+	}
+	MsgLog(PRI_MEDIUM, "stationInit: VP LOOP streaming is %s",
+		   ((vpWorkData.doLoopStream) ? "ENABLED" : "DISABLED"));
+
 	// This must be done here so dmpafter will work:
 	work->archiveDateTime = dbsqliteArchiveGetNewestTime(&newestRecord);
 	if ((int)work->archiveDateTime == ERROR)
@@ -225,6 +253,15 @@ int stationInit(
 		(*(work->medium.exit))(&work->medium);
 		return ERROR;
 	}
+	if (radStatesAddHandler(vpWorkData.stateMachine,
+							VPRO_STATE_LOOP_STREAM,
+							vproLoopStreamState) == ERROR)
+	{
+		MsgLog(PRI_HIGH, "stationInit: radStatesAddHandler failed");
+		radStatesExit(vpWorkData.stateMachine);
+		(*(work->medium.exit))(&work->medium);
+		return ERROR;
+	}
 	if (radStatesAddHandler(vpWorkData.stateMachine,
 							VPRO_STATE_READ_RECOVER,
 							vproReadRecoverState) == ERROR)
@@ -997,19 +1034,15 @@ static int processArchivePage(WVIEWD_WORK *work, ARCHIVE_PAGE *page)
 		// Add for the 12-hour temp average:
 		sensorAccumAddSample(vp12HourTempAvg, archivePkt.dateTime, archivePkt.value[DATA_INDEX_outTemp]);
 
-		// indicate through the station API:
-		(*ArchiveIndicator)(&archivePkt);
-
-		// If not running yet, add to HILOW database:
-		if (!work->runningFlag)
+		// queue it - storing is deferred so the download runs at wire speed;
+		// a full queue is stored now, before this page is ACKed (the stall
+		// is bounded by VP_ARCHIVE_QUEUE_MAX)
+		if (vpWorkData.archiveQueueLength >= VP_ARCHIVE_QUEUE_MAX)
 		{
-			dbsqliteHiLowStoreArchive(&archivePkt);
-		}
-		else
-		{
-			// Add all but cumulative:
-			dbsqliteHiLowUpdateArchive(&archivePkt);
+			vpifArchiveQueueFlush(work);
 		}
+		vpWorkData.archiveQueue[vpWorkData.archiveQueueLength++] = archivePkt;
+		metricsSet(METRIC_ARCHIVE_QUEUE_DEPTH, vpWorkData.archiveQueueLength);
 	}
 
 	vpWorkData.archiveCurrentPage++;
@@ -1037,8 +1070,14 @@ static int readWithCRC(WVIEWD_WORK *work, void *bfr, int len, int msTimeout)
 	int retVal, index = 0;
 	uint8_t *ptr = (uint8_t *)bfr;
 	uint16_t crc = 0;
+#ifndef _VP_CONFIG_ONLY
+	uint64_t startTime = latencyStart();
+#endif
 
 	retVal = (*work->medium.read)(&work->medium, bfr, len, msTimeout);
+#ifndef _VP_CONFIG_ONLY
+	latencyStop(LATENCY_SERIAL_READ, startTime);
+#endif
 	if (retVal != len)
 	{
 		return ERROR;
@@ -1049,9 +1088,81 @@ static int readWithCRC(WVIEWD_WORK *work, void *bfr, int len, int msTimeout)
 		crc = crc_table[(crc >> 8) ^ ptr[index]] ^ (crc << 8);
 	}
 
+#ifndef _VP_CONFIG_ONLY
+	if (crc != 0)
+	{
+		metricsAdd(METRIC_CRC_ERRORS, 1);
+	}
+#endif
 	return (crc == 0) ? (len) : (ERROR);
 }
 
+// Non-blocking framed read for use from STIM_IO: collects whatever the medium
+// has queued into rxFrame; returns len once a whole frame with a good CRC is
+// there, VPIF_FRAME_PENDING if not yet or ERROR.
+// If 'syncLoop' is set anything ahead of a "LOO" marker is discarded.
+static int readFrameWithCRC(WVIEWD_WORK *work, void *bfr, int len, int syncLoop)
+{
+	static const uint8_t loopMarker[3] = {'L', 'O', 'O'};
+	uint8_t *frame = vpWorkData.rxFrame;
+	int retVal, index, match;
+	uint16_t crc = 0;
+
+	retVal = (*work->medium.readAvail)(&work->medium,
+									   &frame[vpWorkData.rxFrameLength],
+									   len - vpWorkData.rxFrameLength);
+	if (retVal == ERROR)
+	{
+		vpWorkData.rxFrameLength = 0;
+		return ERROR;
+	}
+	vpWorkData.rxFrameLength += retVal;
+
+	if (syncLoop)
+	{
+		// find the first offset that is (or could still become) "LOO"
+		for (index = 0; index < vpWorkData.rxFrameLength; index++)
+		{
+			match = vpWorkData.rxFrameLength - index;
+			if (match > 3)
+			{
+				match = 3;
+			}
+			if (!memcmp(&frame[index], loopMarker, match))
+			{
+				break;
+			}
+		}
+
+		if (index > 0)
+		{
+			vpWorkData.rxFrameLength -= index;
+			memmove(frame, &frame[index], vpWorkData.rxFrameLength);
+		}
+	}
+
+	if (vpWorkData.rxFrameLength < len)
+	{
+		return VPIF_FRAME_PENDING;
+	}
+
+	vpWorkData.rxFrameLength = 0;
+	for (index = 0; index < len; index++)
+	{
+		crc = crc_table[(crc >> 8) ^ frame[index]] ^ (crc << 8);
+	}
+	if (crc != 0)
+	{
+#ifndef _VP_CONFIG_ONLY
+		metricsAdd(METRIC_CRC_ERRORS, 1);
+#endif
+		return ERROR;
+	}
+
+	memcpy(bfr, frame, len);
+	return len;
+}
+
 static int writeWithCRC(WVIEWD_WORK *work, void *buffer, int length)
 {
 	int retVal;
@@ -1157,6 +1268,42 @@ void vpifIndicateLoopDone(void)
 	return;
 }
 
+void vpifArchiveQueueFlush(WVIEWD_WORK *work)
+{
+#ifndef _VP_CONFIG_ONLY
+	int i;
+
+	if (vpWorkData.archiveQueueLength == 0)
+	{
+		return;
+	}
+
+	for (i = 0; i < vpWorkData.archiveQueueLength; i++)
+	{
+		// indicate through the station API (the daemon parks it):
+		(*ArchiveIndicator)(&vpWorkData.archiveQueue[i]);
+
+		// If not running yet, add to HILOW database:
+		if (!work->runningFlag)
+		{
+			dbsqliteHiLowStoreArchive(&vpWorkData.archiveQueue[i]);
+		}
+		else
+		{
+			// Add all but cumulative:
+			dbsqliteHiLowUpdateArchive(&vpWorkData.archiveQueue[i]);
+		}
+	}
+
+	// end of the batch - the daemon stores the lot in one transaction:
+	(*ArchiveIndicator)(NULL);
+
+	vpWorkData.archiveQueueLength = 0;
+	metricsSet(METRIC_ARCHIVE_QUEUE_DEPTH, 0);
+#endif
+	return;
+}
+
 void vpifFlush(WVIEWD_WORK *work)
 {
 	(*work->medium.flush)(&work->medium, WV_QUEUE_INPUT);
@@ -1572,6 +1719,7 @@ int vpifReadMessage(WVIEWD_WORK *work, int expectACK)
 	LOOP_DATA *loop = (LOOP_DATA *)temp;
 	LOOP2_DATA *loop2 = (LOOP2_DATA *)temp2;
 	int retVal1, retVal2;
+	uint64_t startTime;
 
 	memset(temp, 0, sizeof(temp));
 	switch (vpWorkData.reqMsgType)
@@ -1614,10 +1762,15 @@ int vpifReadMessage(WVIEWD_WORK *work, int expectACK)
 
 		vpWorkData.archivePages = SHORT_SWAP(dmphdr->pages);
 		vpWorkData.archiveRecOffset = SHORT_SWAP(dmphdr->firstRecIndex);
+		vpWorkData.rxFrameLength = 0;
 		return OK;
 
 	case SER_MSG_ARCHIVE:
-		retVal1 = readWithCRC(work, arcRec, sizeof(ARCHIVE_PAGE), 5000);
+		retVal1 = readFrameWithCRC(work, arcRec, sizeof(ARCHIVE_PAGE), FALSE);
+		if (retVal1 == VPIF_FRAME_PENDING)
+		{
+			return VPIF_FRAME_PENDING;
+		}
 		if (retVal1 != sizeof(ARCHIVE_PAGE))
 		{
 			(*work->medium.flush)(&work->medium, WV_QUEUE_INPUT);
@@ -1637,33 +1790,95 @@ int vpifReadMessage(WVIEWD_WORK *work, int expectACK)
 		return (processArchivePage(work, arcRec));
 
 	case SER_MSG_LOOP:
-		if (expectACK)
+		// the LOOP/LOOP2 pair of "LPS 3 2", framed like the stream so a
+		// slow console never blocks the process; the leading ACK is
+		// dropped by the frame sync
+		retVal1 = readFrameWithCRC(work, loop, sizeof(LOOP_DATA), TRUE);
+		if (retVal1 == VPIF_FRAME_PENDING)
 		{
-			if (vpifGetAck(work, 1000) == ERROR)
+			return VPIF_FRAME_PENDING;
+		}
+
+		if (!vpWorkData.loopStreamHaveLoop)
+		{
+			if (retVal1 != sizeof(LOOP_DATA) || loop->type != 0)
 			{
+				MsgLog(PRI_HIGH, "Loop1 error  retval=%d", retVal1);
+
 				(*work->medium.flush)(&work->medium, WV_QUEUE_INPUT);
 				return ERROR;
 			}
+
+			// hold the LOOP until its LOOP2 arrives
+			memcpy(&vpWorkData.streamLoop, loop, sizeof(LOOP_DATA));
+			vpWorkData.loopStreamHaveLoop = TRUE;
+			return VPIF_FRAME_PENDING;
 		}
-		retVal1 = readWithCRC(work, loop, sizeof(LOOP_DATA), 5000);
-		if (retVal1 != sizeof(LOOP_DATA))
+
+		vpWorkData.loopStreamHaveLoop = FALSE;
+		if (retVal1 != sizeof(LOOP_DATA) || loop->type != 1)
+		{
+			MsgLog(PRI_HIGH, "Loop2 error retval=%d", retVal1);
+			retVal2 = ERROR;
+		}
+		else
 		{
-			MsgLog(PRI_HIGH, "Loop1 error  retval=%d", retVal1);
+			memcpy(loop2, loop, sizeof(LOOP2_DATA));
+			retVal2 = sizeof(LOOP2_DATA);
+		}
 
+		/*  ... store in IPM format
+		*/
+		startTime = latencyStart();
+		storeLoopPkt(work, &vpWorkData.streamLoop, loop2, sizeof(LOOP_DATA), retVal2);
+		latencyStop(LATENCY_STORE_LOOP, startTime);
+		startTime = latencyStart();
+		processRealTimeData(work->loopPkt, work->sensors.sensor);
+		latencyStop(LATENCY_REALTIME, startTime);
+		return OK;
+
+	case SER_MSG_LOOP_STREAM:
+		// one packet per call - LOOP and LOOP2 alternate every 2 seconds,
+		// so don't sit blocked waiting for the second half of the pair;
+		// the leading ACK is dropped by the frame sync
+		retVal1 = readFrameWithCRC(work, loop, sizeof(LOOP_DATA), TRUE);
+		if (retVal1 == VPIF_FRAME_PENDING)
+		{
+			return VPIF_FRAME_PENDING;
+		}
+		if (retVal1 != sizeof(LOOP_DATA))
+		{
+			MsgLog(PRI_HIGH, "Loop stream error retval=%d", retVal1);
+			vpWorkData.loopStreamHaveLoop = FALSE;
 			(*work->medium.flush)(&work->medium, WV_QUEUE_INPUT);
 			return ERROR;
 		}
 
-		retVal2 = readWithCRC(work, loop2, sizeof(LOOP2_DATA), 5000);
-		if (retVal2 != sizeof(LOOP2_DATA))
+		vpWorkData.loopStreamRemaining --;
+
+		if (loop->type == 0)
+		{
+			// hold the LOOP until its LOOP2 arrives
+			memcpy(&vpWorkData.streamLoop, loop, sizeof(LOOP_DATA));
+			vpWorkData.loopStreamHaveLoop = TRUE;
+			return OK;
+		}
+
+		if (!vpWorkData.loopStreamHaveLoop)
 		{
-			MsgLog(PRI_HIGH, "Loop2 error retval=%d", retVal2);
+			// LOOP2 without a LOOP (joined mid-pair) - drop it
+			return OK;
 		}
 
-		/*  ... store in IPM format
-		*/
-		storeLoopPkt(work, loop, loop2, retVal1, retVal2);
+		memcpy(loop2, loop, sizeof(LOOP2_DATA));
+		vpWorkData.loopStreamHaveLoop = FALSE;
+		startTime = latencyStart();
+		storeLoopPkt(work, &vpWorkData.streamLoop, loop2, sizeof(LOOP_DATA), sizeof(LOOP2_DATA));
+		latencyStop(LATENCY_STORE_LOOP, startTime);
+		startTime = latencyStart();
 		processRealTimeData(work->loopPkt, work->sensors.sensor);
+		latencyStop(LATENCY_REALTIME, startTime);
+		vpWorkData.loopStreamPairDone = TRUE;
 		return OK;
 #endif
 
@@ -1817,8 +2032,36 @@ int vpifSendLoopRqst(WVIEWD_WORK *work, int number)
 	}
 
 	vpWorkData.reqMsgType = SER_MSG_LOOP;
+	vpWorkData.loopStreamHaveLoop = FALSE;
+	vpWorkData.rxFrameLength = 0;
 	return OK;
 }
+
+int vpifSendLoopStreamRqst(WVIEWD_WORK *work)
+{
+	if (vpifSendLoopRqst(work, VP_LOOP_STREAM_PAIRS) == ERROR)
+	{
+		return ERROR;
+	}
+
+	vpWorkData.reqMsgType = SER_MSG_LOOP_STREAM;
+	vpWorkData.loopStreamRemaining = 2 * VP_LOOP_STREAM_PAIRS;
+	vpWorkData.loopStreamHaveLoop = FALSE;
+	vpWorkData.loopStreamPairDone = FALSE;
+	vpWorkData.rxFrameLength = 0;
+	return OK;
+}
+
+int vpifStopLoopStream(WVIEWD_WORK *work)
+{
+	// any character cancels LPS; the wakeup also discards whatever part
+	// of the current packet is in flight
+	vpWorkData.reqMsgType = SER_MSG_NONE;
+	vpWorkData.loopStreamRemaining = 0;
+	vpWorkData.loopStreamHaveLoop = FALSE;
+	vpWorkData.rxFrameLength = 0;
+	return vpifWakeupConsole(work);
+}
 // <
 
 int vpifGetRXCheck(WVIEWD_WORK *work)
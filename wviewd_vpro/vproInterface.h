@@ -60,6 +60,7 @@
 #include <daemon.h>
 #include <station.h>
 #include <serial.h>
+#include <replay.h>
 #include <sensor.h>
 
 /*  ... some definitions
@@ -76,11 +77,27 @@
 
 #define VP_RESPONSE_TIMEOUT(isIP)       ((isIP) ? 10000L : 5000L)
 
+// vpifReadMessage return when a framed read has only part of a frame:
+#define VPIF_FRAME_PENDING              -2
+
+// archive records converted during a DMPAFT download are queued and written
+// in one batch when the download ends (or the queue fills). The flush runs
+// on the state machine path and the archive database commits with
+// synchronous=FULL, so this also bounds the stall: one transaction (one WAL
+// fsync) per 100 records, i.e. per 20 pages. A flush on a full queue happens
+// while the console waits for our page ACK, well inside VP_RESPONSE_TIMEOUT;
+// the DMPAFT after each archive interval queues a single record.
+#define VP_ARCHIVE_QUEUE_MAX            100
+
 // time to wait before attempting archive record again:
 #define VPIF_RETRY_ARCHIVE_INTERVAL     10000L
 
 #define VP_PARM_DO_RXCHECK              "DO_RXCHECK"
 
+// LOOP/LOOP2 pairs requested per "LPS" when streaming; the console sends
+// one packet every 2 seconds so this is roughly 6 minutes per request:
+#define VP_LOOP_STREAM_PAIRS            90
+
 //  ... define the message types we receive
 typedef enum
 {
@@ -88,6 +105,7 @@ typedef enum
 	SER_MSG_ARCHIVE = 2,
 	SER_MSG_DMPAFT_HDR = 3,
 	SER_MSG_LOOP = 4,
+	SER_MSG_LOOP_STREAM = 5,
 	SER_MSG_NONE = -1
 } SER_MSG_TYPES;
 
@@ -251,6 +269,15 @@ typedef struct
 	int             archiveRetryFlag;
 	int             doLoopFlag;
 	int             doArchiveFlag;
+	int             doLoopStream;           // keep an "LPS" stream running
+	int             loopStreamRemaining;    // packets left in this request
+	int             loopStreamHaveLoop;     // streamLoop holds a valid LOOP
+	int             loopStreamPairDone;     // set when a LOOP/LOOP2 is stored
+	LOOP_DATA       streamLoop;
+	uint8_t         rxFrame[VP_BYTE_LENGTH_MAX];    // partial frame so far
+	int             rxFrameLength;
+	ARCHIVE_PKT     archiveQueue[VP_ARCHIVE_QUEUE_MAX];
+	int             archiveQueueLength;
 	int             sampleRain;             // to track dailyRain changes
 	int             sampleET;               // to track dayET changes
 
@@ -338,8 +365,14 @@ extern void vpifIndicateStationUp(void);
 extern void vpifIndicateLoopDone(void);
 extern int vpifSynchronizeConsoleClock(WVIEWD_WORK* work);
 
+// ... hand queued DMPAFT records to the daemon and HILOW database in one
+// ... batch; call whenever a download ends, however it ends
+extern void vpifArchiveQueueFlush(WVIEWD_WORK* work);
+
 // ... this guy reads/parses msgs and updates the internal data stores;
 // ... uses the "reqMsgType" of the work area to determine msg type to read;
+// ... LOOP/LOOP2 packets and archive pages are framed without blocking:
+// ... VPIF_FRAME_PENDING means wait for the next STIM_IO;
 // ... returns OK or ERROR
 extern int vpifReadMessage(WVIEWD_WORK* work, int expectACKFirst);
 
@@ -353,6 +386,12 @@ extern int vpifSendDumpAfterRqst(WVIEWD_WORK* work);
 extern int vpifSendDumpDateTimeRqst(WVIEWD_WORK* work);
 extern int vpifSendLoopRqst(WVIEWD_WORK* work, int number);
 
+// ... start/stop a continuous LOOP/LOOP2 stream;
+// ... the stream is stopped by waking the console, leaving it idle;
+// ... returns OK or ERROR
+extern int vpifSendLoopStreamRqst(WVIEWD_WORK* work);
+extern int vpifStopLoopStream(WVIEWD_WORK* work);
+
 // ... define the VP state machine states
 typedef enum
 {
@@ -362,6 +401,7 @@ typedef enum
 	VPRO_STATE_DMPAFT_ACK,
 	VPRO_STATE_RECV_ARCH,
 	VPRO_STATE_LOOP_RQST,
+	VPRO_STATE_LOOP_STREAM,
 	VPRO_STATE_READ_RECOVER,
 	VPRO_STATE_ERROR
 } VPRO_STATES;
@@ -372,6 +412,7 @@ extern int vproDumpAfterState(int state, void* stimulus, void* data);
 extern int vproDumpAfterAckState(int state, void* stimulus, void* data);
 extern int vproReceiveArchiveState(int state, void* stimulus, void* data);
 extern int vproLoopState(int state, void* stimulus, void* data);
+extern int vproLoopStreamState(int state, void* stimulus, void* data);
 extern int vproReadRecoverState(int state, void* stimulus, void* data);
 extern int vproStopState(int state, void* stimulus, void* data);
 extern int vproErrorState(int state, void* stimulus, void* data);
@@ -213,6 +213,20 @@ int vproRunState(int state, void* stimulus, void* data)
 				return VPRO_STATE_RUN;
 			}
 
+			if (work->runningFlag &&
+				((VP_IF_DATA*)(work->stationData))->doLoopStream)
+			{
+				// one LPS request then feeds LOOP data until it runs out
+				if (vpifSendLoopStreamRqst(work) == ERROR)
+				{
+					MsgLog(PRI_HIGH, "vproRunState: LOOP_STREAM_RQST failed");
+					return VPRO_STATE_ERROR;
+				}
+
+				radProcessTimerStart(work->ifTimer, VP_RESPONSE_TIMEOUT(work->stationIsWLIP));
+				return VPRO_STATE_LOOP_STREAM;
+			}
+
 			if (vpifSendLoopRqst(work, 1) == ERROR)
 			{
 				MsgLog(PRI_HIGH, "vproRunState: LOOP_RQST failed");
@@ -416,6 +430,9 @@ int vproReceiveArchiveState(int state, void* stimulus, void* data)
 		// serial IF timer expiry
 		MsgLog(PRI_HIGH, "vproReceiveArchiveState: timed out waiting for archive page from VP console!");
 
+		// keep what we did get
+		vpifArchiveQueueFlush(work);
+
 		if (vpifSendCancel(work) == ERROR)
 		{
 			MsgLog(PRI_HIGH, "vproReceiveArchiveState: CANCEL failed");
@@ -449,12 +466,19 @@ int vproReceiveArchiveState(int state, void* stimulus, void* data)
 
 		// read data from the station:
 		recsRX = vpifReadMessage(work, TRUE);
+		if (recsRX == VPIF_FRAME_PENDING)
+		{
+			// rest of the page is still on the wire
+			radProcessTimerStart(work->ifTimer, VP_RESPONSE_TIMEOUT(work->stationIsWLIP));
+			return state;
+		}
 		if (recsRX == ERROR)
 		{
 			// Don't let this lock up the IF:
 			MsgLog(PRI_HIGH, "vproReceiveArchiveState: read archive page failed");
 
-			radUtilsSleep(50);
+			// the queued pages were good, store them
+			vpifArchiveQueueFlush(work);
 
 			if (vpifSendCancel(work) == ERROR)
 			{
@@ -462,8 +486,6 @@ int vproReceiveArchiveState(int state, void* stimulus, void* data)
 				return VPRO_STATE_ERROR;
 			}
 
-			radUtilsSleep(50);
-
 			if (((VP_IF_DATA*)(work->stationData))->doLoopFlag)
 			{
 				// continue with the data acquisition:
@@ -500,8 +522,7 @@ int vproReceiveArchiveState(int state, void* stimulus, void* data)
 				((VP_IF_DATA*)(work->stationData))->archivePages);
 #endif
 
-			radUtilsSleep(250);       // let him send any pending data
-
+			// the last page was not ACKed so nothing more is coming
 			if (vpifSendCancel(work) == ERROR)
 			{
 				MsgLog(PRI_HIGH, "vproReceiveArchiveState: CANCEL failed");
@@ -509,7 +530,9 @@ int vproReceiveArchiveState(int state, void* stimulus, void* data)
 			}
 
 			vpifFlush(work);
-			radUtilsSleep(1);
+
+			// store the download while the console is idle
+			vpifArchiveQueueFlush(work);
 
 			if (vpifWakeupConsole(work) == ERROR)
 			{
@@ -564,6 +587,7 @@ int vproLoopState(int state, void* stimulus, void* data)
 {
 	STIM*                stim = (STIM*)stimulus;
 	WVIEWD_WORK*         work = (WVIEWD_WORK*)data;
+	int                  retVal;
 
 	switch (stim->type)
 	{
@@ -593,7 +617,14 @@ int vproLoopState(int state, void* stimulus, void* data)
 		radProcessTimerStop(work->ifTimer);
 
 		// read data from the station
-		if (vpifReadMessage(work, TRUE) == ERROR)
+		retVal = vpifReadMessage(work, TRUE);
+		if (retVal == VPIF_FRAME_PENDING)
+		{
+			// rest of the LOOP/LOOP2 pair is still on the wire
+			radProcessTimerStart(work->ifTimer, VP_RESPONSE_TIMEOUT(work->stationIsWLIP));
+			return state;
+		}
+		if (retVal == ERROR)
 		{
 			radProcessTimerStart(work->ifTimer, WVD_READ_RECOVER_INTERVAL);
 			return VPRO_STATE_READ_RECOVER;
@@ -647,6 +678,106 @@ int vproLoopState(int state, void* stimulus, void* data)
 	return state;
 }
 
+int vproLoopStreamState(int state, void* stimulus, void* data)
+{
+	STIM*                stim = (STIM*)stimulus;
+	WVIEWD_WORK*         work = (WVIEWD_WORK*)data;
+	VP_IF_DATA*          vpData = (VP_IF_DATA*)(work->stationData);
+	int                  retVal;
+
+	switch (stim->type)
+	{
+	case VP_STIM_READINGS:
+		// the stream is already delivering readings
+		break;
+
+	case VP_STIM_ARCHIVE:
+		// stop the stream and go get the archive record now
+		radProcessTimerStop(work->ifTimer);
+		if (vpifStopLoopStream(work) == ERROR)
+		{
+			MsgLog(PRI_HIGH, "vproLoopStreamState: ARC WAKEUP failed");
+			vpData->archiveRetryFlag = TRUE;
+			return VPRO_STATE_RUN;
+		}
+
+		if (vpifSendDumpAfterRqst(work) == ERROR)
+		{
+			MsgLog(PRI_HIGH, "vproLoopStreamState: DMPAFT_RQST failed");
+			return VPRO_STATE_ERROR;
+		}
+
+		radProcessTimerStart(work->ifTimer, VP_RESPONSE_TIMEOUT(work->stationIsWLIP));
+		return VPRO_STATE_DMPAFT_RQST;
+
+	case STIM_TIMER:
+		// the stream stalled - restart it
+		if (vpifStopLoopStream(work) == ERROR)
+		{
+			MsgLog(PRI_HIGH, "vproLoopStreamState: WAKEUP failed");
+			return VPRO_STATE_RUN;
+		}
+
+		if (vpifSendLoopStreamRqst(work) == ERROR)
+		{
+			MsgLog(PRI_HIGH, "vproLoopStreamState: LOOP_STREAM_RQST failed");
+			return VPRO_STATE_ERROR;
+		}
+
+		radProcessTimerStart(work->ifTimer, VP_RESPONSE_TIMEOUT(work->stationIsWLIP));
+		return state;
+
+	case STIM_IO:
+		radProcessTimerStop(work->ifTimer);
+
+		// read what we can of the next packet from the stream
+		retVal = vpifReadMessage(work, FALSE);
+		if (retVal == ERROR)
+		{
+			vpifStopLoopStream(work);
+			radProcessTimerStart(work->ifTimer, WVD_READ_RECOVER_INTERVAL);
+			return VPRO_STATE_READ_RECOVER;
+		}
+
+		if (vpData->loopStreamPairDone)
+		{
+			vpData->loopStreamPairDone = FALSE;
+			vpData->doLoopFlag = FALSE;
+
+			// indicate the LOOP packet is done
+			vpifIndicateLoopDone();
+		}
+
+		// check to see if we have a pending time sync
+		if (vpData->timeSyncFlag)
+		{
+			vpifStopLoopStream(work);
+			if (vpifSynchronizeConsoleClock(work) == OK)
+			{
+				vpData->timeSyncFlag = 0;
+			}
+
+			// restart at the next readings poll
+			return VPRO_STATE_RUN;
+		}
+
+		if (vpData->loopStreamRemaining <= 0)
+		{
+			// this request is used up, ask for another
+			if (vpifSendLoopStreamRqst(work) == ERROR)
+			{
+				MsgLog(PRI_HIGH, "vproLoopStreamState: LOOP_STREAM_RQST failed");
+				return VPRO_STATE_ERROR;
+			}
+		}
+
+		radProcessTimerStart(work->ifTimer, VP_RESPONSE_TIMEOUT(work->stationIsWLIP));
+		return state;
+	}
+
+	return state;
+}
+
 int vproReadRecoverState(int state, void* stimulus, void* data)
 {
 	STIM*                stim = (STIM*)stimulus;
@@ -659,6 +790,7 @@ int vproReadRecoverState(int state, void* stimulus, void* data)
 		// wakeup the console
 		if (vpifWakeupConsole(work) == ERROR)
 		{
+			metricsAdd(METRIC_READ_RETRIES, 1);
 			if (++work->numReadRetries > WVD_READ_RECOVER_MAX_RETRIES)
 			{
 				MsgLog(PRI_HIGH,
@@ -0,0 +1,1057 @@
+/*---------------------------------------------------------------------------
+
+  FILENAME:
+		vpsim.c
+
+  PURPOSE:
+		Vantage Pro console simulator on a pseudo-terminal for end-to-end
+		load testing of wviewd without station hardware.
+
+  REVISION HISTORY:
+		Date            Engineer        Revision        Remarks
+		10/18/2026      agent           0               Original
+
+  NOTES:
+		Opens a pty and prints (or symlinks) the slave device name; point
+		STATION_DEV at it with STATION_INTERFACE=serial. Implements the
+		subset of the serial protocol (see doc/VantageSerialProtocolDocs_v261.pdf)
+		used by wviewd and vpconfig:
+
+		    WAKEUP, TEST, VER, RXCHECK, GETTIME, SETTIME, SETPER, LOOP,
+		    LPS (LOOP/LOOP2), DMPAFT, EEBRD, EEBWR
+
+		Weather data is synthesized from the simulated console clock so
+		LOOP and archive records are deterministic for a given start time.
+		Faults can be injected to exercise the read recovery paths:
+
+		    -d ms       response latency
+		    -c N        corrupt the CRC of 1 in N frames
+		    -x N        drop 1 in N responses entirely
+
+  LICENSE:
+		Copyright (c) 2026, the wview contributors
+
+		This source code is released for free distribution under the terms
+		of the GNU General Public License.
+
+----------------------------------------------------------------------------*/
+
+/*  ... System include files
+*/
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+
+/*  ... Library include files
+*/
+
+/*  ... Local include files
+*/
+#include <vproInterface.h>
+#include <Ccitt.h>
+
+/*  ... local definitions
+*/
+#ifdef WORDS_BIGENDIAN
+#define SHORT_SWAP(x) ((((x) << 8) & 0xFF00) | (((x) >> 8) & 0x00FF))
+#else
+#define SHORT_SWAP(x) (x)
+#endif
+
+#define VPSIM_EEPROM_SIZE           4096
+#define VPSIM_ARCHIVE_RECORDS       2560            // console archive memory
+#define VPSIM_LINE_MAX              64
+
+// EEPROM addresses we care about
+#define EE_LATITUDE                 0x0B
+#define EE_LONGITUDE                0x0D
+#define EE_ELEVATION                0x0F
+#define EE_TIME_FIELDS              0x12
+#define EE_TRANSMITTERS             0x17
+#define EE_SETUP_BITS               0x2B
+#define EE_RAIN_SEASON_START        0x2C
+#define EE_ARCHIVE_PERIOD           0x2D
+#define EE_WIND_DIR_CAL             0x4D
+
+typedef enum
+{
+	SIM_STATE_COMMAND = 0,
+	SIM_STATE_SETTIME_DATA,
+	SIM_STATE_EEBWR_DATA,
+	SIM_STATE_DMPAFT_DATETIME,
+	SIM_STATE_DMPAFT_START,
+	SIM_STATE_DMPAFT_PAGE
+} SIM_STATES;
+
+typedef struct
+{
+	float       outTemp;                            // F
+	float       inTemp;
+	int         outHumidity;
+	int         inHumidity;
+	float       barometer;                          // inches
+	int         windSpeed;                          // mph
+	int         windGust;
+	int         windDir;                            // degrees
+	int         rainClicks;                         // for the interval
+	int         rainRate;                           // clicks/hour
+} SIM_WEATHER;
+
+typedef struct
+{
+	int         masterFd;
+	int         slaveFd;
+	char        linkPath[256];
+	int         exiting;
+	int         verbose;
+
+	// fault injection and timing
+	int         latencyMs;
+	int         loopIntervalMs;
+	int         crcErrorRate;
+	int         dropRate;
+
+	// console state
+	SIM_STATES  state;
+	uint8_t     line[VPSIM_LINE_MAX];
+	int         lineLength;
+	uint8_t     binary[VPSIM_LINE_MAX];
+	int         binaryLength;
+	int         binaryExpected;
+	int         eeAddress;
+	time_t      clockOffset;
+	int         dayRainClicks;
+	uint8_t     eeprom[VPSIM_EEPROM_SIZE];
+
+	// DMPAFT progress
+	long        dumpFirstIndex;                     // global record index
+	int         dumpFirstOffset;
+	int         dumpPages;
+	int         dumpCurrentPage;
+	long        dumpLastIndex;
+
+	// statistics (also reported by RXCHECK)
+	long        framesSent;
+	long        framesCorrupted;
+	long        framesDropped;
+	long        loopsSent;
+	long        pagesSent;
+} VPSIM_WORK;
+
+static VPSIM_WORK       simWork;
+
+/*  ... ----- static (local) methods -----
+*/
+static void sigHandler(int signum)
+{
+	simWork.exiting = TRUE;
+	return;
+}
+
+static uint16_t genCRC(void* data, int length)
+{
+	uint8_t*     ptr = (uint8_t*)data;
+	uint16_t    crc = 0;
+	int         i;
+
+	for (i = 0; i < length; i++)
+	{
+		crc = crc_table[(crc >> 8) ^ ptr[i]] ^ (crc << 8);
+	}
+
+	return crc;
+}
+
+static int archiveIntervalSecs(void)
+{
+	return (simWork.eeprom[EE_ARCHIVE_PERIOD] * 60);
+}
+
+static time_t consoleTime(void)
+{
+	return (time(NULL) + simWork.clockOffset);
+}
+
+static int injectFault(int rate)
+{
+	return (rate > 0 && (rand() % rate) == 0);
+}
+
+// write a response to the daemon after the configured latency
+static void sendBytes(void* data, int length)
+{
+	uint8_t*     ptr = (uint8_t*)data;
+	int         retVal, done = 0;
+
+	while (done < length)
+	{
+		retVal = write(simWork.masterFd, &ptr[done], length - done);
+		if (retVal < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN)
+			{
+				usleep(1000);
+				continue;
+			}
+			fprintf(stderr, "vpsim: write failed: %s\n", strerror(errno));
+			return;
+		}
+		done += retVal;
+	}
+
+	return;
+}
+
+static void sendResponse(void* data, int length)
+{
+	if (simWork.latencyMs > 0)
+	{
+		usleep(simWork.latencyMs * 1000);
+	}
+
+	if (injectFault(simWork.dropRate))
+	{
+		simWork.framesDropped ++;
+		if (simWork.verbose)
+		{
+			fprintf(stderr, "vpsim: dropped %d byte response\n", length);
+		}
+		return;
+	}
+
+	sendBytes(data, length);
+	return;
+}
+
+// append the CRC (MSB first) and send; 'data' must have room for 2 more bytes
+static void sendFrame(uint8_t* data, int length)
+{
+	uint16_t    crc = genCRC(data, length);
+
+	data[length] = (crc >> 8) & 0xFF;
+	data[length + 1] = crc & 0xFF;
+
+	if (injectFault(simWork.crcErrorRate))
+	{
+		simWork.framesCorrupted ++;
+		data[length / 2] ^= 0x5A;
+		if (simWork.verbose)
+		{
+			fprintf(stderr, "vpsim: corrupted %d byte frame\n", length + 2);
+		}
+	}
+
+	simWork.framesSent ++;
+	sendResponse(data, length + 2);
+	return;
+}
+
+static void sendAck(void)
+{
+	uint8_t     ack = VP_ACK;
+	sendResponse(&ack, 1);
+}
+
+static void sendNak(void)
+{
+	uint8_t     nak = VP_NAK;
+	sendResponse(&nak, 1);
+}
+
+static void sendOK(void)
+{
+	sendResponse("\n\rOK\n\r", 6);
+}
+
+// synthesize the weather for a given console time
+static void synthesizeWeather(time_t when, SIM_WEATHER* wx)
+{
+	double      dayAngle = 2.0 * M_PI * (double)(when % WV_SECONDS_IN_DAY) / WV_SECONDS_IN_DAY;
+	double      slowAngle = 2.0 * M_PI * (double)(when % (WV_SECONDS_IN_DAY * 5)) / (WV_SECONDS_IN_DAY * 5);
+
+	wx->outTemp = 55.0 - 12.0 * cos(dayAngle);
+	wx->inTemp = 70.0 + 2.0 * sin(dayAngle);
+	wx->outHumidity = (int)(65.0 + 25.0 * cos(dayAngle));
+	wx->inHumidity = 40;
+	wx->barometer = 29.92 + 0.35 * sin(slowAngle);
+	wx->windSpeed = (int)(8.0 + 6.0 * sin(dayAngle * 3.0));
+	wx->windGust = wx->windSpeed + 5;
+	wx->windDir = (int)(180.0 + 170.0 * sin(slowAngle * 4.0));
+
+	// a shower for 30 minutes of every 6 hours:
+	if ((when % (6 * WV_SECONDS_IN_HOUR)) < 30 * 60)
+	{
+		wx->rainRate = 60;
+		wx->rainClicks = 1;
+	}
+	else
+	{
+		wx->rainRate = 0;
+		wx->rainClicks = 0;
+	}
+
+	return;
+}
+
+static void buildLoop(LOOP_DATA* loop)
+{
+	SIM_WEATHER     wx;
+	time_t          now = consoleTime();
+
+	synthesizeWeather(now, &wx);
+	if (wx.rainClicks)
+	{
+		simWork.dayRainClicks ++;
+	}
+
+	memset(loop, 0xFF, sizeof(*loop));
+	memcpy(loop->name, "LOO", 3);
+	loop->name[3] = 0;                              // bar trend
+	loop->type = 0;
+	loop->nextRecord = SHORT_SWAP(0);
+	loop->barometer = SHORT_SWAP((uint16_t)(wx.barometer * 1000));
+	loop->inTemp = SHORT_SWAP((int16_t)(wx.inTemp * 10));
+	loop->inHumidity = wx.inHumidity;
+	loop->outTemp = SHORT_SWAP((int16_t)(wx.outTemp * 10));
+	loop->windSpeed = wx.windSpeed;
+	loop->tenMinuteAvgWindSpeed = wx.windSpeed;
+	loop->windDir = SHORT_SWAP((uint16_t)wx.windDir);
+	loop->outHumidity = wx.outHumidity;
+	loop->rainRate = SHORT_SWAP((uint16_t)wx.rainRate);
+	loop->radiation = SHORT_SWAP(0x7FFF);
+	loop->stormRain = SHORT_SWAP(0);
+	loop->dayRain = SHORT_SWAP((uint16_t)simWork.dayRainClicks);
+	loop->monthRain = SHORT_SWAP((uint16_t)simWork.dayRainClicks);
+	loop->yearRain = SHORT_SWAP((uint16_t)simWork.dayRainClicks);
+	loop->dayET = SHORT_SWAP(0);
+	loop->monthET = SHORT_SWAP(0);
+	loop->yearET = SHORT_SWAP(0);
+	loop->txBatteryStatus = 0;
+	loop->consBatteryVoltage = SHORT_SWAP(700);
+	loop->forecastIcon = 6;
+	loop->forecastRule = 45;
+	loop->sunrise = SHORT_SWAP(630);
+	loop->sunset = SHORT_SWAP(1845);
+	loop->lf = VP_LF;
+	loop->cr = VP_CR;
+	return;
+}
+
+static void buildLoop2(LOOP2_DATA* loop2)
+{
+	SIM_WEATHER     wx;
+
+	synthesizeWeather(consoleTime(), &wx);
+
+	memset(loop2, 0xFF, sizeof(*loop2));
+	memcpy(loop2->name, "LOO", 3);
+	loop2->BarTrend = 0;
+	loop2->type = 1;
+	loop2->barometer = SHORT_SWAP((uint16_t)(wx.barometer * 1000));
+	loop2->inTemp = SHORT_SWAP((int16_t)(wx.inTemp * 10));
+	loop2->inHumidity = wx.inHumidity;
+	loop2->outTemp = SHORT_SWAP((int16_t)(wx.outTemp * 10));
+	loop2->windSpeed = wx.windSpeed;
+	loop2->windDir = SHORT_SWAP((uint16_t)wx.windDir);
+	loop2->tenMinuteAvgWindSpeed = SHORT_SWAP((uint16_t)(wx.windSpeed * 10));
+	loop2->twoMinuteAvgWindSpeed = SHORT_SWAP((uint16_t)(wx.windSpeed * 10));
+	loop2->tenMinuteWindGust = SHORT_SWAP((uint16_t)wx.windGust);
+	loop2->WinddirtenMinuteWindGust = SHORT_SWAP((uint16_t)wx.windDir);
+	loop2->DewPoint = SHORT_SWAP((int16_t)(wx.outTemp - (100 - wx.outHumidity) / 2.8));
+	loop2->outHumidity = wx.outHumidity;
+	loop2->HeatIndex = SHORT_SWAP((uint16_t)wx.outTemp);
+	loop2->WindChill = SHORT_SWAP((uint16_t)wx.outTemp);
+	loop2->THSWIndex = SHORT_SWAP((uint16_t)wx.outTemp);
+	loop2->rainRate = SHORT_SWAP((uint16_t)wx.rainRate);
+	loop2->dayRain = SHORT_SWAP((uint16_t)simWork.dayRainClicks);
+	loop2->dayET = SHORT_SWAP(0);
+	loop2->lf = VP_LF;
+	loop2->cr = VP_CR;
+	return;
+}
+
+// global archive record index 'index' covers the interval ending at
+// index * archiveInterval (console time)
+static void buildArchiveRecord(long index, ARCHIVE_RECORD* rec)
+{
+	SIM_WEATHER     wx;
+	time_t          when = (time_t)index * archiveIntervalSecs();
+	struct tm       bknTime;
+
+	synthesizeWeather(when, &wx);
+	gmtime_r(&when, &bknTime);
+
+	memset(rec, 0xFF, sizeof(*rec));
+	rec->date = SHORT_SWAP(INSERT_PACKED_DATE(bknTime.tm_year + 1900,
+		bknTime.tm_mon + 1,
+		bknTime.tm_mday));
+	rec->time = SHORT_SWAP((uint16_t)(bknTime.tm_hour * 100 + bknTime.tm_min));
+	rec->outTemp = SHORT_SWAP((int16_t)(wx.outTemp * 10));
+	rec->highOutTemp = SHORT_SWAP((int16_t)(wx.outTemp * 10 + 5));
+	rec->lowOutTemp = SHORT_SWAP((int16_t)(wx.outTemp * 10 - 5));
+	rec->rain = SHORT_SWAP((uint16_t)(wx.rainClicks * simWork.eeprom[EE_ARCHIVE_PERIOD]));
+	rec->highRainRate = SHORT_SWAP((uint16_t)wx.rainRate);
+	rec->barometer = SHORT_SWAP((uint16_t)(wx.barometer * 1000));
+	rec->radiation = SHORT_SWAP(0x7FFF);
+	rec->windSamples = SHORT_SWAP((uint16_t)(simWork.eeprom[EE_ARCHIVE_PERIOD] * 22));
+	rec->inTemp = SHORT_SWAP((int16_t)(wx.inTemp * 10));
+	rec->inHumidity = wx.inHumidity;
+	rec->outHumidity = wx.outHumidity;
+	rec->avgWindSpeed = wx.windSpeed;
+	rec->highWindSpeed = wx.windGust;
+	rec->highWindDir = ((wx.windDir * 16 + 180) / 360) % 16;
+	rec->prevWindDir = rec->highWindDir;
+	rec->ET = 0;
+	rec->highRadiation = SHORT_SWAP(0);
+	rec->fcstRule = 45;
+	rec->recordType = 0x00;                         // revision B
+	return;
+}
+
+//  ... command handlers
+
+static void doWakeup(void)
+{
+	sendResponse("\n\r", 2);
+}
+
+static void doGetTime(void)
+{
+	uint8_t     bfr[16];
+	time_t      now = consoleTime();
+	struct tm   bknTime;
+
+	gmtime_r(&now, &bknTime);
+	bfr[0] = bknTime.tm_sec;
+	bfr[1] = bknTime.tm_min;
+	bfr[2] = bknTime.tm_hour;
+	bfr[3] = bknTime.tm_mday;
+	bfr[4] = bknTime.tm_mon + 1;
+	bfr[5] = bknTime.tm_year;
+
+	sendAck();
+	sendFrame(bfr, 6);
+	return;
+}
+
+static void doSetTimeData(void)
+{
+	struct tm   bknTime;
+	time_t      newTime;
+
+	if (genCRC(simWork.binary, 8) != 0)
+	{
+		sendNak();
+		return;
+	}
+
+	memset(&bknTime, 0, sizeof(bknTime));
+	bknTime.tm_sec = simWork.binary[0];
+	bknTime.tm_min = simWork.binary[1];
+	bknTime.tm_hour = simWork.binary[2];
+	bknTime.tm_mday = simWork.binary[3];
+	bknTime.tm_mon = simWork.binary[4] - 1;
+	bknTime.tm_year = simWork.binary[5];
+
+	// the console clock is kept as "local" time expressed in UTC fields
+	newTime = timegm(&bknTime);
+	simWork.clockOffset = newTime - time(NULL);
+
+	sendAck();
+	return;
+}
+
+static void doEEBRD(int address, int count)
+{
+	uint8_t     bfr[VPSIM_EEPROM_SIZE + 2];
+
+	if (address < 0 || count <= 0 || address + count > VPSIM_EEPROM_SIZE)
+	{
+		sendNak();
+		return;
+	}
+
+	memcpy(bfr, &simWork.eeprom[address], count);
+	sendAck();
+	sendFrame(bfr, count);
+	return;
+}
+
+static void doEEBWRData(void)
+{
+	int         count = simWork.binaryExpected - 2;
+
+	if (genCRC(simWork.binary, simWork.binaryExpected) != 0)
+	{
+		sendNak();
+		return;
+	}
+
+	memcpy(&simWork.eeprom[simWork.eeAddress], simWork.binary, count);
+	sendAck();
+	return;
+}
+
+static void doRXCheck(void)
+{
+	char        bfr[128];
+
+	sendOK();
+	sprintf(bfr, " %ld %ld 0 %ld %ld\n\r",
+		simWork.framesSent,
+		simWork.framesDropped,
+		simWork.framesSent - simWork.framesCorrupted,
+		simWork.framesCorrupted);
+	sendResponse(bfr, strlen(bfr));
+	return;
+}
+
+// stream LOOP/LOOP2 packets, stopping early if the daemon sends anything
+static void doLoops(int count, int withLoop2)
+{
+	uint16_t        bfr[VP_BYTE_LENGTH_MAX / 2];
+	struct pollfd   pfd;
+	int             i;
+
+	sendAck();
+
+	pfd.fd = simWork.masterFd;
+	pfd.events = POLLIN;
+
+	for (i = 0; i < count && !simWork.exiting; i++)
+	{
+		if (i > 0 && poll(&pfd, 1, simWork.loopIntervalMs) > 0)
+		{
+			// any input cancels the LOOP stream
+			break;
+		}
+
+		if (withLoop2 && (i % 2) == 1)
+		{
+			buildLoop2((LOOP2_DATA*)bfr);
+			sendFrame((uint8_t*)bfr, sizeof(LOOP2_DATA) - 2);
+		}
+		else
+		{
+			buildLoop((LOOP_DATA*)bfr);
+			sendFrame((uint8_t*)bfr, sizeof(LOOP_DATA) - 2);
+		}
+		simWork.loopsSent ++;
+	}
+
+	return;
+}
+
+static void doDumpAfterDateTime(void)
+{
+	uint16_t    date, ntime;
+	struct tm   bknTime;
+	time_t      after, now = consoleTime();
+	long        newest, oldest;
+	uint8_t     bfr[8];
+
+	if (genCRC(simWork.binary, 6) != 0)
+	{
+		sendNak();
+		simWork.state = SIM_STATE_COMMAND;
+		return;
+	}
+
+	date = simWork.binary[0] | (simWork.binary[1] << 8);
+	ntime = simWork.binary[2] | (simWork.binary[3] << 8);
+
+	newest = now / archiveIntervalSecs();
+	oldest = newest - VPSIM_ARCHIVE_RECORDS + 1;
+
+	memset(&bknTime, 0, sizeof(bknTime));
+	bknTime.tm_year = EXTRACT_PACKED_YEAR(date) - 1900;
+	bknTime.tm_mon = EXTRACT_PACKED_MONTH(date) - 1;
+	bknTime.tm_mday = EXTRACT_PACKED_DAY(date);
+	bknTime.tm_hour = EXTRACT_PACKED_HOUR(ntime);
+	bknTime.tm_min = EXTRACT_PACKED_MINUTE(ntime);
+	after = timegm(&bknTime);
+
+	simWork.dumpFirstIndex = after / archiveIntervalSecs() + 1;
+	if (date == 0xFFFF || simWork.dumpFirstIndex < oldest)
+	{
+		simWork.dumpFirstIndex = oldest;
+	}
+	simWork.dumpLastIndex = newest;
+
+	if (simWork.dumpFirstIndex > newest)
+	{
+		simWork.dumpPages = 0;
+		simWork.dumpFirstOffset = 0;
+	}
+	else
+	{
+		simWork.dumpFirstOffset = simWork.dumpFirstIndex % 5;
+		simWork.dumpPages = (simWork.dumpFirstOffset +
+			(newest - simWork.dumpFirstIndex + 1) + 4) / 5;
+	}
+	simWork.dumpCurrentPage = 0;
+
+	if (simWork.verbose)
+	{
+		fprintf(stderr, "vpsim: DMPAFT %d pages, first offset %d\n",
+			simWork.dumpPages, simWork.dumpFirstOffset);
+	}
+
+	bfr[0] = simWork.dumpPages & 0xFF;
+	bfr[1] = (simWork.dumpPages >> 8) & 0xFF;
+	bfr[2] = simWork.dumpFirstOffset & 0xFF;
+	bfr[3] = 0;
+
+	sendAck();
+	sendFrame(bfr, 4);
+	simWork.state = SIM_STATE_DMPAFT_START;
+	return;
+}
+
+static void sendArchivePage(void)
+{
+	uint16_t        bfr[sizeof(ARCHIVE_PAGE) / 2 + 1];
+	ARCHIVE_PAGE*   page = (ARCHIVE_PAGE*)bfr;
+	long            index;
+	int             i;
+
+	memset(page, 0xFF, sizeof(*page));
+	page->seqNo = simWork.dumpCurrentPage & 0xFF;
+
+	index = simWork.dumpFirstIndex - simWork.dumpFirstOffset +
+		(simWork.dumpCurrentPage * 5);
+	for (i = 0; i < 5; i++, index++)
+	{
+		if (index <= simWork.dumpLastIndex)
+		{
+			buildArchiveRecord(index, &page->record[i]);
+		}
+	}
+
+	simWork.pagesSent ++;
+	sendFrame((uint8_t*)page, sizeof(ARCHIVE_PAGE) - 2);
+	return;
+}
+
+static void processCommand(char* cmd)
+{
+	int         arg1, arg2;
+
+	if (simWork.verbose)
+	{
+		fprintf(stderr, "vpsim: command '%s'\n", cmd);
+	}
+
+	if (cmd[0] == 0)
+	{
+		doWakeup();
+	}
+	else if (!strcmp(cmd, "TEST"))
+	{
+		sendResponse("\n\rTEST\n\r", 8);
+	}
+	else if (!strcmp(cmd, "VER"))
+	{
+		sendOK();
+		sendResponse("May  1 2012\n\r", 13);
+	}
+	else if (!strcmp(cmd, "NVER"))
+	{
+		sendOK();
+		sendResponse("3.00\n\r", 6);
+	}
+	else if (!strcmp(cmd, "RXCHECK"))
+	{
+		doRXCheck();
+	}
+	else if (!strcmp(cmd, "GETTIME"))
+	{
+		doGetTime();
+	}
+	else if (!strcmp(cmd, "SETTIME"))
+	{
+		sendAck();
+		simWork.state = SIM_STATE_SETTIME_DATA;
+		simWork.binaryExpected = 8;
+	}
+	else if (sscanf(cmd, "SETPER %d", &arg1) == 1)
+	{
+		simWork.eeprom[EE_ARCHIVE_PERIOD] = arg1;
+		sendAck();
+	}
+	else if (!strcmp(cmd, "CLRLOG"))
+	{
+		sendAck();
+	}
+	else if (sscanf(cmd, "LPS %d %d", &arg1, &arg2) == 2)
+	{
+		doLoops(arg2, (arg1 & 0x2) != 0);
+	}
+	else if (sscanf(cmd, "LOOP %d", &arg1) == 1)
+	{
+		doLoops(arg1, FALSE);
+	}
+	else if (!strcmp(cmd, "DMPAFT"))
+	{
+		sendAck();
+		simWork.state = SIM_STATE_DMPAFT_DATETIME;
+		simWork.binaryExpected = 6;
+	}
+	else if (sscanf(cmd, "EEBRD %x %x", &arg1, &arg2) == 2)
+	{
+		doEEBRD(arg1, arg2);
+	}
+	else if (sscanf(cmd, "EEBWR %x %x", &arg1, &arg2) == 2)
+	{
+		if (arg1 < 0 || arg2 <= 0 || arg1 + arg2 > VPSIM_EEPROM_SIZE ||
+			arg2 + 2 > VPSIM_LINE_MAX)
+		{
+			sendNak();
+			return;
+		}
+		sendAck();
+		simWork.eeAddress = arg1;
+		simWork.state = SIM_STATE_EEBWR_DATA;
+		simWork.binaryExpected = arg2 + 2;
+	}
+	else
+	{
+		if (simWork.verbose)
+		{
+			fprintf(stderr, "vpsim: unsupported command '%s'\n", cmd);
+		}
+		sendNak();
+	}
+
+	return;
+}
+
+static void processBinary(void)
+{
+	SIM_STATES      state = simWork.state;
+
+	simWork.state = SIM_STATE_COMMAND;
+	switch (state)
+	{
+	case SIM_STATE_SETTIME_DATA:
+		doSetTimeData();
+		break;
+	case SIM_STATE_EEBWR_DATA:
+		doEEBWRData();
+		break;
+	case SIM_STATE_DMPAFT_DATETIME:
+		doDumpAfterDateTime();
+		break;
+	default:
+		break;
+	}
+
+	return;
+}
+
+static void processByte(uint8_t byte)
+{
+	switch (simWork.state)
+	{
+	case SIM_STATE_COMMAND:
+		if (byte == VP_LF || byte == VP_CR)
+		{
+			simWork.line[simWork.lineLength] = 0;
+			processCommand((char*)simWork.line);
+			simWork.lineLength = 0;
+			simWork.binaryLength = 0;
+		}
+		else if (byte == VP_CANCEL || byte == VP_ACK || byte == VP_NAK)
+		{
+			// stray handshakes outside a download - ignore
+			simWork.lineLength = 0;
+		}
+		else if (simWork.lineLength < VPSIM_LINE_MAX - 1)
+		{
+			simWork.line[simWork.lineLength++] = byte;
+		}
+		break;
+
+	case SIM_STATE_SETTIME_DATA:
+	case SIM_STATE_EEBWR_DATA:
+	case SIM_STATE_DMPAFT_DATETIME:
+		simWork.binary[simWork.binaryLength++] = byte;
+		if (simWork.binaryLength >= simWork.binaryExpected)
+		{
+			simWork.binaryLength = 0;
+			processBinary();
+		}
+		break;
+
+	case SIM_STATE_DMPAFT_START:
+		if (byte == VP_ACK && simWork.dumpPages > 0)
+		{
+			simWork.state = SIM_STATE_DMPAFT_PAGE;
+			sendArchivePage();
+		}
+		else
+		{
+			simWork.state = SIM_STATE_COMMAND;
+		}
+		break;
+
+	case SIM_STATE_DMPAFT_PAGE:
+		if (byte == VP_ACK)
+		{
+			if (++simWork.dumpCurrentPage >= simWork.dumpPages)
+			{
+				simWork.state = SIM_STATE_COMMAND;
+				break;
+			}
+			sendArchivePage();
+		}
+		else if (byte == VP_NAK)
+		{
+			sendArchivePage();
+		}
+		else
+		{
+			// ESC or anything else aborts the download
+			simWork.state = SIM_STATE_COMMAND;
+		}
+		break;
+	}
+
+	// the daemon does not ACK the last page; fall back to commands then
+	if (simWork.state == SIM_STATE_DMPAFT_PAGE &&
+		simWork.dumpCurrentPage == simWork.dumpPages - 1)
+	{
+		simWork.state = SIM_STATE_COMMAND;
+	}
+
+	return;
+}
+
+static void initEEPROM(int interval, int latitude, int longitude, int elevation)
+{
+	int16_t     value;
+	int         i;
+
+	memset(simWork.eeprom, 0xFF, sizeof(simWork.eeprom));
+
+	value = SHORT_SWAP((int16_t)latitude);
+	memcpy(&simWork.eeprom[EE_LATITUDE], &value, 2);
+	value = SHORT_SWAP((int16_t)longitude);
+	memcpy(&simWork.eeprom[EE_LONGITUDE], &value, 2);
+	value = SHORT_SWAP((int16_t)elevation);
+	memcpy(&simWork.eeprom[EE_ELEVATION], &value, 2);
+	memset(&simWork.eeprom[EE_TIME_FIELDS], 0, 5);
+
+	// listen to channel 1 only, no retransmit, ISS on channel 1
+	simWork.eeprom[EE_TRANSMITTERS] = 0x01;
+	simWork.eeprom[EE_TRANSMITTERS + 1] = 0x00;
+	for (i = 0; i < 8; i++)
+	{
+		simWork.eeprom[EE_TRANSMITTERS + 2 + (i * 2)] = ((i == 0) ? 0x00 : 0x0A);
+		simWork.eeprom[EE_TRANSMITTERS + 3 + (i * 2)] = 0xFF;
+	}
+
+	simWork.eeprom[EE_SETUP_BITS] = 0x08;           // 0.01" rain, large cups
+	simWork.eeprom[EE_RAIN_SEASON_START] = 1;
+	simWork.eeprom[EE_ARCHIVE_PERIOD] = interval;
+	simWork.eeprom[EE_WIND_DIR_CAL] = 0;
+	simWork.eeprom[EE_WIND_DIR_CAL + 1] = 0;
+	return;
+}
+
+static int openPty(void)
+{
+	struct termios  tty;
+	char*           slaveName;
+
+	simWork.masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (simWork.masterFd == -1)
+	{
+		fprintf(stderr, "vpsim: posix_openpt failed: %s\n", strerror(errno));
+		return ERROR;
+	}
+
+	if (grantpt(simWork.masterFd) == -1 || unlockpt(simWork.masterFd) == -1)
+	{
+		fprintf(stderr, "vpsim: pty setup failed: %s\n", strerror(errno));
+		close(simWork.masterFd);
+		return ERROR;
+	}
+
+	slaveName = ptsname(simWork.masterFd);
+	if (slaveName == NULL)
+	{
+		fprintf(stderr, "vpsim: ptsname failed: %s\n", strerror(errno));
+		close(simWork.masterFd);
+		return ERROR;
+	}
+
+	// Hold the slave open so the master never sees EIO when wviewd
+	// closes and reopens the device (serialRestart):
+	simWork.slaveFd = open(slaveName, O_RDWR | O_NOCTTY);
+	if (simWork.slaveFd == -1)
+	{
+		fprintf(stderr, "vpsim: %s failed to open: %s\n", slaveName, strerror(errno));
+		close(simWork.masterFd);
+		return ERROR;
+	}
+
+	tcgetattr(simWork.slaveFd, &tty);
+	cfmakeraw(&tty);
+	tcsetattr(simWork.slaveFd, TCSANOW, &tty);
+
+	if (simWork.linkPath[0] != 0)
+	{
+		unlink(simWork.linkPath);
+		if (symlink(slaveName, simWork.linkPath) == -1)
+		{
+			fprintf(stderr, "vpsim: symlink %s failed: %s\n",
+				simWork.linkPath, strerror(errno));
+			simWork.linkPath[0] = 0;
+		}
+	}
+
+	printf("vpsim: console on %s%s%s\n", slaveName,
+		((simWork.linkPath[0] != 0) ? " -> " : ""), simWork.linkPath);
+	fflush(stdout);
+	return OK;
+}
+
+static void usage(void)
+{
+	printf("usage: vpsim [-l link] [-i interval] [-d latencyMs] [-p loopIntervalMs]\n"
+		"             [-c crcErrorRate] [-x dropRate] [-s seed] [-v]\n"
+		"  -l link      symlink the pty slave to this path (STATION_DEV)\n"
+		"  -i minutes   archive interval (default 5)\n"
+		"  -d ms        latency before each response (default 0)\n"
+		"  -p ms        time between LPS packets (default 0, console uses 2000)\n"
+		"  -c N         corrupt the CRC of 1 in N frames (default never)\n"
+		"  -x N         drop 1 in N responses (default never)\n"
+		"  -s seed      random seed for fault injection (default 1)\n"
+		"  -v           log each command to stderr\n");
+	return;
+}
+
+int main(int argc, char* argv[])
+{
+	uint8_t         bfr[VP_BYTE_LENGTH_MAX];
+	struct pollfd   pfd;
+	int             i, opt, retVal;
+	int             interval = 5;
+	unsigned int    seed = 1;
+
+	memset(&simWork, 0, sizeof(simWork));
+
+	while ((opt = getopt(argc, argv, "l:i:d:p:c:x:s:vh")) != -1)
+	{
+		switch (opt)
+		{
+		case 'l':
+			strncpy(simWork.linkPath, optarg, sizeof(simWork.linkPath) - 1);
+			break;
+		case 'i':
+			interval = atoi(optarg);
+			break;
+		case 'd':
+			simWork.latencyMs = atoi(optarg);
+			break;
+		case 'p':
+			simWork.loopIntervalMs = atoi(optarg);
+			break;
+		case 'c':
+			simWork.crcErrorRate = atoi(optarg);
+			break;
+		case 'x':
+			simWork.dropRate = atoi(optarg);
+			break;
+		case 's':
+			seed = (unsigned int)atoi(optarg);
+			break;
+		case 'v':
+			simWork.verbose = TRUE;
+			break;
+		default:
+			usage();
+			exit(1);
+		}
+	}
+
+	if (interval != 1 && interval != 5 && interval != 10 && interval != 15 &&
+		interval != 30 && interval != 60 && interval != 120)
+	{
+		fprintf(stderr, "vpsim: invalid archive interval %d\n", interval);
+		exit(1);
+	}
+
+	srand(seed);
+	initEEPROM(interval, 350, -970, 1000);
+
+	// the console keeps local time:
+	tzset();
+	{
+		time_t      now = time(NULL);
+		struct tm   bknTime;
+
+		localtime_r(&now, &bknTime);
+		simWork.clockOffset = bknTime.tm_gmtoff;
+	}
+
+	if (openPty() == ERROR)
+	{
+		exit(1);
+	}
+
+	signal(SIGINT, sigHandler);
+	signal(SIGTERM, sigHandler);
+	signal(SIGPIPE, SIG_IGN);
+
+	pfd.fd = simWork.masterFd;
+	pfd.events = POLLIN;
+
+	while (!simWork.exiting)
+	{
+		retVal = poll(&pfd, 1, 1000);
+		if (retVal <= 0)
+		{
+			continue;
+		}
+
+		retVal = read(simWork.masterFd, bfr, sizeof(bfr));
+		if (retVal <= 0)
+		{
+			if (retVal < 0 && errno != EINTR && errno != EAGAIN)
+			{
+				fprintf(stderr, "vpsim: read failed: %s\n", strerror(errno));
+				usleep(100000);
+			}
+			continue;
+		}
+
+		for (i = 0; i < retVal; i++)
+		{
+			processByte(bfr[i]);
+		}
+	}
+
+	printf("vpsim: %ld frames (%ld corrupted, %ld dropped), %ld LOOPs, %ld archive pages\n",
+		simWork.framesSent, simWork.framesCorrupted, simWork.framesDropped,
+		simWork.loopsSent, simWork.pagesSent);
+
+	if (simWork.linkPath[0] != 0)
+	{
+		unlink(simWork.linkPath);
+	}
+	close(simWork.slaveFd);
+	close(simWork.masterFd);
+	exit(0);
+}